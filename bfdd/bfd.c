@@ -224,6 +224,9 @@ void bfd_session_apply(struct bfd_session *bs)
 
 	/* Send updated information to data plane. */
 	bfd_dplane_update_session(bs);
+
+	/* Update the packet thread copy (if any). */
+	bfd_fastpath_session_sync(bs);
 }
 
 void bfd_profile_remove(struct bfd_session *bs)
@@ -350,6 +353,7 @@ int bfd_session_enable(struct bfd_session *bs)
 		if (bglobal.debug_peer_event)
 			zlog_debug("session-enable: previous socket open");
 
+		bfd_fastpath_session_del(bs);
 		close(bs->sock);
 		bs->sock = -1;
 	}
@@ -396,6 +400,9 @@ void bfd_session_disable(struct bfd_session *bs)
 	if (bs->bdc)
 		return;
 
+	/* Take the session back before closing the socket it uses. */
+	bfd_fastpath_session_del(bs);
+
 	/* Free up socket resources. */
 	if (bs->sock != -1) {
 		close(bs->sock);
@@ -517,6 +524,8 @@ void ptm_bfd_sess_dn(struct bfd_session *bfd, uint8_t diag)
 {
 	int old_state = bfd->ses_state;
 
+	bfd_fastpath_session_del(bfd);
+
 	bfd->local_diag = diag;
 	bfd->discrs.remote_discr = 0;
 	bfd->ses_state = PTM_BFD_DOWN;
@@ -773,6 +782,9 @@ static void _bfd_session_update(struct bfd_session *bs,
 	 */
 	if (bpc->bpc_has_profile)
 		bfd_profile_apply(bpc->bpc_profile, bs);
+
+	/* Update the packet thread copy (if any). */
+	bfd_fastpath_session_sync(bs);
 }
 
 static int bfd_session_update(struct bfd_session *bs, struct bfd_peer_cfg *bpc)
@@ -949,7 +961,10 @@ void bfd_set_polling(struct bfd_session *bs)
 	 *   - Required minimum receive interval;
 	 *
 	 * RFC 5880, Section 6.8.3.
+	 *
+	 * The poll sequence is handled by the main thread.
 	 */
+	bfd_fastpath_session_del(bs);
 	bs->polling = 1;
 }
 
@@ -1257,6 +1272,7 @@ void bfd_set_shutdown(struct bfd_session *bs, bool shutdown)
 		}
 
 		/* Disable all events. */
+		bfd_fastpath_session_del(bs);
 		bfd_recvtimer_delete(bs);
 		bfd_echo_recvtimer_delete(bs);
 		bfd_xmttimer_delete(bs);
@@ -1949,18 +1965,23 @@ static int bfd_vrf_enable(struct vrf *vrf)
 		if (!bvrf->bg_echov6)
 			bvrf->bg_echov6 = bp_echov6_socket(vrf);
 
-		if (!bvrf->bg_ev[0] && bvrf->bg_shop != -1)
-			thread_add_read(master, bfd_recv_cb, bvrf,
-					bvrf->bg_shop, &bvrf->bg_ev[0]);
-		if (!bvrf->bg_ev[1] && bvrf->bg_mhop != -1)
-			thread_add_read(master, bfd_recv_cb, bvrf,
-					bvrf->bg_mhop, &bvrf->bg_ev[1]);
-		if (!bvrf->bg_ev[2] && bvrf->bg_shop6 != -1)
-			thread_add_read(master, bfd_recv_cb, bvrf,
-					bvrf->bg_shop6, &bvrf->bg_ev[2]);
-		if (!bvrf->bg_ev[3] && bvrf->bg_mhop6 != -1)
-			thread_add_read(master, bfd_recv_cb, bvrf,
-					bvrf->bg_mhop6, &bvrf->bg_ev[3]);
+		/* Control packets may be handled by the packet thread. */
+		if (bfd_fastpath_running())
+			bfd_fastpath_vrf_enable(bvrf);
+		else {
+			if (!bvrf->bg_ev[0] && bvrf->bg_shop != -1)
+				thread_add_read(master, bfd_recv_cb, bvrf,
+						bvrf->bg_shop, &bvrf->bg_ev[0]);
+			if (!bvrf->bg_ev[1] && bvrf->bg_mhop != -1)
+				thread_add_read(master, bfd_recv_cb, bvrf,
+						bvrf->bg_mhop, &bvrf->bg_ev[1]);
+			if (!bvrf->bg_ev[2] && bvrf->bg_shop6 != -1)
+				thread_add_read(master, bfd_recv_cb, bvrf,
+						bvrf->bg_shop6, &bvrf->bg_ev[2]);
+			if (!bvrf->bg_ev[3] && bvrf->bg_mhop6 != -1)
+				thread_add_read(master, bfd_recv_cb, bvrf,
+						bvrf->bg_mhop6, &bvrf->bg_ev[3]);
+		}
 		if (!bvrf->bg_ev[4] && bvrf->bg_echo != -1)
 			thread_add_read(master, bfd_recv_cb, bvrf,
 					bvrf->bg_echo, &bvrf->bg_ev[4]);
@@ -1992,6 +2013,8 @@ static int bfd_vrf_disable(struct vrf *vrf)
 		zlog_debug("VRF disable %s id %d", vrf->name, vrf->vrf_id);
 
 	/* Disable read/write poll triggering. */
+	if (bvrf->bg_fastpath)
+		bfd_fastpath_vrf_disable(bvrf);
 	THREAD_OFF(bvrf->bg_ev[0]);
 	THREAD_OFF(bvrf->bg_ev[1]);
 	THREAD_OFF(bvrf->bg_ev[2]);
@@ -308,6 +308,16 @@ struct bfd_session {
 	uint8_t remote_diag;
 	struct bfd_timers remote_timers;
 
+	/*
+	 * Packet thread offload (see `fastpath.c`): while `fp_offload` is set
+	 * the control packet transmission and detection timers run in the
+	 * packet thread and the main thread timers are stopped.
+	 */
+	bool fp_offload;
+	uint32_t fp_gen;
+	/* Last control packet processed by the main thread. */
+	struct bfd_pkt fp_rx_pkt;
+
 	uint64_t refcount; /* number of pointers referencing this. */
 };
 
@@ -444,6 +454,8 @@ struct bfd_vrf_global {
 	struct vrf *vrf;
 
 	struct thread *bg_ev[6];
+	/* Control sockets are read by the packet thread. */
+	bool bg_fastpath;
 };
 
 /* Forward declaration of data plane context struct. */
@@ -473,6 +485,9 @@ struct bfd_global {
 	struct thread *bg_dplane_sockev;
 	struct dplane_queue bg_dplaneq;
 
+	/* Control packet thread (`--packet-thread`). */
+	bool bg_use_fastpath;
+
 	/* Debug options. */
 	/* Show distributed BFD debug messages. */
 	bool debug_dplane;
@@ -553,10 +568,21 @@ int bp_peer_socketv6(const struct bfd_session *bs);
 int bp_echo_socket(const struct vrf *vrf);
 int bp_echov6_socket(const struct vrf *vrf);
 
+socklen_t bp_peer_addr(const struct bfd_session *bs, const uint16_t *port,
+		       struct sockaddr_any *sa);
+
+void ptm_bfd_pkt_fill(const struct bfd_session *bfd, int fbit,
+		      struct bfd_pkt *pkt);
 void ptm_bfd_snd(struct bfd_session *bfd, int fbit);
 void ptm_bfd_echo_snd(struct bfd_session *bfd);
 
+/* Control packet read buffer size. */
+#define BFD_MSGBUF_LEN 1516
+
 void bfd_recv_cb(struct thread *t);
+void bfd_recv_ctrl(vrf_id_t vrfid, bool is_mhop, uint8_t *msgbuf,
+		   ssize_t mlen, uint8_t ttl, ifindex_t ifindex,
+		   struct sockaddr_any *local, struct sockaddr_any *peer);
 
 
 /*
@@ -829,4 +855,57 @@ int bfd_dplane_update_session_counters(struct bfd_session *bs);
 
 void bfd_dplane_show_counters(struct vty *vty);
 
+/*
+ * fastpath.c
+ */
+
+/**
+ * Starts the control packet thread and moves the control sockets of the
+ * enabled VRFs to it. Must be called after the daemon forked.
+ */
+void bfd_fastpath_start(void);
+
+/**
+ * Stops the control packet thread and gives the sockets and sessions back
+ * to the main thread.
+ */
+void bfd_fastpath_stop(void);
+
+/** Is the control packet thread running? */
+bool bfd_fastpath_running(void);
+
+/**
+ * Starts / stops reading the VRF control sockets in the packet thread.
+ *
+ * \param bvrf the BFD VRF global data.
+ */
+void bfd_fastpath_vrf_enable(struct bfd_vrf_global *bvrf);
+void bfd_fastpath_vrf_disable(struct bfd_vrf_global *bvrf);
+
+/**
+ * Hands a session over to the packet thread if it is stable (up and not
+ * polling), or updates the copy the packet thread has. Sessions which are
+ * not eligible are taken back.
+ *
+ * \param bs the BFD session.
+ */
+void bfd_fastpath_session_sync(struct bfd_session *bs);
+
+/**
+ * Takes a session back from the packet thread and restarts its timers in
+ * the main thread. Must be called before changing anything the packet
+ * thread relies on (state, timers, polling or socket).
+ *
+ * \param bs the BFD session.
+ */
+void bfd_fastpath_session_del(struct bfd_session *bs);
+
+/**
+ * Folds the packet counters of the packet thread into the session
+ * statistics.
+ *
+ * \param bs the BFD session that needs updating.
+ */
+void bfd_fastpath_session_update_counters(struct bfd_session *bs);
+
 #endif /* _BFD_H_ */
@@ -66,51 +66,55 @@ static void bp_bind_ipv6(int sd, uint16_t port);
 /*
  * Functions
  */
-int _ptm_bfd_send(struct bfd_session *bs, uint16_t *port, const void *data,
-		  size_t datalen)
+socklen_t bp_peer_addr(const struct bfd_session *bs, const uint16_t *port,
+		       struct sockaddr_any *sa)
 {
-	struct sockaddr *sa;
-	struct sockaddr_in sin;
-	struct sockaddr_in6 sin6;
 	socklen_t slen;
-	ssize_t rv;
-	int sd = -1;
 
+	memset(sa, 0, sizeof(*sa));
 	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_IPV6)) {
-		memset(&sin6, 0, sizeof(sin6));
-		sin6.sin6_family = AF_INET6;
-		memcpy(&sin6.sin6_addr, &bs->key.peer, sizeof(sin6.sin6_addr));
-		if (bs->ifp && IN6_IS_ADDR_LINKLOCAL(&sin6.sin6_addr))
-			sin6.sin6_scope_id = bs->ifp->ifindex;
+		sa->sa_sin6.sin6_family = AF_INET6;
+		memcpy(&sa->sa_sin6.sin6_addr, &bs->key.peer,
+		       sizeof(sa->sa_sin6.sin6_addr));
+		if (bs->ifp && IN6_IS_ADDR_LINKLOCAL(&sa->sa_sin6.sin6_addr))
+			sa->sa_sin6.sin6_scope_id = bs->ifp->ifindex;
 
-		sin6.sin6_port =
+		sa->sa_sin6.sin6_port =
 			(port) ? *port
 			       : (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_MH))
 					 ? htons(BFD_DEF_MHOP_DEST_PORT)
 					 : htons(BFD_DEFDESTPORT);
 
-		sd = bs->sock;
-		sa = (struct sockaddr *)&sin6;
-		slen = sizeof(sin6);
+		slen = sizeof(sa->sa_sin6);
 	} else {
-		memset(&sin, 0, sizeof(sin));
-		sin.sin_family = AF_INET;
-		memcpy(&sin.sin_addr, &bs->key.peer, sizeof(sin.sin_addr));
-		sin.sin_port =
+		sa->sa_sin.sin_family = AF_INET;
+		memcpy(&sa->sa_sin.sin_addr, &bs->key.peer,
+		       sizeof(sa->sa_sin.sin_addr));
+		sa->sa_sin.sin_port =
 			(port) ? *port
 			       : (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_MH))
 					 ? htons(BFD_DEF_MHOP_DEST_PORT)
 					 : htons(BFD_DEFDESTPORT);
 
-		sd = bs->sock;
-		sa = (struct sockaddr *)&sin;
-		slen = sizeof(sin);
+		slen = sizeof(sa->sa_sin);
 	}
 
 #ifdef HAVE_STRUCT_SOCKADDR_SA_LEN
-	sa->sa_len = slen;
+	sa->sa_sin.sin_len = slen;
 #endif /* HAVE_STRUCT_SOCKADDR_SA_LEN */
-	rv = sendto(sd, data, datalen, 0, sa, slen);
+
+	return slen;
+}
+
+int _ptm_bfd_send(struct bfd_session *bs, uint16_t *port, const void *data,
+		  size_t datalen)
+{
+	struct sockaddr_any sa;
+	socklen_t slen;
+	ssize_t rv;
+
+	slen = bp_peer_addr(bs, port, &sa);
+	rv = sendto(bs->sock, data, datalen, 0, (struct sockaddr *)&sa, slen);
 	if (rv <= 0) {
 		if (bglobal.debug_network)
 			zlog_debug("packet-send: send failure: %s",
@@ -222,7 +226,8 @@ static int ptm_bfd_process_echo_pkt(struct bfd_vrf_global *bvrf, int s)
 	return 0;
 }
 
-void ptm_bfd_snd(struct bfd_session *bfd, int fbit)
+void ptm_bfd_pkt_fill(const struct bfd_session *bfd, int fbit,
+		      struct bfd_pkt *pkt)
 {
 	struct bfd_pkt cp = {};
 
@@ -269,6 +274,14 @@ void ptm_bfd_snd(struct bfd_session *bfd, int fbit)
 	}
 	cp.timers.required_min_echo = htonl(bfd->timers.required_min_echo_rx);
 
+	*pkt = cp;
+}
+
+void ptm_bfd_snd(struct bfd_session *bfd, int fbit)
+{
+	struct bfd_pkt cp;
+
+	ptm_bfd_pkt_fill(bfd, fbit, &cp);
 	if (_ptm_bfd_send(bfd, NULL, &cp, BFD_PKT_LEN) != 0)
 		return;
 
@@ -534,16 +547,12 @@ static void cp_debug(bool mhop, struct sockaddr_any *peer,
 void bfd_recv_cb(struct thread *t)
 {
 	int sd = THREAD_FD(t);
-	struct bfd_session *bfd;
-	struct bfd_pkt *cp;
 	bool is_mhop;
 	ssize_t mlen = 0;
 	uint8_t ttl = 0;
-	vrf_id_t vrfid;
 	ifindex_t ifindex = IFINDEX_INTERNAL;
 	struct sockaddr_any local, peer;
-	uint8_t msgbuf[1516];
-	struct interface *ifp = NULL;
+	uint8_t msgbuf[BFD_MSGBUF_LEN];
 	struct bfd_vrf_global *bvrf = THREAD_ARG(t);
 
 	/* Schedule next read. */
@@ -571,15 +580,31 @@ void bfd_recv_cb(struct thread *t)
 				     &local, &peer);
 	}
 
+	bfd_recv_ctrl(bvrf->vrf->vrf_id, is_mhop, msgbuf, mlen, ttl, ifindex,
+		      &local, &peer);
+}
+
+/*
+ * Processes a control packet read from one of the VRF sockets, either by
+ * bfd_recv_cb() or handed over by the packet thread (see fastpath.c).
+ * `vrfid` is the VRF of the socket the packet was read from.
+ */
+void bfd_recv_ctrl(vrf_id_t vrfid, bool is_mhop, uint8_t *msgbuf,
+		   ssize_t mlen, uint8_t ttl, ifindex_t ifindex,
+		   struct sockaddr_any *local, struct sockaddr_any *peer)
+{
+	struct bfd_session *bfd;
+	struct bfd_pkt *cp;
+	struct interface *ifp = NULL;
+
 	/*
 	 * With netns backend, we have a separate socket in each VRF. It means
-	 * that bvrf here is correct and we believe the bvrf->vrf->vrf_id.
+	 * that the socket VRF is correct and we believe `vrfid`.
 	 * With VRF-lite backend, we have a single socket in the default VRF.
-	 * It means that we can't believe the bvrf->vrf->vrf_id. But in
+	 * It means that we can't believe `vrfid`. But in
 	 * VRF-lite, the ifindex is globally unique, so we can retrieve the
 	 * correct vrf_id from the interface.
 	 */
-	vrfid = bvrf->vrf->vrf_id;
 	if (ifindex) {
 		ifp = if_lookup_by_index(ifindex, vrfid);
 		if (ifp)
@@ -588,14 +613,14 @@ void bfd_recv_cb(struct thread *t)
 
 	/* Implement RFC 5880 6.8.6 */
 	if (mlen < BFD_PKT_LEN) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "too small (%ld bytes)", mlen);
 		return;
 	}
 
 	/* Validate single hop packet TTL. */
 	if ((!is_mhop) && (ttl != BFD_TTL_VAL)) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "invalid TTL: %d expected %d", ttl, BFD_TTL_VAL);
 		return;
 	}
@@ -609,32 +634,32 @@ void bfd_recv_cb(struct thread *t)
 	 */
 	cp = (struct bfd_pkt *)(msgbuf);
 	if (BFD_GETVER(cp->diag) != BFD_VERSION) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "bad version %d", BFD_GETVER(cp->diag));
 		return;
 	}
 
 	if (cp->detect_mult == 0) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "detect multiplier set to zero");
 		return;
 	}
 
 	if ((cp->len < BFD_PKT_LEN) || (cp->len > mlen)) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid, "too small");
+		cp_debug(is_mhop, peer, local, ifindex, vrfid, "too small");
 		return;
 	}
 
 	if (cp->discrs.my_discr == 0) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "'my discriminator' is zero");
 		return;
 	}
 
 	/* Find the session that this packet belongs. */
-	bfd = ptm_bfd_sess_find(cp, &peer, &local, ifp, vrfid, is_mhop);
+	bfd = ptm_bfd_sess_find(cp, peer, local, ifp, vrfid, is_mhop);
 	if (bfd == NULL) {
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "no session found");
 		return;
 	}
@@ -645,17 +670,26 @@ void bfd_recv_cb(struct thread *t)
 	 */
 	if (is_mhop) {
 		if (ttl < bfd->mh_ttl) {
-			cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+			cp_debug(is_mhop, peer, local, ifindex, vrfid,
 				 "exceeded max hop count (expected %d, got %d)",
 				 bfd->mh_ttl, ttl);
 			return;
 		}
 	} else if (bfd->local_address.sa_sin.sin_family == AF_UNSPEC) {
-		bfd->local_address = local;
+		bfd->local_address = *local;
 	}
 
 	bfd->stats.rx_ctrl_pkt++;
 
+	/*
+	 * Remember what the peer last told us: the packet thread only hands
+	 * over packets which differ from it.
+	 */
+	if (cp->len == BFD_PKT_LEN)
+		memcpy(&bfd->fp_rx_pkt, cp, BFD_PKT_LEN);
+	else
+		memset(&bfd->fp_rx_pkt, 0, sizeof(bfd->fp_rx_pkt));
+
 	/*
 	 * If no interface was detected, save the interface where the
 	 * packet came in.
@@ -666,7 +700,7 @@ void bfd_recv_cb(struct thread *t)
 	/* Log remote discriminator changes. */
 	if ((bfd->discrs.remote_discr != 0)
 	    && (bfd->discrs.remote_discr != ntohl(cp->discrs.my_discr)))
-		cp_debug(is_mhop, &peer, &local, ifindex, vrfid,
+		cp_debug(is_mhop, peer, local, ifindex, vrfid,
 			 "remote discriminator mismatch (expected %u, got %u)",
 			 bfd->discrs.remote_discr, ntohl(cp->discrs.my_discr));
 
@@ -733,6 +767,9 @@ void bfd_recv_cb(struct thread *t)
 		/* Send the control packet with the final bit immediately. */
 		ptm_bfd_snd(bfd, 1);
 	}
+
+	/* Hand the session (back) to the packet thread if it is stable. */
+	bfd_fastpath_session_sync(bfd);
 }
 
 /*
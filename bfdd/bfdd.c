@@ -84,6 +84,9 @@ static void sigterm_handler(void)
 	/* Shutdown controller to avoid receiving anymore commands. */
 	control_shutdown();
 
+	/* Take the sockets and sessions back from the packet thread. */
+	bfd_fastpath_stop();
+
 	/* Shutdown and free all protocol related memory. */
 	bfd_shutdown();
 
@@ -139,9 +142,11 @@ FRR_DAEMON_INFO(bfdd, BFD, .vty_port = 2617,
 
 #define OPTION_CTLSOCK 1001
 #define OPTION_DPLANEADDR 2000
+#define OPTION_PKTTHREAD 2001
 static const struct option longopts[] = {
 	{"bfdctl", required_argument, NULL, OPTION_CTLSOCK},
 	{"dplaneaddr", required_argument, NULL, OPTION_DPLANEADDR},
+	{"packet-thread", no_argument, NULL, OPTION_PKTTHREAD},
 	{0}
 };
 
@@ -343,7 +348,8 @@ int main(int argc, char *argv[])
 	frr_preinit(&bfdd_di, argc, argv);
 	frr_opt_add("", longopts,
 		    "      --bfdctl       Specify bfdd control socket\n"
-		    "      --dplaneaddr   Specify BFD data plane address\n");
+		    "      --dplaneaddr   Specify BFD data plane address\n"
+		    "      --packet-thread Handle control packets in a separate thread\n");
 
 	snprintf(ctl_path, sizeof(ctl_path), BFDD_CONTROL_SOCKET,
 		 "", "");
@@ -361,6 +367,9 @@ int main(int argc, char *argv[])
 			strlcpy(dplane_addr, optarg, sizeof(dplane_addr));
 			bglobal.bg_use_dplane = true;
 			break;
+		case OPTION_PKTTHREAD:
+			bglobal.bg_use_fastpath = true;
+			break;
 
 		default:
 			frr_help_exit(1);
@@ -399,6 +408,9 @@ int main(int argc, char *argv[])
 	/* Initialize BFD data plane listening socket. */
 	if (bglobal.bg_use_dplane)
 		distributed_bfd_init(dplane_addr);
+	/* Sessions handled by the data plane don't need the packet thread. */
+	else if (bglobal.bg_use_fastpath)
+		bfd_fastpath_start();
 
 	frr_run(master);
 	/* NOTREACHED */
@@ -364,6 +364,9 @@ static void _display_peer_counter(struct vty *vty, struct bfd_session *bs)
 		zlog_debug("%s: failed to update BFD session counters (%s)",
 			   __func__, bs_to_string(bs));
 
+	/* Add what the packet thread counted. */
+	bfd_fastpath_session_update_counters(bs);
+
 	vty_out(vty, "\t\tControl packet input: %" PRIu64 " packets\n",
 		bs->stats.rx_ctrl_pkt);
 	vty_out(vty, "\t\tControl packet output: %" PRIu64 " packets\n",
@@ -390,6 +393,9 @@ static struct json_object *__display_peer_counters_json(struct bfd_session *bs)
 		zlog_debug("%s: failed to update BFD session counters (%s)",
 			   __func__, bs_to_string(bs));
 
+	/* Add what the packet thread counted. */
+	bfd_fastpath_session_update_counters(bs);
+
 	json_object_int_add(jo, "control-packet-input", bs->stats.rx_ctrl_pkt);
 	json_object_int_add(jo, "control-packet-output", bs->stats.tx_ctrl_pkt);
 	json_object_int_add(jo, "echo-packet-input", bs->stats.rx_echo_pkt);
@@ -476,6 +482,7 @@ static void _clear_peer_counter(struct bfd_session *bs)
 {
 	/* Clear only pkt stats, intention is not to loose system
 	   events counters */
+	bfd_fastpath_session_update_counters(bs);
 	bs->stats.rx_ctrl_pkt = 0;
 	bs->stats.tx_ctrl_pkt = 0;
 	bs->stats.rx_echo_pkt = 0;
@@ -47,6 +47,10 @@ void bfd_recvtimer_update(struct bfd_session *bs)
 	    bs->sock == -1)
 		return;
 
+	/* The packet thread runs this timer for offloaded sessions. */
+	if (bs->fp_offload)
+		return;
+
 	tv_normalize(&tv);
 
 	thread_add_timer_tv(master, bfd_recvtimer_cb, bs, &tv,
@@ -83,6 +87,10 @@ void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
 	    bs->sock == -1)
 		return;
 
+	/* The packet thread runs this timer for offloaded sessions. */
+	if (bs->fp_offload)
+		return;
+
 	tv_normalize(&tv);
 
 	thread_add_timer_tv(master, bfd_xmt_cb, bs, &tv, &bs->xmttimer_ev);
@@ -0,0 +1,732 @@
+/*
+ * BFD control packet thread.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * The packet thread owns the control packet receive sockets and, for every
+ * session that is up and not polling, the periodic transmission and the
+ * detection timer. The main thread stays authoritative for the session
+ * state: everything the packet thread can't handle on its own (new or
+ * changed packets from the peer and detection timeouts) is queued back to
+ * the main thread, which takes the session back whenever it needs to change
+ * it (`bfd_fastpath_session_del`) and hands it over again once it is stable
+ * (`bfd_fastpath_session_sync`).
+ *
+ * Each offloaded session is represented by a `struct bfd_fp_session`
+ * holding a copy of the data the packet thread needs, protected by
+ * `bfp.mtx`. Entries are created and unlinked by the main thread, but only
+ * freed by the packet thread (its transmission timer is always running).
+ */
+
+#include <zebra.h>
+
+#include "lib/atomlist.h"
+#include "lib/frr_pthread.h"
+#include "lib/hash.h"
+#include "lib/jhash.h"
+#include "lib/linklist.h"
+#include "lib/mmsg.h"
+#include "lib/monotime.h"
+#include "lib/network.h"
+#include "lib/thread.h"
+
+#include "bfd.h"
+
+DEFINE_MTYPE_STATIC(BFDD, BFDD_FP_SESSION, "BFD packet thread session");
+DEFINE_MTYPE_STATIC(BFDD, BFDD_FP_MSG, "BFD packet thread message");
+
+/* Number of control packets read per socket wake up. */
+#define BFD_FP_RECV_BATCH 32
+
+struct bfd_fp_session {
+	/* Session identification, `bs->discrs.my_discr`. */
+	uint32_t discr;
+	/* Distinguishes this hand over from earlier ones of the session. */
+	uint32_t gen;
+
+	/* Transmission data. */
+	int sock;
+	struct sockaddr_any dst;
+	socklen_t dstlen;
+	struct bfd_pkt tx_pkt;
+	uint64_t xmt_TO;
+	uint8_t detect_mult;
+
+	/* Reception data. */
+	int family;
+	struct in6_addr peer;
+	bool mhop;
+	uint8_t mh_ttl;
+	/* Packet the main thread already processed, if `rx_pkt_valid`. */
+	struct bfd_pkt rx_pkt;
+	bool rx_pkt_valid;
+	uint64_t detect_TO;
+	struct timeval last_rx;
+
+	/* Counters not yet folded into the session statistics. */
+	uint64_t rx_ctrl_pkt;
+	uint64_t tx_ctrl_pkt;
+
+	/* Detection timeout was reported to the main thread. */
+	bool expired;
+	/* Main thread took the session back, free on next transmission. */
+	bool deleted;
+
+	/* Packet thread events. */
+	struct thread *t_xmt;
+	struct thread *t_detect;
+};
+
+PREDECL_ATOMLIST(bfd_fp_msgq);
+
+enum bfd_fp_msg_type {
+	/* Control packet the packet thread couldn't handle. */
+	BFD_FP_MSG_RECV,
+	/* Session detection timer expired. */
+	BFD_FP_MSG_DETECT,
+};
+
+struct bfd_fp_msg {
+	struct bfd_fp_msgq_item item;
+
+	enum bfd_fp_msg_type type;
+
+	/* BFD_FP_MSG_DETECT */
+	uint32_t discr;
+	uint32_t gen;
+
+	/* BFD_FP_MSG_RECV */
+	vrf_id_t vrf_id;
+	bool is_mhop;
+	uint8_t ttl;
+	ifindex_t ifindex;
+	struct sockaddr_any local;
+	struct sockaddr_any peer;
+	size_t len;
+	uint8_t data[];
+};
+
+DECLARE_ATOMLIST(bfd_fp_msgq, struct bfd_fp_msg, item);
+
+static struct bfd_fastpath {
+	struct frr_pthread *fpt;
+
+	/* Protects `sessions`, `dead` and the entries contents. */
+	pthread_mutex_t mtx;
+	struct hash *sessions;
+	struct list *dead;
+	uint32_t gen;
+
+	/* Packet thread to main thread messages. */
+	struct bfd_fp_msgq_head msgq;
+	struct thread *t_drain;
+
+	/* Packet thread receive buffers. */
+	struct mmsg_batch *rbatch;
+	struct mmsg_batch *rbatch6;
+} bfp;
+
+static unsigned int bfd_fp_session_hash(const void *arg)
+{
+	const struct bfd_fp_session *e = arg;
+
+	return jhash_1word(e->discr, 0);
+}
+
+static bool bfd_fp_session_cmp(const void *arg1, const void *arg2)
+{
+	const struct bfd_fp_session *e1 = arg1, *e2 = arg2;
+
+	return e1->discr == e2->discr;
+}
+
+static struct bfd_fp_session *bfd_fp_session_lookup(uint32_t discr)
+{
+	struct bfd_fp_session key = {.discr = discr};
+
+	return hash_lookup(bfp.sessions, &key);
+}
+
+static void bfd_fp_session_free(struct bfd_fp_session *e)
+{
+	XFREE(MTYPE_BFDD_FP_SESSION, e);
+}
+
+static void bfd_fp_timer_usec(struct thread_master *m,
+			      void (*func)(struct thread *),
+			      struct bfd_fp_session *e, uint64_t usec,
+			      struct thread **ref)
+{
+	struct timeval tv = {.tv_sec = usec / 1000000,
+			     .tv_usec = usec % 1000000};
+
+	thread_add_timer_tv(m, func, e, &tv, ref);
+}
+
+
+/*
+ * Packet thread to main thread messages.
+ */
+static void bfd_fastpath_drain(struct thread *t);
+
+static void bfd_fp_msg_post(struct bfd_fp_msg *msg)
+{
+	bfd_fp_msgq_add_tail(&bfp.msgq, msg);
+	thread_add_event(master, bfd_fastpath_drain, NULL, 0, &bfp.t_drain);
+}
+
+static void bfd_fp_msg_detect(struct bfd_fp_msg *msg)
+{
+	struct bfd_session *bs;
+
+	bs = bfd_id_lookup(msg->discr);
+	if (bs == NULL || !bs->fp_offload || bs->fp_gen != msg->gen)
+		return;
+
+	/* Same as `bfd_recvtimer_cb`. */
+	switch (bs->ses_state) {
+	case PTM_BFD_INIT:
+	case PTM_BFD_UP:
+		ptm_bfd_sess_dn(bs, BD_CONTROL_EXPIRED);
+		break;
+	}
+}
+
+static void bfd_fastpath_drain(struct thread *t)
+{
+	struct bfd_fp_msg *msg;
+
+	while ((msg = bfd_fp_msgq_pop(&bfp.msgq))) {
+		switch (msg->type) {
+		case BFD_FP_MSG_RECV:
+			bfd_recv_ctrl(msg->vrf_id, msg->is_mhop, msg->data,
+				      msg->len, msg->ttl, msg->ifindex,
+				      &msg->local, &msg->peer);
+			break;
+		case BFD_FP_MSG_DETECT:
+			bfd_fp_msg_detect(msg);
+			break;
+		}
+
+		XFREE(MTYPE_BFDD_FP_MSG, msg);
+	}
+}
+
+
+/*
+ * Packet thread timers.
+ */
+static void bfd_fp_xmt_cb(struct thread *t)
+{
+	struct bfd_fp_session *e = THREAD_ARG(t);
+	uint64_t jitter = 0;
+	int maxpercent;
+	bool dead;
+
+	frr_with_mutex (&bfp.mtx) {
+		dead = e->deleted;
+		if (dead) {
+			listnode_delete(bfp.dead, e);
+		} else {
+			if (!e->expired
+			    && sendto(e->sock, &e->tx_pkt, BFD_PKT_LEN, 0,
+				      (struct sockaddr *)&e->dst, e->dstlen)
+				       == BFD_PKT_LEN)
+				e->tx_ctrl_pkt++;
+
+			/* Same jitter as `ptm_bfd_start_xmt_timer`. */
+			maxpercent = (e->detect_mult == 1) ? 16 : 26;
+			jitter = (e->xmt_TO
+				  * (75 + (frr_weak_random() % maxpercent)))
+				 / 100;
+		}
+	}
+
+	if (dead) {
+		THREAD_OFF(e->t_detect);
+		bfd_fp_session_free(e);
+		return;
+	}
+
+	bfd_fp_timer_usec(bfp.fpt->master, bfd_fp_xmt_cb, e, jitter,
+			  &e->t_xmt);
+}
+
+static void bfd_fp_detect_cb(struct thread *t)
+{
+	struct bfd_fp_session *e = THREAD_ARG(t);
+	struct bfd_fp_msg *msg = NULL;
+	int64_t elapsed, remaining = -1;
+
+	/*
+	 * The timer isn't moved on every received packet: check how long
+	 * ago the last one arrived and sleep for the rest of the interval.
+	 */
+	frr_with_mutex (&bfp.mtx) {
+		if (e->deleted || e->expired)
+			break;
+
+		elapsed = monotime_since(&e->last_rx, NULL);
+		if (elapsed < (int64_t)e->detect_TO) {
+			remaining = e->detect_TO - elapsed;
+			break;
+		}
+
+		e->expired = true;
+		msg = XCALLOC(MTYPE_BFDD_FP_MSG, sizeof(*msg));
+		msg->type = BFD_FP_MSG_DETECT;
+		msg->discr = e->discr;
+		msg->gen = e->gen;
+	}
+
+	if (remaining >= 0)
+		bfd_fp_timer_usec(bfp.fpt->master, bfd_fp_detect_cb, e,
+				  remaining, &e->t_detect);
+	if (msg)
+		bfd_fp_msg_post(msg);
+}
+
+static void bfd_fp_session_start(struct thread *t)
+{
+	struct bfd_fp_session *e = THREAD_ARG(t);
+	uint64_t detect_TO;
+
+	frr_with_mutex (&bfp.mtx) {
+		detect_TO = e->detect_TO;
+	}
+
+	/* The transmission timer also takes care of freeing the entry. */
+	bfd_fp_timer_usec(bfp.fpt->master, bfd_fp_xmt_cb, e, 0, &e->t_xmt);
+	bfd_fp_timer_usec(bfp.fpt->master, bfd_fp_detect_cb, e, detect_TO,
+			  &e->t_detect);
+}
+
+
+/*
+ * Packet thread receive.
+ */
+static void bfd_fp_recv_cb(struct thread *t);
+
+/* Returns the event slot of a control socket or -1. */
+static int bfd_fp_vrf_slot(const struct bfd_vrf_global *bvrf, int sd)
+{
+	if (sd == bvrf->bg_shop)
+		return 0;
+	if (sd == bvrf->bg_mhop)
+		return 1;
+	if (sd == bvrf->bg_shop6)
+		return 2;
+	if (sd == bvrf->bg_mhop6)
+		return 3;
+
+	return -1;
+}
+
+static void bfd_fp_pkt_addrs(const struct mmsg_pkt *pkt,
+			     struct sockaddr_any *local,
+			     struct sockaddr_any *peer)
+{
+	memset(local, 0, sizeof(*local));
+	memset(peer, 0, sizeof(*peer));
+
+	/* Same information `bfd_recv_ipv4` / `bfd_recv_ipv6` provide. */
+	if (pkt->from.sa.sa_family == AF_INET6) {
+		peer->sa_sin6 = pkt->from.sin6;
+		if (IN6_IS_ADDR_LINKLOCAL(&peer->sa_sin6.sin6_addr))
+			peer->sa_sin6.sin6_scope_id = pkt->ifindex;
+	} else
+		peer->sa_sin = pkt->from.sin;
+
+	if (IS_IPADDR_V6(&pkt->dst)) {
+		local->sa_sin6.sin6_family = AF_INET6;
+		local->sa_sin6.sin6_addr = pkt->dst.ipaddr_v6;
+		if (IN6_IS_ADDR_LINKLOCAL(&local->sa_sin6.sin6_addr))
+			local->sa_sin6.sin6_scope_id = pkt->ifindex;
+	} else if (IS_IPADDR_V4(&pkt->dst)) {
+		local->sa_sin.sin_family = AF_INET;
+		local->sa_sin.sin_addr = pkt->dst.ipaddr_v4;
+	}
+}
+
+static bool bfd_fp_peer_match(const struct bfd_fp_session *e,
+			      const struct sockaddr_any *peer)
+{
+	switch (e->family) {
+	case AF_INET:
+		return peer->sa_sin.sin_family == AF_INET
+		       && memcmp(&peer->sa_sin.sin_addr, &e->peer,
+				 sizeof(peer->sa_sin.sin_addr))
+				  == 0;
+	case AF_INET6:
+		return peer->sa_sin6.sin6_family == AF_INET6
+		       && memcmp(&peer->sa_sin6.sin6_addr, &e->peer,
+				 sizeof(peer->sa_sin6.sin6_addr))
+				  == 0;
+	}
+
+	return false;
+}
+
+/*
+ * Accounts a packet of an offloaded session. Returns `true` if the packet
+ * only confirms what the main thread already knows, otherwise it must be
+ * handed over.
+ *
+ * Called with `bfp.mtx` held.
+ */
+static bool bfd_fp_recv_pkt(const struct bfd_pkt *cp, bool is_mhop, int ttl,
+			    const struct sockaddr_any *peer)
+{
+	struct bfd_fp_session *e;
+
+	/* Let the main thread deal with (and log) anything unusual. */
+	if (BFD_GETVER(cp->diag) != BFD_VERSION || cp->detect_mult == 0
+	    || cp->len < BFD_PKT_LEN || cp->discrs.my_discr == 0
+	    || cp->discrs.remote_discr == 0)
+		return false;
+
+	e = bfd_fp_session_lookup(ntohl(cp->discrs.remote_discr));
+	if (e == NULL || e->mhop != is_mhop || !bfd_fp_peer_match(e, peer))
+		return false;
+
+	if (is_mhop ? ttl < e->mh_ttl : ttl != BFD_TTL_VAL)
+		return false;
+
+	/* Valid packet for this session: it is alive. */
+	monotime(&e->last_rx);
+
+	if (!e->rx_pkt_valid || cp->len != BFD_PKT_LEN
+	    || memcmp(cp, &e->rx_pkt, BFD_PKT_LEN) != 0)
+		return false;
+
+	e->rx_ctrl_pkt++;
+	return true;
+}
+
+static void bfd_fp_recv_cb(struct thread *t)
+{
+	struct bfd_vrf_global *bvrf = THREAD_ARG(t);
+	int sd = THREAD_FD(t);
+	struct bfd_fp_msg *msg;
+	struct mmsg_batch *batch;
+	struct mmsg_pkt *pkt;
+	struct sockaddr_any local, peer;
+	bool is_mhop, posted = false;
+	int slot, ttl;
+
+	slot = bfd_fp_vrf_slot(bvrf, sd);
+	if (slot == -1)
+		return;
+
+	/* Schedule next read. */
+	thread_add_read(bfp.fpt->master, bfd_fp_recv_cb, bvrf, sd,
+			&bvrf->bg_ev[slot]);
+
+	is_mhop = (slot == 1 || slot == 3);
+	batch = (slot < 2) ? bfp.rbatch : bfp.rbatch6;
+	if (mmsg_recv(batch, sd, 0) <= 0)
+		return;
+
+	frr_with_mutex (&bfp.mtx) {
+		for (unsigned int i = 0; i < batch->count; i++) {
+			pkt = &batch->pkts[i];
+			if (pkt->truncated)
+				continue;
+
+			/* Not reported: let the TTL checks fail. */
+			ttl = pkt->ttl;
+			if (ttl < 0 || ttl > 255)
+				ttl = 0;
+
+			bfd_fp_pkt_addrs(pkt, &local, &peer);
+			if (pkt->len >= BFD_PKT_LEN
+			    && bfd_fp_recv_pkt((struct bfd_pkt *)pkt->data,
+					       is_mhop, ttl, &peer))
+				continue;
+
+			msg = XCALLOC(MTYPE_BFDD_FP_MSG,
+				      sizeof(*msg) + pkt->len);
+			msg->type = BFD_FP_MSG_RECV;
+			msg->vrf_id = bvrf->vrf->vrf_id;
+			msg->is_mhop = is_mhop;
+			msg->ttl = ttl;
+			msg->ifindex = pkt->ifindex;
+			msg->local = local;
+			msg->peer = peer;
+			msg->len = pkt->len;
+			memcpy(msg->data, pkt->data, pkt->len);
+			bfd_fp_msgq_add_tail(&bfp.msgq, msg);
+			posted = true;
+		}
+	}
+
+	if (posted)
+		thread_add_event(master, bfd_fastpath_drain, NULL, 0,
+				 &bfp.t_drain);
+}
+
+
+/*
+ * Main thread interface.
+ */
+bool bfd_fastpath_running(void)
+{
+	return bfp.fpt != NULL;
+}
+
+void bfd_fastpath_vrf_enable(struct bfd_vrf_global *bvrf)
+{
+	int sds[] = {bvrf->bg_shop, bvrf->bg_mhop, bvrf->bg_shop6,
+		     bvrf->bg_mhop6};
+
+	if (bvrf->bg_fastpath)
+		return;
+
+	for (unsigned int i = 0; i < array_size(sds); i++) {
+		if (sds[i] == -1)
+			continue;
+
+		thread_add_read(bfp.fpt->master, bfd_fp_recv_cb, bvrf, sds[i],
+				&bvrf->bg_ev[i]);
+	}
+
+	bvrf->bg_fastpath = true;
+}
+
+void bfd_fastpath_vrf_disable(struct bfd_vrf_global *bvrf)
+{
+	if (!bvrf->bg_fastpath)
+		return;
+
+	/* Waits for a running read callback to finish. */
+	for (unsigned int i = 0; i < 4; i++)
+		thread_cancel_async(bfp.fpt->master, &bvrf->bg_ev[i], NULL);
+
+	bvrf->bg_fastpath = false;
+}
+
+static bool bfd_fastpath_eligible(const struct bfd_session *bs)
+{
+	return bs->ses_state == PTM_BFD_UP && !bs->polling && bs->sock != -1
+	       && bs->bdc == NULL
+	       && !CHECK_FLAG(bs->flags, BFD_SESS_FLAG_SHUTDOWN);
+}
+
+static void bfd_fp_session_fill(struct bfd_fp_session *e,
+				const struct bfd_session *bs)
+{
+	e->sock = bs->sock;
+	e->dstlen = bp_peer_addr(bs, NULL, &e->dst);
+	ptm_bfd_pkt_fill(bs, 0, &e->tx_pkt);
+	e->xmt_TO = bs->xmt_TO;
+	e->detect_mult = bs->detect_mult;
+
+	e->family = bs->key.family;
+	e->peer = bs->key.peer;
+	e->mhop = CHECK_FLAG(bs->flags, BFD_SESS_FLAG_MH);
+	e->mh_ttl = bs->mh_ttl;
+	e->rx_pkt = bs->fp_rx_pkt;
+	e->rx_pkt_valid = e->rx_pkt.len == BFD_PKT_LEN
+			  && BFD_GETSTATE(e->rx_pkt.flags) == PTM_BFD_UP
+			  && !BFD_GETPBIT(e->rx_pkt.flags);
+	e->detect_TO = bs->detect_TO;
+}
+
+void bfd_fastpath_session_sync(struct bfd_session *bs)
+{
+	struct bfd_fp_session *e = NULL;
+
+	if (!bfd_fastpath_running())
+		return;
+
+	if (!bfd_fastpath_eligible(bs)) {
+		bfd_fastpath_session_del(bs);
+		return;
+	}
+
+	frr_with_mutex (&bfp.mtx) {
+		if (bs->fp_offload) {
+			/*
+			 * Nothing to update if a detection timeout is on its
+			 * way: the main thread will take the session back.
+			 */
+			e = bfd_fp_session_lookup(bs->discrs.my_discr);
+			if (e && e->gen == bs->fp_gen && !e->expired)
+				bfd_fp_session_fill(e, bs);
+
+			return;
+		}
+
+		e = XCALLOC(MTYPE_BFDD_FP_SESSION, sizeof(*e));
+		e->discr = bs->discrs.my_discr;
+		e->gen = ++bfp.gen;
+		monotime(&e->last_rx);
+		bfd_fp_session_fill(e, bs);
+		(void)hash_get(bfp.sessions, e, hash_alloc_intern);
+	}
+
+	if (bglobal.debug_peer_event)
+		zlog_debug("fastpath: session %s handed over to packet thread",
+			   bs_to_string(bs));
+
+	bs->fp_offload = true;
+	bs->fp_gen = e->gen;
+	bfd_recvtimer_delete(bs);
+	bfd_xmttimer_delete(bs);
+
+	/* The entry can't go away before the packet thread started it. */
+	thread_add_event(bfp.fpt->master, bfd_fp_session_start, e, 0, NULL);
+}
+
+static void bfd_fp_session_unlink(struct bfd_session *bs)
+{
+	struct bfd_fp_session *e;
+
+	frr_with_mutex (&bfp.mtx) {
+		e = bfd_fp_session_lookup(bs->discrs.my_discr);
+		if (e == NULL || e->gen != bs->fp_gen)
+			break;
+
+		bs->stats.rx_ctrl_pkt += e->rx_ctrl_pkt;
+		bs->stats.tx_ctrl_pkt += e->tx_ctrl_pkt;
+
+		hash_release(bfp.sessions, e);
+		e->deleted = true;
+		listnode_add(bfp.dead, e);
+	}
+}
+
+void bfd_fastpath_session_del(struct bfd_session *bs)
+{
+	if (!bs->fp_offload)
+		return;
+
+	if (bfd_fastpath_running())
+		bfd_fp_session_unlink(bs);
+
+	if (bglobal.debug_peer_event)
+		zlog_debug("fastpath: session %s taken back from packet thread",
+			   bs_to_string(bs));
+
+	/* Give the timers back to the main thread. */
+	bs->fp_offload = false;
+	bfd_recvtimer_update(bs);
+	ptm_bfd_start_xmt_timer(bs, false);
+}
+
+void bfd_fastpath_session_update_counters(struct bfd_session *bs)
+{
+	struct bfd_fp_session *e;
+
+	if (!bs->fp_offload || !bfd_fastpath_running())
+		return;
+
+	frr_with_mutex (&bfp.mtx) {
+		e = bfd_fp_session_lookup(bs->discrs.my_discr);
+		if (e == NULL || e->gen != bs->fp_gen)
+			break;
+
+		bs->stats.rx_ctrl_pkt += e->rx_ctrl_pkt;
+		bs->stats.tx_ctrl_pkt += e->tx_ctrl_pkt;
+		e->rx_ctrl_pkt = 0;
+		e->tx_ctrl_pkt = 0;
+	}
+}
+
+void bfd_fastpath_start(void)
+{
+	struct frr_pthread_attr attr = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	struct bfd_vrf_global *bvrf;
+	struct vrf *vrf;
+
+	pthread_mutex_init(&bfp.mtx, NULL);
+	bfp.sessions = hash_create(bfd_fp_session_hash, bfd_fp_session_cmp,
+				   "BFD packet thread sessions");
+	bfp.dead = list_new();
+	bfd_fp_msgq_init(&bfp.msgq);
+	bfp.rbatch = mmsg_batch_new(AF_INET, BFD_FP_RECV_BATCH,
+				    BFD_MSGBUF_LEN);
+	bfp.rbatch6 = mmsg_batch_new(AF_INET6, BFD_FP_RECV_BATCH,
+				     BFD_MSGBUF_LEN);
+
+	bfp.fpt = frr_pthread_new(&attr, "BFD packet thread", "bfdd_packet");
+	frr_pthread_run(bfp.fpt, NULL);
+	frr_pthread_wait_running(bfp.fpt);
+
+	/* Take over the control sockets of the VRFs enabled so far. */
+	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
+		bvrf = vrf->info;
+		if (bvrf == NULL)
+			continue;
+		if (!bvrf->bg_ev[0] && !bvrf->bg_ev[1] && !bvrf->bg_ev[2]
+		    && !bvrf->bg_ev[3])
+			continue;
+
+		THREAD_OFF(bvrf->bg_ev[0]);
+		THREAD_OFF(bvrf->bg_ev[1]);
+		THREAD_OFF(bvrf->bg_ev[2]);
+		THREAD_OFF(bvrf->bg_ev[3]);
+		bfd_fastpath_vrf_enable(bvrf);
+	}
+
+	zlog_info("BFD control packet thread started");
+}
+
+static void bfd_fp_session_clean(void *arg)
+{
+	bfd_fp_session_free(arg);
+}
+
+void bfd_fastpath_stop(void)
+{
+	struct bfd_fp_msg *msg;
+	struct vrf *vrf;
+
+	if (!bfd_fastpath_running())
+		return;
+
+	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
+		if (vrf->info)
+			bfd_fastpath_vrf_disable(vrf->info);
+	}
+
+	frr_pthread_stop(bfp.fpt, NULL);
+	frr_pthread_destroy(bfp.fpt);
+	bfp.fpt = NULL;
+
+	/*
+	 * The packet thread is gone: sessions still flagged as offloaded are
+	 * restarted in the main thread by `bfd_fastpath_session_del`.
+	 */
+	hash_clean(bfp.sessions, bfd_fp_session_clean);
+	hash_free(bfp.sessions);
+	bfp.sessions = NULL;
+	bfp.dead->del = bfd_fp_session_clean;
+	list_delete(&bfp.dead);
+
+	THREAD_OFF(bfp.t_drain);
+	while ((msg = bfd_fp_msgq_pop(&bfp.msgq)))
+		XFREE(MTYPE_BFDD_FP_MSG, msg);
+	bfd_fp_msgq_fini(&bfp.msgq);
+
+	mmsg_batch_free(&bfp.rbatch);
+	mmsg_batch_free(&bfp.rbatch6);
+	pthread_mutex_destroy(&bfp.mtx);
+}
@@ -145,6 +145,7 @@ static void _ptm_bfd_session_del(struct bfd_session *bs, uint8_t diag)
 		zlog_debug("session-delete: %s", bs_to_string(bs));
 
 	/* Change state and notify peer. */
+	bfd_fastpath_session_del(bs);
 	bs->ses_state = PTM_BFD_DOWN;
 	bs->local_diag = diag;
 	ptm_bfd_snd(bs, 0);
@@ -182,6 +182,7 @@ void bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer, struct attr *attr,
 		    uint32_t addpath_id)
 {
 	struct bgp_adj_in *adj;
+	struct bgp_table *table;
 
 	for (adj = dest->adj_in; adj; adj = adj->next) {
 		if (adj->peer == peer && adj->addpath_rx_id == addpath_id) {
@@ -197,14 +198,29 @@ void bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer, struct attr *attr,
 	adj->attr = bgp_attr_intern(attr);
 	adj->uptime = bgp_clock();
 	adj->addpath_rx_id = addpath_id;
-	BGP_ADJ_IN_ADD(dest, adj);
+	adj->dest = dest;
+	adj->next = dest->adj_in;
+	dest->adj_in = adj;
 	bgp_dest_lock_node(dest);
+
+	table = bgp_dest_table(dest);
+	bgp_peer_adj_in_add_tail(&peer->adj_in[table->afi][table->safi], adj);
 }
 
 void bgp_adj_in_remove(struct bgp_dest *dest, struct bgp_adj_in *bai)
 {
+	struct bgp_adj_in **prev;
+	struct bgp_table *table = bgp_dest_table(dest);
+
+	for (prev = &dest->adj_in; *prev; prev = &(*prev)->next)
+		if (*prev == bai) {
+			*prev = bai->next;
+			break;
+		}
+
+	bgp_peer_adj_in_del(&bai->peer->adj_in[table->afi][table->safi], bai);
+
 	bgp_attr_unintern(&bai->attr);
-	BGP_ADJ_IN_DEL(dest, bai);
 	bgp_dest_unlock_node(dest);
 	peer_unlock(bai->peer); /* adj_in peer reference */
 	XFREE(MTYPE_BGP_ADJ_IN, bai);
@@ -92,11 +92,29 @@ RB_HEAD(bgp_adj_out_rb, bgp_adj_out);
 RB_PROTOTYPE(bgp_adj_out_rb, bgp_adj_out, adj_entry,
 	     bgp_adj_out_compare);
 
-/* BGP adjacency in. */
+/* BGP adjacency in.
+ *
+ * One of these exists per (peer, prefix, addpath id) for every peer with
+ * soft-reconfiguration inbound.  The list off the bgp_dest is singly linked
+ * (it holds one entry per soft-reconfig peer, or one per addpath id
+ * received from a peer using addpath, so unlinking by walking it is cheap)
+ * and the timestamp is stored as 32 bits of monotonic seconds.  The
+ * attribute is an interned reference; when inbound policy leaves the
+ * attribute unchanged it is the very same attr the bgp_path_info points
+ * to, so no copy is kept.
+ *
+ * The per-peer list and dest back pointer cost 24 bytes, bringing the
+ * entry to 56 bytes on 64-bit, more than the 48 bytes of the old layout
+ * with a doubly linked dest list.  They are what lets clearing a peer
+ * visit only its own entries instead of walking the table.
+ */
 struct bgp_adj_in {
 	/* Linked list pointer.  */
 	struct bgp_adj_in *next;
-	struct bgp_adj_in *prev;
+
+	/* Per-peer list linkage and the prefix this entry is for */
+	struct bgp_peer_adj_in_item peer_item;
+	struct bgp_dest *dest;
 
 	/* Received peer.  */
 	struct peer *peer;
@@ -104,13 +122,15 @@ struct bgp_adj_in {
 	/* Received attribute.  */
 	struct attr *attr;
 
-	/* timestamp (monotime) */
-	time_t uptime;
+	/* timestamp (monotime, seconds) */
+	uint32_t uptime;
 
 	/* Addpath identifier */
 	uint32_t addpath_rx_id;
 };
 
+DECLARE_DLIST(bgp_peer_adj_in, struct bgp_adj_in, peer_item);
+
 /* BGP advertisement list.  */
 struct bgp_synchronize {
 	struct bgp_adv_fifo_head update;
@@ -118,29 +138,6 @@ struct bgp_synchronize {
 	struct bgp_adv_fifo_head withdraw_low;
 };
 
-/* BGP adjacency linked list.  */
-#define BGP_PATH_INFO_ADD(N, A, TYPE)                                          \
-	do {                                                                   \
-		(A)->prev = NULL;                                              \
-		(A)->next = (N)->TYPE;                                         \
-		if ((N)->TYPE)                                                 \
-			(N)->TYPE->prev = (A);                                 \
-		(N)->TYPE = (A);                                               \
-	} while (0)
-
-#define BGP_PATH_INFO_DEL(N, A, TYPE)                                          \
-	do {                                                                   \
-		if ((A)->next)                                                 \
-			(A)->next->prev = (A)->prev;                           \
-		if ((A)->prev)                                                 \
-			(A)->prev->next = (A)->next;                           \
-		else                                                           \
-			(N)->TYPE = (A)->next;                                 \
-	} while (0)
-
-#define BGP_ADJ_IN_ADD(N, A) BGP_PATH_INFO_ADD(N, A, adj_in)
-#define BGP_ADJ_IN_DEL(N, A) BGP_PATH_INFO_DEL(N, A, adj_in)
-
 /* Prototypes.  */
 extern bool bgp_adj_out_lookup(struct peer *, struct bgp_dest *, uint32_t);
 extern void bgp_adj_in_set(struct bgp_dest *, struct peer *, struct attr *,
@@ -68,6 +68,7 @@ DEFINE_MTYPE_STATIC(BMP, BMP_LISTENER,	"BMP listener");
 DEFINE_MTYPE_STATIC(BMP, BMP_ACTIVE,	"BMP active connection config");
 DEFINE_MTYPE_STATIC(BMP, BMP_ACLNAME,	"BMP access-list name");
 DEFINE_MTYPE_STATIC(BMP, BMP_QUEUE,	"BMP update queue item");
+DEFINE_MTYPE_STATIC(BMP, BMP_QUEUE_MSG,	"BMP encoded monitoring message");
 DEFINE_MTYPE_STATIC(BMP, BMP,		"BMP instance state");
 DEFINE_MTYPE_STATIC(BMP, BMP_MIRRORQ,	"BMP route mirroring buffer");
 DEFINE_MTYPE_STATIC(BMP, BMP_PEER,	"BMP per BGP peer data");
@@ -180,11 +181,7 @@ static uint32_t bmp_qhash_hkey(const struct bmp_queue_entry *e)
 			    - offsetof(struct bmp_queue_entry, peerid),
 		    key);
 	if (e->afi == AFI_L2VPN && e->safi == SAFI_EVPN)
-		key = jhash(&e->rd,
-			    offsetof(struct bmp_queue_entry, rd)
-				    - offsetof(struct bmp_queue_entry, refcount)
-				    + PSIZE(e->rd.prefixlen),
-			    key);
+		key = jhash(e->rd.val, sizeof(e->rd.val), key);
 
 	return key;
 }
@@ -242,19 +239,19 @@ static void bmp_common_hdr(struct stream *s, uint8_t ver, uint8_t type)
 	stream_putc(s, type);
 }
 
-static void bmp_per_peer_hdr(struct stream *s, struct peer *peer,
-		uint8_t flags, const struct timeval *tv)
-{
-	char peer_distinguisher[8];
-
 #define BMP_PEER_TYPE_GLOBAL_INSTANCE 0
 #define BMP_PEER_TYPE_RD_INSTANCE     1
 #define BMP_PEER_TYPE_LOCAL_INSTANCE  2
+#define BMP_PEER_TYPE_LOC_RIB_INSTANCE 3
 
 #define BMP_PEER_FLAG_V (1 << 7)
 #define BMP_PEER_FLAG_L (1 << 6)
 #define BMP_PEER_FLAG_A (1 << 5)
+#define BMP_PEER_FLAG_O (1 << 4)
 
+static void bmp_per_peer_hdr_start(struct stream *s, struct peer *peer,
+				   uint8_t flags)
+{
 	/* Peer Type */
 	stream_putc(s, BMP_PEER_TYPE_GLOBAL_INSTANCE);
 
@@ -264,6 +261,12 @@ static void bmp_per_peer_hdr(struct stream *s, struct peer *peer,
 	else
 		UNSET_FLAG(flags, BMP_PEER_FLAG_V);
 	stream_putc(s, flags);
+}
+
+/* Peer Distinguisher, Address, AS & BGP ID - BMP_PEER_HDR_CACHED_LEN bytes */
+static void bmp_per_peer_hdr_peer(struct stream *s, struct peer *peer)
+{
+	char peer_distinguisher[8];
 
 	/* Peer Distinguisher */
 	memset (&peer_distinguisher[0], 0, 8);
@@ -289,7 +292,10 @@ static void bmp_per_peer_hdr(struct stream *s, struct peer *peer,
 
 	/* Peer BGP ID */
 	stream_put_in_addr(s, &peer->remote_id);
+}
 
+static void bmp_per_peer_hdr_end(struct stream *s, const struct timeval *tv)
+{
 	/* Timestamp */
 	if (tv) {
 		stream_putl(s, tv->tv_sec);
@@ -300,6 +306,66 @@ static void bmp_per_peer_hdr(struct stream *s, struct peer *peer,
 	}
 }
 
+static void bmp_per_peer_hdr(struct stream *s, struct peer *peer,
+		uint8_t flags, const struct timeval *tv)
+{
+	bmp_per_peer_hdr_start(s, peer, flags);
+	bmp_per_peer_hdr_peer(s, peer);
+	bmp_per_peer_hdr_end(s, tv);
+}
+
+/* same as above, for route monitoring where this is repeated for every
+ * single prefix; the peer dependent part is kept encoded in bmp_bgp_peer.
+ */
+static void bmp_per_peer_hdr_cached(struct stream *s, struct peer *peer,
+				    uint8_t flags, const struct timeval *tv)
+{
+	struct bmp_bgp_peer *bbpeer = bmp_bgp_peer_get(peer);
+
+	if (!bbpeer->hdr_valid) {
+		struct stream *hdr = stream_new(BMP_PEER_HDR_CACHED_LEN);
+
+		bmp_per_peer_hdr_peer(hdr, peer);
+		assert(stream_get_endp(hdr) == BMP_PEER_HDR_CACHED_LEN);
+		memcpy(bbpeer->hdr, STREAM_DATA(hdr), BMP_PEER_HDR_CACHED_LEN);
+		bbpeer->hdr_valid = true;
+		stream_free(hdr);
+	}
+
+	bmp_per_peer_hdr_start(s, peer, flags);
+	stream_put(s, bbpeer->hdr, BMP_PEER_HDR_CACHED_LEN);
+	bmp_per_peer_hdr_end(s, tv);
+}
+
+/* RFC 9069 Loc-RIB instance "peer" - no peer address, local AS & ID */
+static void bmp_per_peer_hdr_locrib(struct stream *s, struct bgp *bgp,
+				    uint8_t flags, const struct timeval *tv)
+{
+	/* Peer Type */
+	stream_putc(s, BMP_PEER_TYPE_LOC_RIB_INSTANCE);
+
+	/* Peer Flags */
+	stream_putc(s, flags);
+
+	/* Peer Distinguisher, unique per VRF */
+	stream_putl(s, 0);
+	if (bgp->inst_type == BGP_INSTANCE_TYPE_VRF)
+		stream_putl(s, bgp->vrf_id);
+	else
+		stream_putl(s, 0);
+
+	/* Peer Address */
+	stream_put(s, NULL, 16);
+
+	/* Peer AS */
+	stream_putl(s, bgp->as);
+
+	/* Peer BGP ID */
+	stream_put_in_addr(s, &bgp->router_id);
+
+	bmp_per_peer_hdr_end(s, tv);
+}
+
 static void bmp_put_info_tlv(struct stream *s, uint16_t type,
 		const char *string)
 {
@@ -352,6 +418,12 @@ static void bmp_notify_put(struct stream *s, struct bgp_notify *nfy)
 			+ sizeof(marker));
 }
 
+static const uint8_t bmp_dummy_open[] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0x00, 0x13, 0x01,
+};
+
 static struct stream *bmp_peerstate(struct peer *peer, bool down)
 {
 	struct stream *s;
@@ -392,25 +464,19 @@ static struct stream *bmp_peerstate(struct peer *peer, bool down)
 		else if (peer->su_remote->sa.sa_family == AF_INET)
 			stream_putw(s, peer->su_remote->sin.sin_port);
 
-		static const uint8_t dummy_open[] = {
-			0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-			0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-			0x00, 0x13, 0x01,
-		};
-
 		bbpeer = bmp_bgp_peer_find(peer->qobj_node.nid);
 
 		if (bbpeer && bbpeer->open_tx)
 			stream_put(s, bbpeer->open_tx, bbpeer->open_tx_len);
 		else {
-			stream_put(s, dummy_open, sizeof(dummy_open));
+			stream_put(s, bmp_dummy_open, sizeof(bmp_dummy_open));
 			zlog_warn("bmp: missing TX OPEN message for peer %s",
 				  peer->host);
 		}
 		if (bbpeer && bbpeer->open_rx)
 			stream_put(s, bbpeer->open_rx, bbpeer->open_rx_len);
 		else {
-			stream_put(s, dummy_open, sizeof(dummy_open));
+			stream_put(s, bmp_dummy_open, sizeof(bmp_dummy_open));
 			zlog_warn("bmp: missing RX OPEN message for peer %s",
 				  peer->host);
 		}
@@ -460,6 +526,66 @@ static struct stream *bmp_peerstate(struct peer *peer, bool down)
 }
 
 
+static bool bmp_targets_locrib(struct bmp_targets *bt)
+{
+	afi_t afi;
+	safi_t safi;
+
+	FOREACH_AFI_SAFI (afi, safi)
+		if (bt->afimon[afi][safi] & BMP_MON_LOC_RIB)
+			return true;
+	return false;
+}
+
+/* RFC 9069 s. 5.3 - the Loc-RIB instance is announced like a peer, with
+ * the VRF/table name TLV and no OPEN messages to speak of.
+ */
+static void bmp_send_peerup_locrib(struct bmp *bmp)
+{
+	struct bgp *bgp = bmp->targets->bgp;
+	struct stream *s;
+	struct timeval tv;
+
+	monotime_to_realtime(&bmp->t_up, &tv);
+
+	s = stream_new(BGP_MAX_PACKET_SIZE);
+	bmp_common_hdr(s, BMP_VERSION_3, BMP_TYPE_PEER_UP_NOTIFICATION);
+	bmp_per_peer_hdr_locrib(s, bgp, 0, &tv);
+
+	/* Local Address, Local Port, Remote Port */
+	stream_put(s, NULL, 16);
+	stream_putw(s, 0);
+	stream_putw(s, 0);
+
+	stream_put(s, bmp_dummy_open, sizeof(bmp_dummy_open));
+	stream_put(s, bmp_dummy_open, sizeof(bmp_dummy_open));
+
+#define BMP_INFO_TYPE_VRF_TABLE_NAME	3
+	bmp_put_info_tlv(s, BMP_INFO_TYPE_VRF_TABLE_NAME,
+			 bgp->name ? bgp->name : VRF_DEFAULT_NAME);
+
+	stream_putl_at(s, BMP_LENGTH_POS, stream_get_endp(s));
+
+	pullwr_write_stream(bmp->pullwr, s);
+	stream_free(s);
+	bmp->locrib_up = true;
+}
+
+static void bmp_send_peerdown_locrib(struct bmp *bmp)
+{
+	struct stream *s;
+
+	s = stream_new(BMP_MONITOR_HDR_LEN + 1);
+	bmp_common_hdr(s, BMP_VERSION_3, BMP_TYPE_PEER_DOWN_NOTIFICATION);
+	bmp_per_peer_hdr_locrib(s, bmp->targets->bgp, 0, NULL);
+	stream_putc(s, BMP_PEERDOWN_ENDMONITOR);
+	stream_putl_at(s, BMP_LENGTH_POS, stream_get_endp(s));
+
+	pullwr_write_stream(bmp->pullwr, s);
+	stream_free(s);
+	bmp->locrib_up = false;
+}
+
 static int bmp_send_peerup(struct bmp *bmp)
 {
 	struct peer *peer;
@@ -473,6 +599,9 @@ static int bmp_send_peerup(struct bmp *bmp)
 		stream_free(s);
 	}
 
+	if (bmp_targets_locrib(bmp->targets))
+		bmp_send_peerup_locrib(bmp);
+
 	return 0;
 }
 
@@ -695,6 +824,10 @@ static int bmp_peer_status_changed(struct peer *peer)
 
 	frrtrace(1, frr_bgp, bmp_peer_status_changed, peer);
 
+	bbpeer = bmp_bgp_peer_find(peer->qobj_node.nid);
+	if (bbpeer)
+		bbpeer->hdr_valid = false;
+
 	if (!bmpbgp)
 		return 0;
 
@@ -756,16 +889,12 @@ static int bmp_peer_backward(struct peer *peer)
 	return 0;
 }
 
-static void bmp_eor(struct bmp *bmp, afi_t afi, safi_t safi, uint8_t flags)
+static struct stream *bmp_eor_update(afi_t afi, safi_t safi)
 {
-	struct peer *peer;
-	struct listnode *node;
-	struct stream *s, *s2;
+	struct stream *s;
 	iana_afi_t pkt_afi;
 	iana_safi_t pkt_safi;
 
-	frrtrace(3, frr_bgp, bmp_eor, afi, safi, flags);
-
 	s = stream_new(BGP_MAX_PACKET_SIZE);
 
 	/* Make BGP update packet. */
@@ -791,6 +920,18 @@ static void bmp_eor(struct bmp *bmp, afi_t afi, safi_t safi, uint8_t flags)
 	}
 
 	bgp_packet_set_size(s);
+	return s;
+}
+
+static void bmp_eor(struct bmp *bmp, afi_t afi, safi_t safi, uint8_t flags)
+{
+	struct peer *peer;
+	struct listnode *node;
+	struct stream *s, *s2;
+
+	frrtrace(3, frr_bgp, bmp_eor, afi, safi, flags);
+
+	s = bmp_eor_update(afi, safi);
 
 	for (ALL_LIST_ELEMENTS_RO(bmp->targets->bgp->peer, node, peer)) {
 		if (!peer->afc_nego[afi][safi])
@@ -800,7 +941,7 @@ static void bmp_eor(struct bmp *bmp, afi_t afi, safi_t safi, uint8_t flags)
 
 		bmp_common_hdr(s2, BMP_VERSION_3,
 				BMP_TYPE_ROUTE_MONITORING);
-		bmp_per_peer_hdr(s2, peer, flags, NULL);
+		bmp_per_peer_hdr_cached(s2, peer, flags, NULL);
 
 		stream_putl_at(s2, BMP_LENGTH_POS,
 				stream_get_endp(s) + stream_get_endp(s2));
@@ -813,6 +954,25 @@ static void bmp_eor(struct bmp *bmp, afi_t afi, safi_t safi, uint8_t flags)
 	stream_free(s);
 }
 
+static void bmp_eor_locrib(struct bmp *bmp, afi_t afi, safi_t safi)
+{
+	struct stream *s, *s2;
+
+	s = bmp_eor_update(afi, safi);
+
+	s2 = stream_new(BMP_MONITOR_HDR_LEN);
+	bmp_common_hdr(s2, BMP_VERSION_3, BMP_TYPE_ROUTE_MONITORING);
+	bmp_per_peer_hdr_locrib(s2, bmp->targets->bgp, 0, NULL);
+	stream_putl_at(s2, BMP_LENGTH_POS,
+		       stream_get_endp(s) + stream_get_endp(s2));
+
+	bmp->cnt_update++;
+	pullwr_write_stream(bmp->pullwr, s2);
+	pullwr_write_stream(bmp->pullwr, s);
+	stream_free(s2);
+	stream_free(s);
+}
+
 static struct stream *bmp_update(const struct prefix *p, struct prefix_rd *prd,
 				 struct peer *peer, struct attr *attr,
 				 afi_t afi, safi_t safi)
@@ -903,12 +1063,17 @@ static struct stream *bmp_withdraw(const struct prefix *p,
 	return s;
 }
 
-static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
-			const struct prefix *p, struct prefix_rd *prd,
-			struct attr *attr, afi_t afi, safi_t safi,
-			time_t uptime)
-{
-	struct stream *hdr, *msg;
+/* encode one complete BMP route monitoring message, sized to fit.  For
+ * Loc-RIB, locrib is the instance and peer is only used to encode attr.
+ */
+static struct stream *bmp_monitor_encode(struct bgp *locrib,
+					 struct peer *peer, uint8_t flags,
+					 const struct prefix *p,
+					 struct prefix_rd *prd,
+					 struct attr *attr, afi_t afi,
+					 safi_t safi, time_t uptime)
+{
+	struct stream *s, *msg;
 	struct timeval tv = { .tv_sec = uptime, .tv_usec = 0 };
 	struct timeval uptime_real;
 
@@ -918,18 +1083,33 @@ static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
 	else
 		msg = bmp_withdraw(p, prd, afi, safi);
 
-	hdr = stream_new(BGP_MAX_PACKET_SIZE);
-	bmp_common_hdr(hdr, BMP_VERSION_3, BMP_TYPE_ROUTE_MONITORING);
-	bmp_per_peer_hdr(hdr, peer, flags, &uptime_real);
+	s = stream_new(BMP_MONITOR_HDR_LEN + stream_get_endp(msg));
+	bmp_common_hdr(s, BMP_VERSION_3, BMP_TYPE_ROUTE_MONITORING);
+	if (locrib)
+		bmp_per_peer_hdr_locrib(s, locrib, flags, &uptime_real);
+	else
+		bmp_per_peer_hdr_cached(s, peer, flags, &uptime_real);
+	stream_put(s, STREAM_DATA(msg), stream_get_endp(msg));
+	stream_putl_at(s, BMP_LENGTH_POS, stream_get_endp(s));
 
-	stream_putl_at(hdr, BMP_LENGTH_POS,
-			stream_get_endp(hdr) + stream_get_endp(msg));
+	stream_free(msg);
+	return s;
+}
+
+static void bmp_monitor(struct bmp *bmp, struct bgp *locrib,
+			struct peer *peer, uint8_t flags,
+			const struct prefix *p, struct prefix_rd *prd,
+			struct attr *attr, afi_t afi, safi_t safi,
+			time_t uptime)
+{
+	struct stream *s;
+
+	s = bmp_monitor_encode(locrib, peer, flags, p, prd, attr, afi, safi,
+			       uptime);
 
 	bmp->cnt_update++;
-	pullwr_write_stream(bmp->pullwr, hdr);
-	pullwr_write_stream(bmp->pullwr, msg);
-	stream_free(hdr);
-	stream_free(msg);
+	pullwr_write_stream(bmp->pullwr, s);
+	stream_free(s);
 }
 
 static bool bmp_wrsync(struct bmp *bmp, struct pullwr *pullwr)
@@ -947,6 +1127,7 @@ static bool bmp_wrsync(struct bmp *bmp, struct pullwr *pullwr)
 			bmp->syncafi = afi;
 			bmp->syncsafi = safi;
 			bmp->syncpeerid = 0;
+			bmp->synclocrib = false;
 			memset(&bmp->syncpos, 0, sizeof(bmp->syncpos));
 			bmp->syncpos.family = afi2family(afi);
 			bmp->syncrdpos = NULL;
@@ -973,10 +1154,22 @@ afibreak:
 		return true;
 	}
 
+	if ((bmp->targets->afimon[afi][safi] & BMP_MON_LOC_RIB)
+	    && !bmp->locrib_up) {
+		/* Loc-RIB monitoring was enabled on a running session */
+		bmp_send_peerup_locrib(bmp);
+		return true;
+	}
+
 	struct bgp_table *table = bmp->targets->bgp->rib[afi][safi];
 	struct bgp_dest *bn;
-	struct bgp_path_info *bpi = NULL, *bpiter;
+	struct bgp_path_info *bpi = NULL, *bpiter, *locbpi = NULL;
 	struct bgp_adj_in *adjin = NULL, *adjiter;
+	struct bgp_adj_out *adjout;
+	struct peer *outpeer = NULL;
+	struct attr *outattr = NULL;
+	struct peer_af *paf;
+	uint64_t minid;
 
 	if (afi == AFI_L2VPN && safi == SAFI_EVPN) {
 		/* initialize syncrdpos to the first
@@ -1031,6 +1224,14 @@ afibreak:
 						safi2str(safi));
 				bmp_eor(bmp, afi, safi, BMP_PEER_FLAG_L);
 				bmp_eor(bmp, afi, safi, 0);
+				if (bmp->targets->afimon[afi][safi]
+				    & BMP_MON_ADJ_OUT)
+					bmp_eor(bmp, afi, safi,
+						BMP_PEER_FLAG_O
+							| BMP_PEER_FLAG_L);
+				if (bmp->targets->afimon[afi][safi]
+				    & BMP_MON_LOC_RIB)
+					bmp_eor_locrib(bmp, afi, safi);
 
 				bmp->afistate[afi][safi] = BMP_AFI_LIVE;
 				bmp->syncafi = AFI_MAX;
@@ -1038,9 +1239,26 @@ afibreak:
 				return true;
 			}
 			bmp->syncpeerid = 0;
+			bmp->synclocrib = false;
 			prefix_copy(&bmp->syncpos, bgp_dest_get_prefix(bn));
 		}
 
+		/* Loc-RIB goes first for each prefix, then all peers in
+		 * order of their IDs, Adj-RIB-In and -Out together.
+		 */
+		if ((bmp->targets->afimon[afi][safi] & BMP_MON_LOC_RIB)
+		    && !bmp->synclocrib) {
+			for (bpiter = bgp_dest_get_bgp_path_info(bn); bpiter;
+			     bpiter = bpiter->next) {
+				if (CHECK_FLAG(bpiter->flags,
+					       BGP_PATH_SELECTED)) {
+					locbpi = bpiter;
+					break;
+				}
+			}
+			if (locbpi)
+				break;
+		}
 		if (bmp->targets->afimon[afi][safi] & BMP_MON_POSTPOLICY) {
 			for (bpiter = bgp_dest_get_bgp_path_info(bn); bpiter;
 			     bpiter = bpiter->next) {
@@ -1067,41 +1285,100 @@ afibreak:
 				adjin = adjiter;
 			}
 		}
-		if (bpi || adjin)
+		if (bmp->targets->afimon[afi][safi] & BMP_MON_ADJ_OUT) {
+			RB_FOREACH (adjout, bgp_adj_out_rb, &bn->adj_out) {
+				struct attr *attr;
+
+				if (adjout->adv)
+					attr = adjout->adv->baa
+						? adjout->adv->baa->attr
+						: NULL;
+				else
+					attr = adjout->attr;
+				if (!attr)
+					continue;
+
+				SUBGRP_FOREACH_PEER (adjout->subgroup, paf) {
+					struct peer *peer = PAF_PEER(paf);
+
+					if (peer->qobj_node.nid
+					    <= bmp->syncpeerid)
+						continue;
+					if (outpeer && peer->qobj_node.nid
+							> outpeer->qobj_node.nid)
+						continue;
+					outpeer = peer;
+					outattr = attr;
+				}
+			}
+		}
+		if (bpi || adjin || outpeer)
 			break;
 
 		bn = NULL;
 	} while (1);
 
-	if (adjin && bpi
-	    && adjin->peer->qobj_node.nid < bpi->peer->qobj_node.nid) {
-		bpi = NULL;
-		bmp->syncpeerid = adjin->peer->qobj_node.nid;
-	} else if (adjin && bpi
-		   && adjin->peer->qobj_node.nid > bpi->peer->qobj_node.nid) {
-		adjin = NULL;
-		bmp->syncpeerid = bpi->peer->qobj_node.nid;
-	} else if (bpi) {
-		bmp->syncpeerid = bpi->peer->qobj_node.nid;
-	} else if (adjin) {
-		bmp->syncpeerid = adjin->peer->qobj_node.nid;
-	}
-
 	const struct prefix *bn_p = bgp_dest_get_prefix(bn);
 	struct prefix_rd *prd = NULL;
 	if (afi == AFI_L2VPN && safi == SAFI_EVPN)
 		prd = (struct prefix_rd *)bgp_dest_get_prefix(bmp->syncrdpos);
 
+	if (locbpi) {
+		bmp->synclocrib = true;
+		bmp_monitor(bmp, bmp->targets->bgp, locbpi->peer, 0, bn_p, prd,
+			    locbpi->attr, afi, safi, locbpi->uptime);
+		return true;
+	}
+
+	/* send everything for the lowest peer ID, continue from there */
+	minid = UINT64_MAX;
+	if (bpi)
+		minid = MIN(minid, bpi->peer->qobj_node.nid);
+	if (adjin)
+		minid = MIN(minid, adjin->peer->qobj_node.nid);
+	if (outpeer)
+		minid = MIN(minid, outpeer->qobj_node.nid);
+
+	if (bpi && bpi->peer->qobj_node.nid != minid)
+		bpi = NULL;
+	if (adjin && adjin->peer->qobj_node.nid != minid)
+		adjin = NULL;
+	if (outpeer && outpeer->qobj_node.nid != minid)
+		outpeer = NULL;
+	bmp->syncpeerid = minid;
+
 	if (bpi)
-		bmp_monitor(bmp, bpi->peer, BMP_PEER_FLAG_L, bn_p, prd,
+		bmp_monitor(bmp, NULL, bpi->peer, BMP_PEER_FLAG_L, bn_p, prd,
 			    bpi->attr, afi, safi, bpi->uptime);
 	if (adjin)
-		bmp_monitor(bmp, adjin->peer, 0, bn_p, prd, adjin->attr, afi,
-			    safi, adjin->uptime);
+		bmp_monitor(bmp, NULL, adjin->peer, 0, bn_p, prd, adjin->attr,
+			    afi, safi, adjin->uptime);
+	if (outpeer)
+		bmp_monitor(bmp, NULL, outpeer,
+			    BMP_PEER_FLAG_O | BMP_PEER_FLAG_L, bn_p, prd,
+			    outattr, afi, safi, monotime(NULL));
 
 	return true;
 }
 
+static void bmp_queue_entry_flush(struct bmp_targets *bt,
+				  struct bmp_queue_entry *bqe)
+{
+	if (!bqe->mondata)
+		return;
+
+	bt->upd_qsize -= bqe->monlen;
+	XFREE(MTYPE_BMP_QUEUE_MSG, bqe->mondata);
+}
+
+static void bmp_queue_entry_free(struct bmp_targets *bt,
+				 struct bmp_queue_entry *bqe)
+{
+	bmp_queue_entry_flush(bt, bqe);
+	bt->upd_qsize -= sizeof(*bqe);
+	XFREE(MTYPE_BMP_QUEUE, bqe);
+}
+
 static struct bmp_queue_entry *bmp_pull(struct bmp *bmp)
 {
 	struct bmp_queue_entry *bqe;
@@ -1120,11 +1397,132 @@ static struct bmp_queue_entry *bmp_pull(struct bmp *bmp)
 	return bqe;
 }
 
+/* the advertisement to peer in bn's Adj-RIB-Out, which may not have been
+ * sent yet.  NULL if there is none or it is being withdrawn.
+ */
+static struct attr *bmp_adj_out_attr(struct bgp_dest *bn, struct peer *peer,
+				     afi_t afi, safi_t safi)
+{
+	struct peer_af *paf = peer_af_find(peer, afi, safi);
+	struct update_subgroup *subgrp;
+	struct bgp_adj_out *adj;
+
+	subgrp = paf ? PAF_SUBGRP(paf) : NULL;
+	if (!bn || !subgrp)
+		return NULL;
+
+	RB_FOREACH (adj, bgp_adj_out_rb, &bn->adj_out) {
+		if (adj->subgroup != subgrp)
+			continue;
+		if (adj->adv)
+			return adj->adv->baa ? adj->adv->baa->attr : NULL;
+		return adj->attr;
+	}
+	return NULL;
+}
+
+/* all sessions in a bmp_targets share the monitoring config, so the
+ * messages for a queue entry are the same for all of them.  Encode them
+ * once into a flat buffer (like bmp_mirrorq) that the other sessions
+ * write out directly.
+ */
+static void bmp_queue_encode(struct bmp_targets *bt,
+			     struct bmp_queue_entry *bqe, struct peer *peer)
+{
+	afi_t afi = bqe->afi;
+	safi_t safi = bqe->safi;
+	struct stream *msgs[2];
+	struct bgp_dest *bn;
+	struct prefix_rd *prd = NULL;
+	size_t i, pos;
+
+	bqe->moncount = 0;
+	bqe->monlen = 0;
+
+	bn = bgp_node_lookup(bt->bgp->rib[afi][safi], &bqe->p);
+	if (bqe->afi == AFI_L2VPN && bqe->safi == SAFI_EVPN)
+		prd = &bqe->rd;
+
+	switch (bqe->rib) {
+	case BMP_RIB_LOC: {
+		struct bgp_path_info *bpi;
+
+		for (bpi = bn ? bgp_dest_get_bgp_path_info(bn) : NULL; bpi;
+		     bpi = bpi->next) {
+			if (CHECK_FLAG(bpi->flags, BGP_PATH_SELECTED))
+				break;
+		}
+
+		msgs[bqe->moncount++] = bmp_monitor_encode(
+			bt->bgp, bpi ? bpi->peer : bt->bgp->peer_self, 0,
+			&bqe->p, prd, bpi ? bpi->attr : NULL, afi, safi,
+			bpi ? bpi->uptime : monotime(NULL));
+		break;
+	}
+
+	case BMP_RIB_ADJ_OUT:
+		msgs[bqe->moncount++] = bmp_monitor_encode(
+			NULL, peer, BMP_PEER_FLAG_O | BMP_PEER_FLAG_L, &bqe->p,
+			prd, bmp_adj_out_attr(bn, peer, afi, safi), afi, safi,
+			monotime(NULL));
+		break;
+
+	case BMP_RIB_ADJ_IN:
+		if (bt->afimon[afi][safi] & BMP_MON_POSTPOLICY) {
+			struct bgp_path_info *bpi;
+
+			for (bpi = bn ? bgp_dest_get_bgp_path_info(bn) : NULL;
+			     bpi; bpi = bpi->next) {
+				if (!CHECK_FLAG(bpi->flags, BGP_PATH_VALID))
+					continue;
+				if (bpi->peer == peer)
+					break;
+			}
+
+			msgs[bqe->moncount++] = bmp_monitor_encode(
+				NULL, peer, BMP_PEER_FLAG_L, &bqe->p, prd,
+				bpi ? bpi->attr : NULL, afi, safi,
+				bpi ? bpi->uptime : monotime(NULL));
+		}
+
+		if (bt->afimon[afi][safi] & BMP_MON_PREPOLICY) {
+			struct bgp_adj_in *adjin;
+
+			for (adjin = bn ? bn->adj_in : NULL; adjin;
+			     adjin = adjin->next) {
+				if (adjin->peer == peer)
+					break;
+			}
+			msgs[bqe->moncount++] = bmp_monitor_encode(
+				NULL, peer, BMP_PEER_FLAG_L, &bqe->p, prd,
+				adjin ? adjin->attr : NULL, afi, safi,
+				adjin ? adjin->uptime : monotime(NULL));
+		}
+		break;
+	}
+
+	if (bn)
+		bgp_dest_unlock_node(bn);
+
+	for (i = 0; i < bqe->moncount; i++)
+		bqe->monlen += stream_get_endp(msgs[i]);
+
+	bqe->mondata = XMALLOC(MTYPE_BMP_QUEUE_MSG, MAX(bqe->monlen, 1));
+	for (i = 0, pos = 0; i < bqe->moncount; i++) {
+		memcpy(bqe->mondata + pos, STREAM_DATA(msgs[i]),
+		       stream_get_endp(msgs[i]));
+		pos += stream_get_endp(msgs[i]);
+		stream_free(msgs[i]);
+	}
+
+	bt->upd_qsize += bqe->monlen;
+	bt->upd_qsizemax = MAX(bt->upd_qsizemax, bt->upd_qsize);
+}
+
 static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
 {
 	struct bmp_queue_entry *bqe;
-	struct peer *peer;
-	struct bgp_dest *bn;
+	struct peer *peer = NULL;
 	bool written = false;
 
 	bqe = bmp_pull(bmp);
@@ -1151,53 +1549,28 @@ static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
 		break;
 	}
 
-	peer = QOBJ_GET_TYPESAFE(bqe->peerid, peer);
-	if (!peer) {
-		zlog_info("bmp: skipping queued item for deleted peer");
-		goto out;
-	}
-	if (!peer_established(peer))
-		goto out;
-
-	bn = bgp_node_lookup(bmp->targets->bgp->rib[afi][safi], &bqe->p);
-	struct prefix_rd *prd = NULL;
-	if (bqe->afi == AFI_L2VPN && bqe->safi == SAFI_EVPN)
-		prd = &bqe->rd;
-
-	if (bmp->targets->afimon[afi][safi] & BMP_MON_POSTPOLICY) {
-		struct bgp_path_info *bpi;
-
-		for (bpi = bn ? bgp_dest_get_bgp_path_info(bn) : NULL; bpi;
-		     bpi = bpi->next) {
-			if (!CHECK_FLAG(bpi->flags, BGP_PATH_VALID))
-				continue;
-			if (bpi->peer == peer)
-				break;
+	if (bqe->rib != BMP_RIB_LOC) {
+		peer = QOBJ_GET_TYPESAFE(bqe->peerid, peer);
+		if (!peer) {
+			zlog_info("bmp: skipping queued item for deleted peer");
+			goto out;
 		}
-
-		bmp_monitor(bmp, peer, BMP_PEER_FLAG_L, &bqe->p, prd,
-			    bpi ? bpi->attr : NULL, afi, safi,
-			    bpi ? bpi->uptime : monotime(NULL));
-		written = true;
+		if (!peer_established(peer))
+			goto out;
 	}
 
-	if (bmp->targets->afimon[afi][safi] & BMP_MON_PREPOLICY) {
-		struct bgp_adj_in *adjin;
+	if (!bqe->mondata)
+		bmp_queue_encode(bmp->targets, bqe, peer);
 
-		for (adjin = bn ? bn->adj_in : NULL; adjin;
-		     adjin = adjin->next) {
-			if (adjin->peer == peer)
-				break;
-		}
-		bmp_monitor(bmp, peer, BMP_PEER_FLAG_L, &bqe->p, prd,
-			    adjin ? adjin->attr : NULL, afi, safi,
-			    adjin ? adjin->uptime : monotime(NULL));
+	if (bqe->moncount) {
+		bmp->cnt_update += bqe->moncount;
+		pullwr_write(bmp->pullwr, bqe->mondata, bqe->monlen);
 		written = true;
 	}
 
 out:
 	if (!bqe->refcount)
-		XFREE(MTYPE_BMP_QUEUE, bqe);
+		bmp_queue_entry_free(bmp->targets, bqe);
 	return written;
 }
 
@@ -1232,8 +1605,61 @@ static void bmp_wrerr(struct bmp *bmp, struct pullwr *pullwr, bool eof)
 	bmp_free(bmp);
 }
 
+/* a session is holding on to more queued updates than the buffer limit
+ * allows.  Unlike mirroring, nothing can be declared lost here, so the
+ * queue is dropped and the session resynchronizes all tables instead.
+ */
+static void bmp_queue_overrun(struct bmp *bmp)
+{
+	struct bmp_queue_entry *bqe;
+	afi_t afi;
+	safi_t safi;
+
+	while ((bqe = bmp_pull(bmp)))
+		if (!bqe->refcount)
+			bmp_queue_entry_free(bmp->targets, bqe);
+
+	FOREACH_AFI_SAFI (afi, safi) {
+		if (bmp->afistate[afi][safi] != BMP_AFI_INACTIVE)
+			bmp->afistate[afi][safi] = BMP_AFI_NEEDSYNC;
+	}
+	bmp->syncafi = AFI_MAX;
+	bmp->syncsafi = SAFI_MAX;
+
+	zlog_warn("bmp[%s] route monitoring fell behind buffer size limit, resynchronizing",
+		  bmp->remote);
+	bmp->cnt_update_overruns++;
+	pullwr_bump(bmp->pullwr);
+}
+
+static void bmp_queue_cull(struct bmp_targets *bt)
+{
+	while (bt->upd_qsize > bt->upd_qsizelimit) {
+		struct bmp_queue_entry *bqe;
+		struct bmp *bmp;
+		bool found = false;
+
+		bqe = bmp_qlist_first(&bt->updlist);
+		if (!bqe)
+			break;
+
+		frr_each (bmp_session, &bt->sessions, bmp) {
+			if (bmp->queuepos != bqe)
+				continue;
+
+			bmp_queue_overrun(bmp);
+			found = true;
+			/* bqe may be gone now */
+			break;
+		}
+		if (!found)
+			break;
+	}
+}
+
 static void bmp_process_one(struct bmp_targets *bt, struct bgp *bgp, afi_t afi,
-			    safi_t safi, struct bgp_dest *bn, struct peer *peer)
+			    safi_t safi, struct bgp_dest *bn, uint64_t peerid,
+			    enum bmp_rib rib)
 {
 	struct bmp *bmp;
 	struct bmp_queue_entry *bqe, bqeref;
@@ -1245,9 +1671,10 @@ static void bmp_process_one(struct bmp_targets *bt, struct bgp *bgp, afi_t afi,
 
 	memset(&bqeref, 0, sizeof(bqeref));
 	prefix_copy(&bqeref.p, bgp_dest_get_prefix(bn));
-	bqeref.peerid = peer->qobj_node.nid;
+	bqeref.peerid = peerid;
 	bqeref.afi = afi;
 	bqeref.safi = safi;
+	bqeref.rib = rib;
 
 	if (afi == AFI_L2VPN && safi == SAFI_EVPN && bn->pdest)
 		prefix_copy(&bqeref.rd,
@@ -1255,24 +1682,41 @@ static void bmp_process_one(struct bmp_targets *bt, struct bgp *bgp, afi_t afi,
 
 	bqe = bmp_qhash_find(&bt->updhash, &bqeref);
 	if (bqe) {
+		/* RIB changed, previously encoded messages are outdated */
+		bmp_queue_entry_flush(bt, bqe);
+
 		if (bqe->refcount >= refcount)
 			/* nothing to do here */
 			return;
 
+		/* sessions that were about to send this one move on to the
+		 * next entry, they pick it up again at the tail
+		 */
+		frr_each (bmp_session, &bt->sessions, bmp)
+			if (bmp->queuepos == bqe)
+				bmp->queuepos = bmp_qlist_next(&bt->updlist,
+							       bqe);
+
 		bmp_qlist_del(&bt->updlist, bqe);
 	} else {
 		bqe = XMALLOC(MTYPE_BMP_QUEUE, sizeof(*bqe));
 		memcpy(bqe, &bqeref, sizeof(*bqe));
 
 		bmp_qhash_add(&bt->updhash, bqe);
+		bt->upd_qsize += sizeof(*bqe);
 	}
 
 	bqe->refcount = refcount;
+	bqe->seq = ++bt->updseq;
+	monotime(&bqe->queued);
 	bmp_qlist_add_tail(&bt->updlist, bqe);
 
 	frr_each (bmp_session, &bt->sessions, bmp)
 		if (!bmp->queuepos)
 			bmp->queuepos = bqe;
+
+	bt->upd_qsizemax = MAX(bt->upd_qsizemax, bt->upd_qsize);
+	bmp_queue_cull(bt);
 }
 
 static int bmp_process(struct bgp *bgp, afi_t afi, safi_t safi,
@@ -1294,10 +1738,12 @@ static int bmp_process(struct bgp *bgp, afi_t afi, safi_t safi,
 		return 0;
 
 	frr_each(bmp_targets, &bmpbgp->targets, bt) {
-		if (!bt->afimon[afi][safi])
+		if (!(bt->afimon[afi][safi]
+		      & (BMP_MON_PREPOLICY | BMP_MON_POSTPOLICY)))
 			continue;
 
-		bmp_process_one(bt, bgp, afi, safi, bn, peer);
+		bmp_process_one(bt, bgp, afi, safi, bn, peer->qobj_node.nid,
+				BMP_RIB_ADJ_IN);
 
 		frr_each(bmp_session, &bt->sessions, bmp) {
 			pullwr_bump(bmp->pullwr);
@@ -1306,6 +1752,59 @@ static int bmp_process(struct bgp *bgp, afi_t afi, safi_t safi,
 	return 0;
 }
 
+static int bmp_route_update(struct bgp *bgp, afi_t afi, safi_t safi,
+			    struct bgp_dest *bn,
+			    struct bgp_path_info *old_route,
+			    struct bgp_path_info *new_route)
+{
+	struct bmp_bgp *bmpbgp = bmp_bgp_find(bgp);
+	struct bmp_targets *bt;
+	struct bmp *bmp;
+
+	if (!bmpbgp)
+		return 0;
+
+	frr_each (bmp_targets, &bmpbgp->targets, bt) {
+		if (!(bt->afimon[afi][safi] & BMP_MON_LOC_RIB))
+			continue;
+
+		bmp_process_one(bt, bgp, afi, safi, bn, 0, BMP_RIB_LOC);
+
+		frr_each (bmp_session, &bt->sessions, bmp)
+			pullwr_bump(bmp->pullwr);
+	}
+	return 0;
+}
+
+static int bmp_adj_out_updated(struct update_subgroup *subgrp,
+			       struct bgp_dest *bn)
+{
+	struct bgp *bgp = SUBGRP_INST(subgrp);
+	struct bmp_bgp *bmpbgp = bmp_bgp_find(bgp);
+	afi_t afi = SUBGRP_AFI(subgrp);
+	safi_t safi = SUBGRP_SAFI(subgrp);
+	struct bmp_targets *bt;
+	struct peer_af *paf;
+	struct bmp *bmp;
+
+	if (!bmpbgp)
+		return 0;
+
+	frr_each (bmp_targets, &bmpbgp->targets, bt) {
+		if (!(bt->afimon[afi][safi] & BMP_MON_ADJ_OUT))
+			continue;
+
+		SUBGRP_FOREACH_PEER (subgrp, paf)
+			bmp_process_one(bt, bgp, afi, safi, bn,
+					PAF_PEER(paf)->qobj_node.nid,
+					BMP_RIB_ADJ_OUT);
+
+		frr_each (bmp_session, &bt->sessions, bmp)
+			pullwr_bump(bmp->pullwr);
+	}
+	return 0;
+}
+
 static void bmp_stat_put_u32(struct stream *s, size_t *cnt, uint16_t type,
 		uint32_t value)
 {
@@ -1507,7 +2006,7 @@ static void bmp_close(struct bmp *bmp)
 			XFREE(MTYPE_BMP_MIRRORQ, bmq);
 	while ((bqe = bmp_pull(bmp)))
 		if (!bqe->refcount)
-			XFREE(MTYPE_BMP_QUEUE, bqe);
+			bmp_queue_entry_free(bmp->targets, bqe);
 
 	THREAD_OFF(bmp->t_read);
 	pullwr_del(bmp->pullwr);
@@ -1606,6 +2105,7 @@ static struct bmp_targets *bmp_targets_get(struct bgp *bgp, const char *name)
 	bmp_session_init(&bt->sessions);
 	bmp_qhash_init(&bt->updhash);
 	bmp_qlist_init(&bt->updlist);
+	bt->upd_qsizelimit = ~0UL;
 	bmp_actives_init(&bt->actives);
 	bmp_listeners_init(&bt->listeners);
 
@@ -2130,17 +2630,20 @@ DEFPY(bmp_stats_cfg,
 
 DEFPY(bmp_monitor_cfg,
       bmp_monitor_cmd,
-      "[no] bmp monitor <ipv4|ipv6|l2vpn> <unicast|multicast|evpn> <pre-policy|post-policy>$policy",
+      "[no] bmp monitor <ipv4|ipv6|l2vpn> <unicast|multicast|evpn> <pre-policy|post-policy|loc-rib|adj-rib-out>$policy",
       NO_STR
       BMP_STR
       "Send BMP route monitoring messages\n"
       "Address Family\nAddress Family\nAddress Family\n"
       "Address Family\nAddress Family\nAddress Family\n"
       "Send state before policy and filter processing\n"
-      "Send state with policy and filters applied\n")
+      "Send state with policy and filters applied\n"
+      "Send selected best paths (RFC 9069 Loc-RIB)\n"
+      "Send state advertised to peers, after policy (RFC 8671 Adj-RIB-Out)\n")
 {
 	int index = 0;
 	uint8_t flag, prev;
+	bool locrib;
 	afi_t afi;
 	safi_t safi;
 
@@ -2150,7 +2653,11 @@ DEFPY(bmp_monitor_cfg,
 	argv_find_and_parse_afi(argv, argc, &index, &afi);
 	argv_find_and_parse_safi(argv, argc, &index, &safi);
 
-	if (policy[1] == 'r')
+	if (policy[0] == 'l')
+		flag = BMP_MON_LOC_RIB;
+	else if (policy[0] == 'a')
+		flag = BMP_MON_ADJ_OUT;
+	else if (policy[1] == 'r')
 		flag = BMP_MON_PREPOLICY;
 	else
 		flag = BMP_MON_POSTPOLICY;
@@ -2164,7 +2671,12 @@ DEFPY(bmp_monitor_cfg,
 	if (prev == bt->afimon[afi][safi])
 		return CMD_SUCCESS;
 
+	locrib = bmp_targets_locrib(bt);
+
 	frr_each (bmp_session, &bt->sessions, bmp) {
+		if (!locrib && bmp->locrib_up)
+			bmp_send_peerdown_locrib(bmp);
+
 		if (bmp->syncafi == afi && bmp->syncsafi == safi) {
 			bmp->syncafi = AFI_MAX;
 			bmp->syncsafi = SAFI_MAX;
@@ -2208,6 +2720,38 @@ DEFPY(bmp_mirror_cfg,
 	return CMD_SUCCESS;
 }
 
+DEFPY(bmp_monitor_limit_cfg,
+      bmp_monitor_limit_cmd,
+      "bmp monitor buffer-limit (0-4294967294)",
+      BMP_STR
+      "Route Monitoring settings\n"
+      "Configure maximum memory used for queued monitoring messages\n"
+      "Limit in bytes\n")
+{
+	VTY_DECLVAR_CONTEXT_SUB(bmp_targets, bt);
+
+	bt->upd_qsizelimit = buffer_limit;
+	bmp_queue_cull(bt);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY(no_bmp_monitor_limit_cfg,
+      no_bmp_monitor_limit_cmd,
+      "no bmp monitor buffer-limit [(0-4294967294)]",
+      NO_STR
+      BMP_STR
+      "Route Monitoring settings\n"
+      "Configure maximum memory used for queued monitoring messages\n"
+      "Limit in bytes\n")
+{
+	VTY_DECLVAR_CONTEXT_SUB(bmp_targets, bt);
+
+	bt->upd_qsizelimit = ~0UL;
+
+	return CMD_SUCCESS;
+}
+
 DEFPY(bmp_mirror_limit_cfg,
       bmp_mirror_limit_cmd,
       "bmp mirror buffer-limit (0-4294967294)",
@@ -2282,24 +2826,28 @@ DEFPY(show_bmp,
 			safi_t safi;
 
 			FOREACH_AFI_SAFI (afi, safi) {
-				const char *str = NULL;
+				uint8_t mon = bt->afimon[afi][safi];
 
-				switch (bt->afimon[afi][safi]) {
-				case BMP_MON_PREPOLICY:
-					str = "pre-policy";
-					break;
-				case BMP_MON_POSTPOLICY:
-					str = "post-policy";
-					break;
-				case BMP_MON_PREPOLICY | BMP_MON_POSTPOLICY:
-					str = "pre-policy and post-policy";
-					break;
-				}
-				if (!str)
+				if (!mon)
 					continue;
-				vty_out(vty, "    Route Monitoring %s %s %s\n",
-					afi2str(afi), safi2str(safi), str);
+				vty_out(vty, "    Route Monitoring %s %s%s%s%s%s\n",
+					afi2str(afi), safi2str(safi),
+					(mon & BMP_MON_PREPOLICY)
+						? " pre-policy" : "",
+					(mon & BMP_MON_POSTPOLICY)
+						? " post-policy" : "",
+					(mon & BMP_MON_LOC_RIB)
+						? " loc-rib" : "",
+					(mon & BMP_MON_ADJ_OUT)
+						? " adj-rib-out" : "");
 			}
+			vty_out(vty, "    Route Monitoring %9zu bytes (%zu updates) pending\n",
+				bt->upd_qsize, bmp_qlist_count(&bt->updlist));
+			vty_out(vty, "                     %9zu bytes maximum buffer used\n",
+				bt->upd_qsizemax);
+			if (bt->upd_qsizelimit != ~0UL)
+				vty_out(vty, "                     %9zu bytes buffer size limit\n",
+					bt->upd_qsizelimit);
 
 			vty_out(vty, "    Listeners:\n");
 			frr_each (bmp_listeners, &bt->listeners, bl)
@@ -2355,11 +2903,11 @@ DEFPY(show_bmp,
 			vty_out(vty, "\n    %zu connected clients:\n",
 					bmp_session_count(&bt->sessions));
 			tt = ttable_new(&ttable_styles[TTSTYLE_BLANK]);
-			ttable_add_row(tt, "remote|uptime|MonSent|MirrSent|MirrLost|ByteSent|ByteQ|ByteQKernel");
+			ttable_add_row(tt, "remote|uptime|MonSent|MonQ|MonLag|MonResync|MirrSent|MirrLost|ByteSent|ByteQ|ByteQKernel");
 			ttable_rowseps(tt, 0, BOTTOM, true, '-');
 
 			frr_each (bmp_session, &bt->sessions, bmp) {
-				uint64_t total;
+				uint64_t total, monq = 0, lagms = 0;
 				size_t q, kq;
 
 				pullwr_stats(bmp->pullwr, &total, &q, &kq);
@@ -2367,9 +2915,19 @@ DEFPY(show_bmp,
 				peer_uptime(bmp->t_up.tv_sec, uptime,
 					    sizeof(uptime), false, NULL);
 
-				ttable_add_row(tt, "%s|%s|%Lu|%Lu|%Lu|%Lu|%zu|%zu",
+				/* lag = updates queued & age of the oldest */
+				if (bmp->queuepos) {
+					monq = bt->updseq - bmp->queuepos->seq
+					       + 1;
+					lagms = monotime_since(
+							&bmp->queuepos->queued,
+							NULL) / 1000;
+				}
+
+				ttable_add_row(tt, "%s|%s|%Lu|%Lu|%Lums|%Lu|%Lu|%Lu|%Lu|%zu|%zu",
 					       bmp->remote, uptime,
-					       bmp->cnt_update,
+					       bmp->cnt_update, monq, lagms,
+					       bmp->cnt_update_overruns,
 					       bmp->cnt_mirror,
 					       bmp->cnt_mirror_overruns,
 					       total, q, kq);
@@ -2426,7 +2984,16 @@ static int bmp_config_write(struct bgp *bgp, struct vty *vty)
 			if (bt->afimon[afi][safi] & BMP_MON_POSTPOLICY)
 				vty_out(vty, "  bmp monitor %s %s post-policy\n",
 					afi_str, safi2str(safi));
+			if (bt->afimon[afi][safi] & BMP_MON_LOC_RIB)
+				vty_out(vty, "  bmp monitor %s %s loc-rib\n",
+					afi_str, safi2str(safi));
+			if (bt->afimon[afi][safi] & BMP_MON_ADJ_OUT)
+				vty_out(vty, "  bmp monitor %s %s adj-rib-out\n",
+					afi_str, safi2str(safi));
 		}
+		if (bt->upd_qsizelimit != ~0UL)
+			vty_out(vty, "  bmp monitor buffer-limit %zu\n",
+				bt->upd_qsizelimit);
 		frr_each (bmp_listeners, &bt->listeners, bl)
 			vty_out(vty, " \n  bmp listener %s port %d\n",
 				sockunion2str(&bl->addr, buf, SU_ADDRSTRLEN),
@@ -2458,6 +3025,8 @@ static int bgp_bmp_init(struct thread_master *tm)
 	install_element(BMP_NODE, &bmp_acl_cmd);
 	install_element(BMP_NODE, &bmp_stats_cmd);
 	install_element(BMP_NODE, &bmp_monitor_cmd);
+	install_element(BMP_NODE, &bmp_monitor_limit_cmd);
+	install_element(BMP_NODE, &no_bmp_monitor_limit_cmd);
 	install_element(BMP_NODE, &bmp_mirror_cmd);
 
 	install_element(BGP_NODE, &bmp_mirror_limit_cmd);
@@ -2476,6 +3045,8 @@ static int bgp_bmp_module_init(void)
 	hook_register(peer_status_changed, bmp_peer_status_changed);
 	hook_register(peer_backward_transition, bmp_peer_backward);
 	hook_register(bgp_process, bmp_process);
+	hook_register(bgp_route_update, bmp_route_update);
+	hook_register(bgp_adj_out_updated, bmp_adj_out_updated);
 	hook_register(bgp_inst_config_write, bmp_config_write);
 	hook_register(bgp_inst_delete, bmp_bgp_del);
 	hook_register(frr_late_init, bgp_bmp_init);
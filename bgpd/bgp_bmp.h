@@ -30,6 +30,9 @@
 
 #define BMP_LENGTH_POS  1
 
+/* common header + per-peer header */
+#define BMP_MONITOR_HDR_LEN	(6 + 42)
+
 /* BMP message types */
 #define BMP_TYPE_ROUTE_MONITORING       0
 #define BMP_TYPE_STATISTICS_REPORT      1
@@ -69,19 +72,40 @@
 PREDECL_DLIST(bmp_qlist);
 PREDECL_HASH(bmp_qhash);
 
+enum bmp_rib {
+	BMP_RIB_ADJ_IN = 0,
+	BMP_RIB_LOC,
+	BMP_RIB_ADJ_OUT,
+};
+
 struct bmp_queue_entry {
 	struct bmp_qlist_item bli;
 	struct bmp_qhash_item bhi;
 
 	struct prefix p;
+	/* 0 for BMP_RIB_LOC */
 	uint64_t peerid;
 	afi_t afi;
 	safi_t safi;
+	/* enum bmp_rib */
+	uint8_t rib;
 
 	size_t refcount;
 
+	/* position in bmp_targets->updlist & time queued, for lag stats */
+	uint64_t seq;
+	struct timeval queued;
+
 	/* initialized only for L2VPN/EVPN (S)AFIs */
 	struct prefix_rd rd;
+
+	/* route monitoring message(s) for this entry, encoded by the first
+	 * session that sends it and replayed as-is by the others.  Dropped
+	 * whenever the entry is re-queued since the RIB has changed then.
+	 */
+	uint8_t *mondata;
+	size_t monlen;
+	uint8_t moncount;
 };
 
 /* This is for BMP Route Mirroring, which feeds fully raw BGP PDUs out to BMP
@@ -146,18 +170,26 @@ struct bmp {
 
 	/* counters for the various BMP packet types */
 	uint64_t cnt_update, cnt_mirror;
+	/* number of times this session fell behind by more than the
+	 * monitoring buffer limit and had to restart table sync
+	 */
+	uint64_t cnt_update_overruns;
 	/* number of times this peer wasn't fast enough in consuming the
 	 * mirror queue
 	 */
 	uint64_t cnt_mirror_overruns;
 	struct timeval t_up;
 
+	/* Loc-RIB "peer" up message sent */
+	bool locrib_up;
+
 	/* synchronization / startup works by repeatedly finding the next
 	 * table entry, the sync* fields note down what we sent last
 	 */
 	struct prefix syncpos;
 	struct bgp_dest *syncrdpos;
 	uint64_t syncpeerid;
+	bool synclocrib;
 	afi_t syncafi;
 	safi_t syncsafi;
 };
@@ -232,6 +264,8 @@ struct bmp_targets {
 	 */
 #define BMP_MON_PREPOLICY	(1 << 0)
 #define BMP_MON_POSTPOLICY	(1 << 1)
+#define BMP_MON_LOC_RIB		(1 << 2)
+#define BMP_MON_ADJ_OUT		(1 << 3)
 	uint8_t afimon[AFI_MAX][SAFI_MAX];
 	bool mirror;
 
@@ -242,6 +276,13 @@ struct bmp_targets {
 
 	struct bmp_qhash_head updhash;
 	struct bmp_qlist_head updlist;
+	uint64_t updseq;
+
+	/* memory used by updlist, including encoded messages; sessions that
+	 * hold the oldest entry when this exceeds the limit are resynced.
+	 */
+	size_t upd_qsize, upd_qsizemax;
+	size_t upd_qsizelimit;
 
 	uint64_t cnt_accept, cnt_aclrefused;
 
@@ -264,6 +305,14 @@ struct bmp_bgp_peer {
 
 	uint8_t *open_tx;
 	size_t open_tx_len;
+
+	/* per-peer header from Peer Distinguisher up to Peer BGP ID; peer
+	 * address, AS & router-id only change across session resets, so
+	 * this is flushed from the peer status hooks.
+	 */
+#define BMP_PEER_HDR_CACHED_LEN	32
+	bool hdr_valid;
+	uint8_t hdr[BMP_PEER_HDR_CACHED_LEN];
 };
 
 /* per struct bgp * data */
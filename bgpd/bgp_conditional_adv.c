@@ -23,43 +23,96 @@
 #include "bgpd/bgp_conditional_adv.h"
 #include "bgpd/bgp_vty.h"
 
-static route_map_result_t
-bgp_check_rmap_prefixes_in_bgp_table(struct bgp_table *table,
-				     struct route_map *rmap)
+DEFINE_MTYPE_STATIC(BGPD, BGP_CONDITION_ADV,
+		    "BGP conditional advertisement state");
+
+
+/* Peers using the same advertise-map/condition-map pair for an AFI/SAFI
+ * share one evaluation of the condition-map. The pairs are indexed per
+ * BGP instance so that a change to a single destination only has to be
+ * checked against each distinct pair, not against every peer.
+ */
+struct bgp_condition_adv {
+	afi_t afi;
+	safi_t safi;
+
+	char *aname;
+	char *cname;
+	bool condition;
+
+	/* Result of the last condition-map evaluation */
+	enum update_type update_type;
+
+	/* Whether some route matched the condition-map, and its prefix */
+	bool exists;
+	struct prefix match;
+
+	/* A table change may have altered the condition-map result */
+	bool cond_changed;
+
+	/* A route in the advertise-map changed while withdrawn */
+	bool adv_changed;
+
+	/* Still referenced by some peer */
+	bool in_use;
+};
+
+/* labeled-unicast routes are installed in the unicast table */
+static inline safi_t bgp_conditional_adv_table_safi(safi_t safi)
+{
+	return (safi == SAFI_LABELED_UNICAST) ? SAFI_UNICAST : safi;
+}
+
+/* Check if any path of the destination is permitted by the route-map. */
+static bool bgp_conditional_adv_dest_match(struct bgp_dest *dest,
+					   struct route_map *rmap)
 {
 	struct attr dummy_attr = {0};
-	struct bgp_dest *dest;
 	struct bgp_path_info *pi;
 	struct bgp_path_info path = {0};
 	struct bgp_path_info_extra path_extra = {0};
 	const struct prefix *dest_p;
-	route_map_result_t ret = RMAP_DENYMATCH;
+	route_map_result_t ret;
 
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		dest_p = bgp_dest_get_prefix(dest);
-		assert(dest_p);
+	dest_p = bgp_dest_get_prefix(dest);
+	assert(dest_p);
 
-		for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next) {
-			dummy_attr = *pi->attr;
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next) {
+		dummy_attr = *pi->attr;
 
-			/* Fill temp path_info */
-			prep_for_rmap_apply(&path, &path_extra, dest, pi,
-					    pi->peer, &dummy_attr);
+		/* Fill temp path_info */
+		prep_for_rmap_apply(&path, &path_extra, dest, pi, pi->peer,
+				    &dummy_attr);
 
-			RESET_FLAG(dummy_attr.rmap_change_flags);
+		RESET_FLAG(dummy_attr.rmap_change_flags);
 
-			ret = route_map_apply(rmap, dest_p, &path);
-			bgp_attr_flush(&dummy_attr);
+		ret = route_map_apply(rmap, dest_p, &path);
+		bgp_attr_flush(&dummy_attr);
 
-			if (ret == RMAP_PERMITMATCH) {
-				bgp_dest_unlock_node(dest);
-				if (BGP_DEBUG(update, UPDATE_OUT))
-					zlog_debug(
-						"%s: Condition map routes present in BGP table",
-						__func__);
+		if (ret == RMAP_PERMITMATCH)
+			return true;
+	}
 
-				return ret;
-			}
+	return false;
+}
+
+static route_map_result_t
+bgp_check_rmap_prefixes_in_bgp_table(struct bgp_table *table,
+				     struct route_map *rmap,
+				     struct prefix *match)
+{
+	struct bgp_dest *dest;
+
+	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
+		if (bgp_conditional_adv_dest_match(dest, rmap)) {
+			prefix_copy(match, bgp_dest_get_prefix(dest));
+			bgp_dest_unlock_node(dest);
+			if (BGP_DEBUG(update, UPDATE_OUT))
+				zlog_debug(
+					"%s: Condition map routes present in BGP table",
+					__func__);
+
+			return RMAP_PERMITMATCH;
 		}
 	}
 
@@ -67,7 +120,150 @@ bgp_check_rmap_prefixes_in_bgp_table(struct bgp_table *table,
 		zlog_debug("%s: Condition map routes not present in BGP table",
 			   __func__);
 
-	return ret;
+	return RMAP_DENYMATCH;
+}
+
+static struct bgp_condition_adv *
+bgp_conditional_adv_lookup(struct bgp *bgp, afi_t afi, safi_t safi,
+			   struct bgp_filter *filter)
+{
+	struct bgp_condition_adv *cadv;
+	struct listnode *node;
+
+	if (!bgp->condition_adv_list)
+		return NULL;
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->condition_adv_list, node, cadv)) {
+		if (cadv->afi == afi && cadv->safi == safi
+		    && cadv->condition == filter->advmap.condition
+		    && strmatch(cadv->aname, filter->advmap.aname)
+		    && strmatch(cadv->cname, filter->advmap.cname))
+			return cadv;
+	}
+
+	return NULL;
+}
+
+static void bgp_conditional_adv_free(struct bgp_condition_adv *cadv)
+{
+	XFREE(MTYPE_BGP_CONDITION_ADV, cadv->aname);
+	XFREE(MTYPE_BGP_CONDITION_ADV, cadv->cname);
+	XFREE(MTYPE_BGP_CONDITION_ADV, cadv);
+}
+
+static void bgp_conditional_adv_list_free(struct bgp *bgp)
+{
+	struct bgp_condition_adv *cadv;
+	struct listnode *node, *nnode;
+
+	if (!bgp->condition_adv_list)
+		return;
+
+	for (ALL_LIST_ELEMENTS(bgp->condition_adv_list, node, nnode, cadv))
+		bgp_conditional_adv_free(cadv);
+
+	list_delete(&bgp->condition_adv_list);
+}
+
+/* Bring the index of advertise-map/condition-map pairs in line with the
+ * peers' configuration, keeping the state of the pairs still in use.
+ */
+static void bgp_conditional_adv_refresh(struct bgp *bgp)
+{
+	afi_t afi;
+	safi_t safi;
+	struct peer *peer;
+	struct bgp_filter *filter;
+	struct bgp_condition_adv *cadv;
+	struct listnode *node, *nnode;
+
+	if (!bgp->condition_adv_list)
+		bgp->condition_adv_list = list_new();
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->condition_adv_list, node, cadv))
+		cadv->in_use = false;
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+		if (!CHECK_FLAG(peer->flags, PEER_FLAG_CONFIG_NODE))
+			continue;
+
+		FOREACH_AFI_SAFI (afi, safi) {
+			filter = &peer->filter[afi][safi];
+			if (!filter->advmap.aname || !filter->advmap.cname)
+				continue;
+
+			cadv = bgp_conditional_adv_lookup(bgp, afi, safi,
+							  filter);
+			if (!cadv) {
+				cadv = XCALLOC(MTYPE_BGP_CONDITION_ADV,
+					       sizeof(*cadv));
+				cadv->afi = afi;
+				cadv->safi = safi;
+				cadv->aname = XSTRDUP(MTYPE_BGP_CONDITION_ADV,
+						      filter->advmap.aname);
+				cadv->cname = XSTRDUP(MTYPE_BGP_CONDITION_ADV,
+						      filter->advmap.cname);
+				cadv->condition = filter->advmap.condition;
+				cadv->update_type = ADVERTISE;
+				cadv->cond_changed = true;
+				listnode_add(bgp->condition_adv_list, cadv);
+			}
+
+			/* Route-map or filter contents may have changed */
+			if (peer->advmap_config_change[afi][safi])
+				cadv->cond_changed = true;
+
+			cadv->in_use = true;
+		}
+	}
+
+	for (ALL_LIST_ELEMENTS(bgp->condition_adv_list, node, nnode, cadv)) {
+		if (cadv->in_use)
+			continue;
+
+		list_delete_node(bgp->condition_adv_list, node);
+		bgp_conditional_adv_free(cadv);
+	}
+}
+
+/* Re-evaluate the condition-map of a pair against the BGP table. */
+static void bgp_conditional_adv_evaluate(struct bgp *bgp,
+					 struct bgp_condition_adv *cadv)
+{
+	struct bgp_table *table;
+	struct route_map *cmap;
+	enum update_type update_type;
+	route_map_result_t ret;
+
+	table = bgp->rib[cadv->afi][bgp_conditional_adv_table_safi(cadv->safi)];
+	cmap = route_map_lookup_by_name(cadv->cname);
+	if (!table || !cmap)
+		return;
+
+	cadv->cond_changed = false;
+
+	/* cmap (route-map attached to exist-map or
+	 * non-exist-map) map validation
+	 */
+	ret = bgp_check_rmap_prefixes_in_bgp_table(table, cmap, &cadv->match);
+	cadv->exists = (ret == RMAP_PERMITMATCH);
+
+	/* Derive conditional advertisement status from
+	 * condition and return value of condition-map
+	 * validation.
+	 */
+	if (cadv->condition == CONDITION_EXIST)
+		update_type = cadv->exists ? ADVERTISE : WITHDRAW;
+	else
+		update_type = cadv->exists ? WITHDRAW : ADVERTISE;
+
+	if (BGP_DEBUG(update, UPDATE_OUT) && update_type != cadv->update_type)
+		zlog_debug("%s: %s/%s for %s - condition now %s", __func__,
+			   cadv->aname, cadv->cname,
+			   get_afi_safi_str(cadv->afi, cadv->safi, false),
+			   update_type == ADVERTISE ? "advertise" : "withdraw");
+
+	cadv->update_type = update_type;
 }
 
 static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
@@ -76,6 +272,7 @@ static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
 				       enum update_type update_type)
 {
 	bool addpath_capable;
+	bool reparse;
 	struct bgp_dest *dest;
 	struct bgp_path_info *pi;
 	struct bgp_path_info path;
@@ -95,8 +292,16 @@ static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
 	if (!subgrp)
 		return;
 
-	subgrp->pscount = 0;
-	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+	/*
+	 * While a resumable table walk is in progress pscount is kept in step
+	 * with its cursor (see bgp_adj_out_set_subgroup()), so recounting
+	 * from zero here would drop what the walk has counted so far.
+	 */
+	reparse = !subgrp->announce_dest;
+	if (reparse) {
+		subgrp->pscount = 0;
+		SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+	}
 
 	if (BGP_DEBUG(update, UPDATE_OUT))
 		zlog_debug("%s: %s routes to/from %s for %s", __func__,
@@ -159,11 +364,14 @@ static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
 			bgp_attr_flush(&advmap_attr);
 		}
 	}
-	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+	if (reparse)
+		UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
 }
 
 /* Handler of conditional advertisement timer event.
- * Each route in the condition-map is evaluated.
+ * Only condition-maps whose result may have been affected by a table
+ * change since the last pass are evaluated again, once per distinct
+ * advertise-map/condition-map pair.
  */
 static void bgp_conditional_adv_timer(struct thread *t)
 {
@@ -177,7 +385,7 @@ static void bgp_conditional_adv_timer(struct thread *t)
 	struct bgp_filter *filter = NULL;
 	struct listnode *node, *nnode = NULL;
 	struct update_subgroup *subgrp = NULL;
-	route_map_result_t ret;
+	struct bgp_condition_adv *cadv;
 
 	bgp = THREAD_ARG(t);
 	assert(bgp);
@@ -185,6 +393,13 @@ static void bgp_conditional_adv_timer(struct thread *t)
 	thread_add_timer(bm->master, bgp_conditional_adv_timer, bgp,
 			 bgp->condition_check_period, &bgp->t_condition_check);
 
+	bgp_conditional_adv_refresh(bgp);
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->condition_adv_list, node, cadv)) {
+		if (cadv->cond_changed)
+			bgp_conditional_adv_evaluate(bgp, cadv);
+	}
+
 	/* loop through each peer and advertise or withdraw routes if
 	 * advertise-map is configured and prefix(es) in condition-map
 	 * does exist(exist-map)/not exist(non-exist-map) in BGP table
@@ -205,9 +420,7 @@ static void bgp_conditional_adv_timer(struct thread *t)
 			 * table so in order to display the correct PfxRcd value
 			 * we must look at SAFI_UNICAST
 			 */
-			pfx_rcd_safi = (safi == SAFI_LABELED_UNICAST)
-					       ? SAFI_UNICAST
-					       : safi;
+			pfx_rcd_safi = bgp_conditional_adv_table_safi(safi);
 
 			table = bgp->rib[afi][pfx_rcd_safi];
 			if (!table)
@@ -219,12 +432,24 @@ static void bgp_conditional_adv_timer(struct thread *t)
 			    || !filter->advmap.amap || !filter->advmap.cmap)
 				continue;
 
+			cadv = bgp_conditional_adv_lookup(bgp, afi, safi,
+							  filter);
+			if (!cadv)
+				continue;
+
+			/* Nothing to do unless the condition flipped for this
+			 * peer, its configuration changed, or routes in the
+			 * advertise-map changed while they are withdrawn.
+			 */
 			if (!peer->advmap_config_change[afi][safi]
-			    && !peer->advmap_table_change)
+			    && filter->advmap.update_type == cadv->update_type
+			    && !cadv->adv_changed)
 				continue;
 
 			if (BGP_DEBUG(update, UPDATE_OUT)) {
-				if (peer->advmap_table_change)
+				if (filter->advmap.update_type
+					    != cadv->update_type
+				    || cadv->adv_changed)
 					zlog_debug(
 						"%s: %s - routes changed in BGP table.",
 						__func__, peer->host);
@@ -236,24 +461,7 @@ static void bgp_conditional_adv_timer(struct thread *t)
 								 false));
 			}
 
-			/* cmap (route-map attached to exist-map or
-			 * non-exist-map) map validation
-			 */
-			ret = bgp_check_rmap_prefixes_in_bgp_table(
-				table, filter->advmap.cmap);
-
-			/* Derive conditional advertisement status from
-			 * condition and return value of condition-map
-			 * validation.
-			 */
-			if (filter->advmap.condition == CONDITION_EXIST)
-				filter->advmap.update_type =
-					(ret == RMAP_PERMITMATCH) ? ADVERTISE
-								  : WITHDRAW;
-			else
-				filter->advmap.update_type =
-					(ret == RMAP_PERMITMATCH) ? WITHDRAW
-								  : ADVERTISE;
+			filter->advmap.update_type = cadv->update_type;
 
 			/* Send regular update as per the existing policy.
 			 * There is a change in route-map, match-rule, ACLs,
@@ -284,7 +492,60 @@ static void bgp_conditional_adv_timer(struct thread *t)
 						   filter->advmap.amap,
 						   filter->advmap.update_type);
 		}
-		peer->advmap_table_change = false;
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->condition_adv_list, node, cadv))
+		cadv->adv_changed = false;
+}
+
+/* Called from best path processing whenever the paths of a destination
+ * changed. Flag the advertise-map/condition-map pairs this destination
+ * may matter to, so that the next timer pass only re-evaluates those.
+ */
+void bgp_conditional_adv_dest_update(struct bgp *bgp, afi_t afi, safi_t safi,
+				     struct bgp_dest *dest)
+{
+	struct bgp_condition_adv *cadv;
+	struct listnode *node;
+	struct route_map *rmap;
+
+	if (!bgp->condition_filter_count || !bgp->condition_adv_list)
+		return;
+
+	if (bgp_dest_table(dest) != bgp->rib[afi][safi])
+		return;
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->condition_adv_list, node, cadv)) {
+		if (cadv->afi != afi
+		    || bgp_conditional_adv_table_safi(cadv->safi) != safi)
+			continue;
+
+		/* If some route matched the condition-map, only a change to
+		 * that route can make the condition go away; otherwise only
+		 * a newly matching route can make it appear.
+		 */
+		if (!cadv->cond_changed) {
+			if (cadv->exists) {
+				if (prefix_same(&cadv->match,
+						bgp_dest_get_prefix(dest)))
+					cadv->cond_changed = true;
+			} else {
+				rmap = route_map_lookup_by_name(cadv->cname);
+				if (rmap
+				    && bgp_conditional_adv_dest_match(dest,
+								      rmap))
+					cadv->cond_changed = true;
+			}
+		}
+
+		/* Regular updates may re-advertise a route which is in the
+		 * advertise-map but currently withdrawn.
+		 */
+		if (!cadv->adv_changed && cadv->update_type == WITHDRAW) {
+			rmap = route_map_lookup_by_name(cadv->aname);
+			if (rmap && bgp_conditional_adv_dest_match(dest, rmap))
+				cadv->adv_changed = true;
+		}
 	}
 }
 
@@ -336,4 +597,11 @@ void bgp_conditional_adv_disable(struct peer *peer, afi_t afi, safi_t safi)
 
 	/* Last filter removed. So cancel conditional routes polling thread. */
 	THREAD_OFF(bgp->t_condition_check);
+	bgp_conditional_adv_list_free(bgp);
+}
+
+void bgp_conditional_adv_cleanup(struct bgp *bgp)
+{
+	THREAD_OFF(bgp->t_condition_check);
+	bgp_conditional_adv_list_free(bgp);
 }
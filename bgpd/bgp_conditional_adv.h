@@ -40,6 +40,10 @@ extern void bgp_conditional_adv_enable(struct peer *peer, afi_t afi,
 				       safi_t safi);
 extern void bgp_conditional_adv_disable(struct peer *peer, afi_t afi,
 					safi_t safi);
+extern void bgp_conditional_adv_cleanup(struct bgp *bgp);
+extern void bgp_conditional_adv_dest_update(struct bgp *bgp, afi_t afi,
+					    safi_t safi,
+					    struct bgp_dest *dest);
 #ifdef __cplusplus
 }
 #endif
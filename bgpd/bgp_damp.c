@@ -40,10 +40,67 @@
 /* Global variable to access damping configuration */
 static struct bgp_damp_config damp[AFI_MAX][SAFI_MAX];
 
-/* Utility macro to add and delete BGP dampening information to no
-   used list.  */
-#define BGP_DAMP_LIST_ADD(N, A) BGP_PATH_INFO_ADD(N, A, no_reuse_list)
-#define BGP_DAMP_LIST_DEL(N, A) BGP_PATH_INFO_DEL(N, A, no_reuse_list)
+/* List head the dampening information is currently linked to.  */
+static struct bgp_damp_info **bgp_damp_list_head(struct bgp_damp_info *bdi,
+						 struct bgp_damp_config *bdc)
+{
+	switch (bdi->index) {
+	case BGP_DAMP_INDEX_UNLINKED:
+		return NULL;
+	case BGP_DAMP_INDEX_NO_REUSE:
+		return &bdc->no_reuse_list;
+	case BGP_DAMP_INDEX_REUSE_PENDING:
+		return &bdc->reuse_pending;
+	default:
+		return &bdc->reuse_list[bdi->index];
+	}
+}
+
+/* Link BGP dampening information to the list designated by index.  */
+static void bgp_damp_list_add(struct bgp_damp_info *bdi,
+			      struct bgp_damp_config *bdc, int index)
+{
+	struct bgp_damp_info **head;
+
+	bdi->index = index;
+	head = bgp_damp_list_head(bdi, bdc);
+
+	bdi->prev = NULL;
+	bdi->next = *head;
+	if (*head)
+		(*head)->prev = bdi;
+	*head = bdi;
+
+	if (index == BGP_DAMP_INDEX_NO_REUSE)
+		bdc->stats.penalized++;
+	else
+		bdc->stats.suppressed++;
+}
+
+/* Unlink BGP dampening information from whichever list it is on.  */
+static void bgp_damp_list_delete(struct bgp_damp_info *bdi,
+				 struct bgp_damp_config *bdc)
+{
+	struct bgp_damp_info **head = bgp_damp_list_head(bdi, bdc);
+
+	if (!head)
+		return;
+
+	if (bdi->next)
+		bdi->next->prev = bdi->prev;
+	if (bdi->prev)
+		bdi->prev->next = bdi->next;
+	else
+		*head = bdi->next;
+
+	if (bdi->index == BGP_DAMP_INDEX_NO_REUSE)
+		bdc->stats.penalized--;
+	else
+		bdc->stats.suppressed--;
+
+	bdi->next = bdi->prev = NULL;
+	bdi->index = BGP_DAMP_INDEX_UNLINKED;
+}
 
 /* Calculate reuse list index by penalty value.  */
 static int bgp_reuse_index(int penalty, struct bgp_damp_config *bdc)
@@ -72,27 +129,7 @@ static int bgp_reuse_index(int penalty, struct bgp_damp_config *bdc)
 static void bgp_reuse_list_add(struct bgp_damp_info *bdi,
 			       struct bgp_damp_config *bdc)
 {
-	int index;
-
-	index = bdi->index = bgp_reuse_index(bdi->penalty, bdc);
-
-	bdi->prev = NULL;
-	bdi->next = bdc->reuse_list[index];
-	if (bdc->reuse_list[index])
-		bdc->reuse_list[index]->prev = bdi;
-	bdc->reuse_list[index] = bdi;
-}
-
-/* Delete BGP dampening information from reuse list.  */
-static void bgp_reuse_list_delete(struct bgp_damp_info *bdi,
-				  struct bgp_damp_config *bdc)
-{
-	if (bdi->next)
-		bdi->next->prev = bdi->prev;
-	if (bdi->prev)
-		bdi->prev->next = bdi->next;
-	else
-		bdc->reuse_list[bdi->index] = bdi->next;
+	bgp_damp_list_add(bdi, bdc, bgp_reuse_index(bdi->penalty, bdc));
 }
 
 /* Return decayed penalty value.  */
@@ -100,7 +137,7 @@ int bgp_damp_decay(time_t tdiff, int penalty, struct bgp_damp_config *bdc)
 {
 	unsigned int i;
 
-	i = (int)((double)tdiff / DELTA_T);
+	i = tdiff / DELTA_T;
 
 	if (i == 0)
 		return penalty;
@@ -111,13 +148,76 @@ int bgp_damp_decay(time_t tdiff, int penalty, struct bgp_damp_config *bdc)
 	return (int)(penalty * bdc->decay_array[i]);
 }
 
+/* Evaluate a suppressed route whose reuse list came up.  */
+static void bgp_reuse_evaluate(struct bgp_damp_info *bdi,
+			       struct bgp_damp_config *bdc, time_t t_now)
+{
+	struct bgp *bgp = bdi->path->peer->bgp;
+	time_t t_diff;
+
+	/* Set t-diff = t-now - t-updated.  */
+	t_diff = t_now - bdi->t_updated;
+
+	/* Set figure-of-merit = figure-of-merit * decay-array-ok
+	 * [t-diff] */
+	bdi->penalty = bgp_damp_decay(t_diff, bdi->penalty, bdc);
+
+	/* Set t-updated = t-now.  */
+	bdi->t_updated = t_now;
+
+	/* if (figure-of-merit < reuse).  */
+	if (bdi->penalty < bdc->reuse_limit) {
+		/* Reuse the route.  */
+		bgp_path_info_unset_flag(bdi->dest, bdi->path,
+					 BGP_PATH_DAMPED);
+		bdi->suppress_time = 0;
+		bdc->stats.reuses++;
+
+		if (bdi->lastrecord == BGP_RECORD_UPDATE) {
+			bgp_path_info_unset_flag(bdi->dest, bdi->path,
+						 BGP_PATH_HISTORY);
+			bgp_aggregate_increment(bgp,
+						bgp_dest_get_prefix(bdi->dest),
+						bdi->path, bdi->afi, bdi->safi);
+			bgp_process(bgp, bdi->dest, bdi->afi, bdi->safi);
+		}
+
+		if (bdi->penalty <= bdc->reuse_limit / 2.0)
+			bgp_damp_info_free(bdi, 1, bdi->afi, bdi->safi);
+		else
+			bgp_damp_list_add(bdi, bdc, BGP_DAMP_INDEX_NO_REUSE);
+	} else
+		/* Re-insert into another list (See RFC2439 Section
+		 * 4.8.6).  */
+		bgp_reuse_list_add(bdi, bdc);
+}
+
+/* Work through the routes taken off the reuse lists, a batch at a time so
+ * that a large reuse list does not hold up everything else.
+ */
+static void bgp_reuse_batch(struct thread *t)
+{
+	struct bgp_damp_config *bdc = THREAD_ARG(t);
+	struct bgp_damp_info *bdi;
+	unsigned int count = 0;
+	time_t t_now = bgp_clock();
+
+	while ((bdi = bdc->reuse_pending) && count++ < BGP_DAMP_REUSE_BATCH) {
+		bgp_damp_list_delete(bdi, bdc);
+		bgp_reuse_evaluate(bdi, bdc, t_now);
+	}
+
+	if (bdc->reuse_pending)
+		thread_add_event(bm->master, bgp_reuse_batch, bdc, 0,
+				 &bdc->t_reuse_batch);
+}
+
 /* Handler of reuse timer event.  Each route in the current reuse-list
    is evaluated.  RFC2439 Section 4.8.7.  */
 static void bgp_reuse_timer(struct thread *t)
 {
 	struct bgp_damp_info *bdi;
-	struct bgp_damp_info *next;
-	time_t t_now, t_diff;
+	struct bgp_damp_info *tail = NULL;
 
 	struct bgp_damp_config *bdc = THREAD_ARG(t);
 
@@ -125,8 +225,6 @@ static void bgp_reuse_timer(struct thread *t)
 	thread_add_timer(bm->master, bgp_reuse_timer, bdc, DELTA_REUSE,
 			 &bdc->t_reuse);
 
-	t_now = bgp_clock();
-
 	/* 1.  save a pointer to the current zeroth queue head and zero the
 	   list head entry.  */
 	bdi = bdc->reuse_list[bdc->reuse_offset];
@@ -136,48 +234,24 @@ static void bgp_reuse_timer(struct thread *t)
 	   rotating the circular queue of list-heads.  */
 	bdc->reuse_offset = (bdc->reuse_offset + 1) % bdc->reuse_list_size;
 
-	/* 3. if ( the saved list head pointer is non-empty ) */
-	for (; bdi; bdi = next) {
-		struct bgp *bgp = bdi->path->peer->bgp;
-
-		next = bdi->next;
-
-		/* Set t-diff = t-now - t-updated.  */
-		t_diff = t_now - bdi->t_updated;
+	/* 3. if ( the saved list head pointer is non-empty ), hand it over
+	   to bgp_reuse_batch().  */
+	if (!bdi)
+		return;
 
-		/* Set figure-of-merit = figure-of-merit * decay-array-ok
-		 * [t-diff] */
-		bdi->penalty = bgp_damp_decay(t_diff, bdi->penalty, bdc);
+	for (tail = bdi; tail; tail = tail->next) {
+		tail->index = BGP_DAMP_INDEX_REUSE_PENDING;
+		if (!tail->next)
+			break;
+	}
 
-		/* Set t-updated = t-now.  */
-		bdi->t_updated = t_now;
+	tail->next = bdc->reuse_pending;
+	if (bdc->reuse_pending)
+		bdc->reuse_pending->prev = tail;
+	bdc->reuse_pending = bdi;
 
-		/* if (figure-of-merit < reuse).  */
-		if (bdi->penalty < bdc->reuse_limit) {
-			/* Reuse the route.  */
-			bgp_path_info_unset_flag(bdi->dest, bdi->path,
-						 BGP_PATH_DAMPED);
-			bdi->suppress_time = 0;
-
-			if (bdi->lastrecord == BGP_RECORD_UPDATE) {
-				bgp_path_info_unset_flag(bdi->dest, bdi->path,
-							 BGP_PATH_HISTORY);
-				bgp_aggregate_increment(
-					bgp, bgp_dest_get_prefix(bdi->dest),
-					bdi->path, bdi->afi, bdi->safi);
-				bgp_process(bgp, bdi->dest, bdi->afi,
-					    bdi->safi);
-			}
-
-			if (bdi->penalty <= bdc->reuse_limit / 2.0)
-				bgp_damp_info_free(bdi, 1, bdc->afi, bdc->safi);
-			else
-				BGP_DAMP_LIST_ADD(bdc, bdi);
-		} else
-			/* Re-insert into another list (See RFC2439 Section
-			 * 4.8.6).  */
-			bgp_reuse_list_add(bdi, bdc);
-	}
+	thread_add_event(bm->master, bgp_reuse_batch, bdc, 0,
+			 &bdc->t_reuse_batch);
 }
 
 /* A route becomes unreachable (RFC2439 Section 4.8.2).  */
@@ -190,6 +264,7 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 	struct bgp_damp_config *bdc = &damp[afi][safi];
 
 	t_now = bgp_clock();
+	bdc->stats.flaps++;
 
 	/* Processing Unreachable Messages.  */
 	if (path->extra)
@@ -212,11 +287,10 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 		bdi->flap = 1;
 		bdi->start_time = t_now;
 		bdi->suppress_time = 0;
-		bdi->index = -1;
 		bdi->afi = afi;
 		bdi->safi = safi;
 		(bgp_path_info_extra_get(path))->damp_info = bdi;
-		BGP_DAMP_LIST_ADD(bdc, bdi);
+		bgp_damp_list_add(bdi, bdc, BGP_DAMP_INDEX_NO_REUSE);
 	} else {
 		last_penalty = bdi->penalty;
 
@@ -244,7 +318,7 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 	if (CHECK_FLAG(bdi->path->flags, BGP_PATH_DAMPED)) {
 		/* If decay rate isn't equal to 0, reinsert brn. */
 		if (bdi->penalty != last_penalty && bdi->index >= 0) {
-			bgp_reuse_list_delete(bdi, bdc);
+			bgp_damp_list_delete(bdi, bdc);
 			bgp_reuse_list_add(bdi, bdc);
 		}
 		return BGP_DAMP_SUPPRESSED;
@@ -255,7 +329,8 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 	if (bdi->penalty >= bdc->suppress_value) {
 		bgp_path_info_set_flag(dest, path, BGP_PATH_DAMPED);
 		bdi->suppress_time = t_now;
-		BGP_DAMP_LIST_DEL(bdc, bdi);
+		bdc->stats.suppressions++;
+		bgp_damp_list_delete(bdi, bdc);
 		bgp_reuse_list_add(bdi, bdc);
 	}
 
@@ -286,9 +361,10 @@ int bgp_damp_update(struct bgp_path_info *path, struct bgp_dest *dest,
 	else if (CHECK_FLAG(bdi->path->flags, BGP_PATH_DAMPED)
 		 && (bdi->penalty < bdc->reuse_limit)) {
 		bgp_path_info_unset_flag(dest, path, BGP_PATH_DAMPED);
-		bgp_reuse_list_delete(bdi, bdc);
-		BGP_DAMP_LIST_ADD(bdc, bdi);
+		bgp_damp_list_delete(bdi, bdc);
+		bgp_damp_list_add(bdi, bdc, BGP_DAMP_INDEX_NO_REUSE);
 		bdi->suppress_time = 0;
+		bdc->stats.reuses++;
 		status = BGP_DAMP_USED;
 	} else
 		status = BGP_DAMP_SUPPRESSED;
@@ -313,10 +389,7 @@ void bgp_damp_info_free(struct bgp_damp_info *bdi, int withdraw, afi_t afi,
 	path = bdi->path;
 	path->extra->damp_info = NULL;
 
-	if (CHECK_FLAG(path->flags, BGP_PATH_DAMPED))
-		bgp_reuse_list_delete(bdi, bdc);
-	else
-		BGP_DAMP_LIST_DEL(bdc, bdi);
+	bgp_damp_list_delete(bdi, bdc);
 
 	bgp_path_info_unset_flag(bdi->dest, path,
 				 BGP_PATH_HISTORY | BGP_PATH_DAMPED);
@@ -406,6 +479,8 @@ int bgp_damp_enable(struct bgp *bgp, afi_t afi, safi_t safi, time_t half,
 	}
 
 	SET_FLAG(bgp->af_flags[afi][safi], BGP_CONFIG_DAMPENING);
+	bdc->afi = afi;
+	bdc->safi = safi;
 	bgp_damp_parameter_set(half, reuse, suppress, max, bdc);
 
 	/* Register reuse timer.  */
@@ -428,33 +503,29 @@ static void bgp_damp_config_clean(struct bgp_damp_config *bdc)
 	/* Free reuse list array. */
 	XFREE(MTYPE_BGP_DAMP_ARRAY, bdc->reuse_list);
 	bdc->reuse_list_size = 0;
+
+	memset(&bdc->stats, 0, sizeof(bdc->stats));
 }
 
 /* Clean all the bgp_damp_info stored in reuse_list. */
 void bgp_damp_info_clean(afi_t afi, safi_t safi)
 {
 	unsigned int i;
-	struct bgp_damp_info *bdi, *next;
+	struct bgp_damp_info *bdi;
 	struct bgp_damp_config *bdc = &damp[afi][safi];
 
 	bdc->reuse_offset = 0;
 
 	for (i = 0; i < bdc->reuse_list_size; i++) {
-		if (!bdc->reuse_list[i])
-			continue;
-
-		for (bdi = bdc->reuse_list[i]; bdi; bdi = next) {
-			next = bdi->next;
+		while ((bdi = bdc->reuse_list[i]))
 			bgp_damp_info_free(bdi, 1, afi, safi);
-		}
-		bdc->reuse_list[i] = NULL;
 	}
 
-	for (bdi = bdc->no_reuse_list; bdi; bdi = next) {
-		next = bdi->next;
+	while ((bdi = bdc->reuse_pending))
+		bgp_damp_info_free(bdi, 1, afi, safi);
+
+	while ((bdi = bdc->no_reuse_list))
 		bgp_damp_info_free(bdi, 1, afi, safi);
-	}
-	bdc->no_reuse_list = NULL;
 }
 
 int bgp_damp_disable(struct bgp *bgp, afi_t afi, safi_t safi)
@@ -466,6 +537,7 @@ int bgp_damp_disable(struct bgp *bgp, afi_t afi, safi_t safi)
 
 	/* Cancel reuse event. */
 	thread_cancel(&(bdc->t_reuse));
+	thread_cancel(&(bdc->t_reuse_batch));
 
 	/* Clean BGP dampening information.  */
 	bgp_damp_info_clean(afi, safi);
@@ -669,6 +741,14 @@ static int bgp_print_dampening_parameters(struct bgp *bgp, struct vty *vty,
 					    bdc->max_suppress_time);
 			json_object_int_add(json, "maxSuppressPenalty",
 					    bdc->ceiling);
+			json_object_int_add(json, "suppressedPaths",
+					    bdc->stats.suppressed);
+			json_object_int_add(json, "penalizedPaths",
+					    bdc->stats.penalized);
+			json_object_int_add(json, "flaps", bdc->stats.flaps);
+			json_object_int_add(json, "suppressions",
+					    bdc->stats.suppressions);
+			json_object_int_add(json, "reuses", bdc->stats.reuses);
 
 			vty_json(vty, json);
 		} else {
@@ -681,6 +761,15 @@ static int bgp_print_dampening_parameters(struct bgp *bgp, struct vty *vty,
 				(long long)bdc->max_suppress_time / 60);
 			vty_out(vty, "Max suppress penalty: %u\n",
 				bdc->ceiling);
+			vty_out(vty, "Suppressed paths: %u\n",
+				bdc->stats.suppressed);
+			vty_out(vty, "Penalized paths: %u\n",
+				bdc->stats.penalized);
+			vty_out(vty,
+				"Flaps: %" PRIu64 ", suppressions: %" PRIu64
+				", reuses: %" PRIu64 "\n",
+				bdc->stats.flaps, bdc->stats.suppressions,
+				bdc->stats.reuses);
 			vty_out(vty, "\n");
 		}
 	} else if (!use_json)
@@ -26,7 +26,7 @@
 /* Structure maintained on a per-route basis. */
 struct bgp_damp_info {
 	/* Doubly linked list.  This information must be linked to
-	   reuse_list or no_reuse_list.  */
+	   reuse_list, reuse_pending or no_reuse_list.  */
 	struct bgp_damp_info *next;
 	struct bgp_damp_info *prev;
 
@@ -51,8 +51,11 @@ struct bgp_damp_info {
 	/* Back reference to bgp_node. */
 	struct bgp_dest *dest;
 
-	/* Current index in the reuse_list. */
+	/* Current index in the reuse_list, or one of the below. */
 	int index;
+#define BGP_DAMP_INDEX_NO_REUSE		-1
+#define BGP_DAMP_INDEX_REUSE_PENDING	-2
+#define BGP_DAMP_INDEX_UNLINKED		-3
 
 	/* Last time message type. */
 	uint8_t lastrecord;
@@ -106,8 +109,22 @@ struct bgp_damp_config {
 	/* All dampening information which is not on reuse list.  */
 	struct bgp_damp_info *no_reuse_list;
 
+	/* Taken off the reuse list, waiting for bgp_reuse_batch(). */
+	struct bgp_damp_info *reuse_pending;
+
 	/* Reuse timer thread per-set base. */
 	struct thread *t_reuse;
+	struct thread *t_reuse_batch;
+
+	struct {
+		/* Paths currently on reuse lists / no_reuse_list */
+		unsigned int suppressed;
+		unsigned int penalized;
+
+		uint64_t flaps;
+		uint64_t suppressions;
+		uint64_t reuses;
+	} stats;
 
 	afi_t afi;
 	safi_t safi;
@@ -132,6 +149,9 @@ struct bgp_damp_config {
 #define REUSE_LIST_SIZE          256
 #define REUSE_ARRAY_SIZE        1024
 
+/* Routes evaluated per bgp_reuse_batch() run */
+#define BGP_DAMP_REUSE_BATCH    1000
+
 extern int bgp_damp_enable(struct bgp *, afi_t, safi_t, time_t, unsigned int,
 			   unsigned int, time_t);
 extern int bgp_damp_disable(struct bgp *, afi_t, safi_t);
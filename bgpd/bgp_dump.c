@@ -30,6 +30,9 @@
 #include "queue.h"
 #include "memory.h"
 #include "filter.h"
+#include "frr_pthread.h"
+#include "hash.h"
+#include "jhash.h"
 
 #include "bgpd/bgp_table.h"
 #include "bgpd/bgpd.h"
@@ -38,6 +41,7 @@
 #include "bgpd/bgp_dump.h"
 #include "bgpd/bgp_errors.h"
 #include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_memory.h"
 
 enum bgp_dump_type {
 	BGP_DUMP_ALL,
@@ -85,10 +89,58 @@ struct bgp_dump {
 	char *interval_str;
 
 	struct thread *t_interval;
+
+	/* Routes dump currently walking the RIB, if any */
+	struct bgp_dump_job *job;
+};
+
+/*
+ * A TABLE_DUMP_V2 routes dump in progress.
+ *
+ * The RIB is walked on the main thread in slices of BGP_DUMP_WALK_QUANTUM
+ * records, so that peers keep being serviced while a large table is dumped.
+ * Encoded records are batched into BGP_DUMP_CHUNK_SIZE streams and handed
+ * over to bgp_pth_dump, which owns the file and does the actual writes.
+ * The walk backs off while more than BGP_DUMP_QUEUE_MAX bytes are waiting
+ * to be written.
+ */
+#define BGP_DUMP_WALK_QUANTUM 10000
+#define BGP_DUMP_CHUNK_SIZE (1024 * 1024)
+#define BGP_DUMP_QUEUE_MAX (16 * BGP_DUMP_CHUNK_SIZE)
+#define BGP_DUMP_BACKOFF_MSEC 10
+
+struct bgp_dump_job {
+	/* Table walk, main thread only */
+	struct bgp *bgp;
+	afi_t afi;
+	struct bgp_dest *dest;
+	unsigned int seq;
+	struct stream *chunk;
+	struct thread *t_walk;
+	struct thread *t_done;
+
+	/*
+	 * Peers of the PEER_INDEX_TABLE written at the start, with their
+	 * index. Peers come and go while the walk runs, so RIB entries are
+	 * only dumped for the (locked) peers in here.
+	 */
+	struct hash *peers;
+
+	/* Protects chunks, queued and finished */
+	pthread_mutex_t mtx;
+	struct stream_fifo *chunks;
+	size_t queued;
+	bool finished;
+
+	/* Writer pthread only, once the job is created */
+	FILE *fp;
+	struct thread *t_write;
 };
 
 static int bgp_dump_unset(struct bgp_dump *bgp_dump);
 static void bgp_dump_interval_func(struct thread *);
+static void bgp_dump_job_done(struct thread *t);
+static void bgp_dump_routes_end(struct bgp_dump_job *job);
 
 /* BGP packet dump output buffer. */
 struct stream *bgp_dump_obuf;
@@ -102,6 +154,9 @@ struct bgp_dump bgp_dump_updates;
 /* BGP dump structure for 'dump bgp routes' */
 struct bgp_dump bgp_dump_routes;
 
+/* Routes dumps not yet fully written out */
+static struct list *bgp_dump_jobs;
+
 static FILE *bgp_dump_open_file(struct bgp_dump *bgp_dump)
 {
 	int ret;
@@ -215,7 +270,181 @@ static void bgp_dump_set_size(struct stream *s, int type)
 	stream_putl_at(s, 8, stream_get_endp(s) - BGP_DUMP_HEADER_SIZE);
 }
 
-static void bgp_dump_routes_index_table(struct bgp *bgp)
+/* Writer pthread: write out whatever chunks are queued. */
+static void bgp_dump_job_write(struct thread *t)
+{
+	struct bgp_dump_job *job = THREAD_ARG(t);
+	struct stream *s;
+	bool finished;
+
+	if (!job->fp)
+		return;
+
+	for (;;) {
+		frr_with_mutex(&job->mtx) {
+			s = stream_fifo_pop(job->chunks);
+			if (s)
+				job->queued -= stream_get_endp(s);
+			finished = job->finished;
+		}
+		if (!s)
+			break;
+
+		if (fwrite(STREAM_DATA(s), stream_get_endp(s), 1, job->fp)
+		    != 1)
+			flog_warn(EC_BGP_DUMP, "%s: write error: %s", __func__,
+				  safe_strerror(errno));
+		stream_free(s);
+	}
+
+	if (!finished)
+		return;
+
+	fclose(job->fp);
+	job->fp = NULL;
+
+	thread_add_event(bm->master, bgp_dump_job_done, job, 0, &job->t_done);
+}
+
+struct bgp_dump_peer {
+	struct peer *peer;
+	uint16_t index;
+};
+
+static unsigned int bgp_dump_peer_hash_key(const void *arg)
+{
+	const struct bgp_dump_peer *dp = arg;
+
+	return jhash(&dp->peer, sizeof(dp->peer), 0);
+}
+
+static bool bgp_dump_peer_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct bgp_dump_peer *dp1 = arg1, *dp2 = arg2;
+
+	return dp1->peer == dp2->peer;
+}
+
+static void bgp_dump_peer_add(struct bgp_dump_job *job, struct peer *peer,
+			      uint16_t index)
+{
+	struct bgp_dump_peer *dp;
+
+	dp = XCALLOC(MTYPE_BGP_DUMP_PEER, sizeof(*dp));
+	dp->peer = peer_lock(peer);
+	dp->index = index;
+	(void)hash_get(job->peers, dp, hash_alloc_intern);
+}
+
+static struct bgp_dump_peer *bgp_dump_peer_lookup(struct bgp_dump_job *job,
+						  struct peer *peer)
+{
+	struct bgp_dump_peer key = {.peer = peer};
+
+	return hash_lookup(job->peers, &key);
+}
+
+static void bgp_dump_peer_free(void *arg)
+{
+	struct bgp_dump_peer *dp = arg;
+
+	peer_unlock(dp->peer);
+	XFREE(MTYPE_BGP_DUMP_PEER, dp);
+}
+
+static void bgp_dump_job_peers_free(struct bgp_dump_job *job)
+{
+	if (!job->peers)
+		return;
+
+	hash_clean(job->peers, bgp_dump_peer_free);
+	hash_free(job->peers);
+	job->peers = NULL;
+}
+
+/* Skip paths of peers that are not in the job's PEER_INDEX_TABLE. */
+static struct bgp_path_info *bgp_dump_path_next(struct bgp_dump_job *job,
+						struct bgp_path_info *path)
+{
+	while (path && !bgp_dump_peer_lookup(job, path->peer))
+		path = path->next;
+
+	return path;
+}
+
+static void bgp_dump_job_free(struct bgp_dump_job *job)
+{
+	struct stream *s;
+
+	/* Make sure the writer is done with it */
+	thread_cancel_async(bgp_pth_dump->master, NULL, job);
+	THREAD_OFF(job->t_done);
+
+	/* Only left over on shutdown */
+	while ((s = stream_fifo_pop(job->chunks))) {
+		if (job->fp)
+			fwrite(STREAM_DATA(s), stream_get_endp(s), 1, job->fp);
+		stream_free(s);
+	}
+	if (job->fp)
+		fclose(job->fp);
+
+	bgp_dump_job_peers_free(job);
+	listnode_delete(bgp_dump_jobs, job);
+	stream_fifo_free(job->chunks);
+	pthread_mutex_destroy(&job->mtx);
+	XFREE(MTYPE_BGP_DUMP_JOB, job);
+}
+
+/* Main thread: the writer closed the file. */
+static void bgp_dump_job_done(struct thread *t)
+{
+	bgp_dump_job_free(THREAD_ARG(t));
+}
+
+/* Hand the current chunk over to the writer. */
+static void bgp_dump_job_flush(struct bgp_dump_job *job)
+{
+	struct stream *s = job->chunk;
+
+	if (!s)
+		return;
+
+	job->chunk = NULL;
+	frr_with_mutex(&job->mtx) {
+		stream_fifo_push(job->chunks, s);
+		job->queued += stream_get_endp(s);
+	}
+
+	thread_add_event(bgp_pth_dump->master, bgp_dump_job_write, job, 0,
+			 &job->t_write);
+}
+
+static void bgp_dump_job_put(struct bgp_dump_job *job, struct stream *obuf)
+{
+	if (job->chunk
+	    && STREAM_WRITEABLE(job->chunk) < stream_get_endp(obuf))
+		bgp_dump_job_flush(job);
+
+	if (!job->chunk)
+		job->chunk = stream_new(BGP_DUMP_CHUNK_SIZE);
+
+	stream_put(job->chunk, STREAM_DATA(obuf), stream_get_endp(obuf));
+}
+
+static size_t bgp_dump_job_queued(struct bgp_dump_job *job)
+{
+	size_t queued;
+
+	frr_with_mutex(&job->mtx) {
+		queued = job->queued;
+	}
+
+	return queued;
+}
+
+static void bgp_dump_routes_index_table(struct bgp_dump_job *job,
+					struct bgp *bgp)
 {
 	struct peer *peer;
 	struct listnode *node;
@@ -254,6 +483,7 @@ static void bgp_dump_routes_index_table(struct bgp *bgp)
 	stream_putl(obuf, 0);
 	/* Peer ASN (0) */
 	stream_putl(obuf, 0);
+	bgp_dump_peer_add(job, bgp->peer_self, 0);
 
 	/* Walk down all peers */
 	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
@@ -288,19 +518,19 @@ static void bgp_dump_routes_index_table(struct bgp *bgp)
 		stream_putl(obuf, peer->as);
 
 		/* Store the peer number for this peer */
-		peer->table_dump_index = peerno;
+		bgp_dump_peer_add(job, peer, peerno);
 		peerno++;
 	}
 
 	bgp_dump_set_size(obuf, MSG_TABLE_DUMP_V2);
 
-	fwrite(STREAM_DATA(obuf), stream_get_endp(obuf), 1, bgp_dump_routes.fp);
-	fflush(bgp_dump_routes.fp);
+	bgp_dump_job_put(job, obuf);
 }
 
 static struct bgp_path_info *
-bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
-			   struct bgp_path_info *path, unsigned int seq)
+bgp_dump_route_node_record(struct bgp_dump_job *job, int afi,
+			   struct bgp_dest *dest, struct bgp_path_info *path,
+			   unsigned int seq)
 {
 	struct stream *obuf;
 	size_t sizep;
@@ -360,11 +590,11 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 	stream_putw(obuf, 0);
 
 	endp = stream_get_endp(obuf);
-	for (; path; path = path->next) {
+	for (; path; path = bgp_dump_path_next(job, path->next)) {
 		size_t cur_endp;
 
 		/* Peer index */
-		stream_putw(obuf, path->peer->table_dump_index);
+		stream_putw(obuf, bgp_dump_peer_lookup(job, path->peer)->index);
 
 		/* Originated */
 		stream_putl(obuf, time(NULL) - (bgp_clock() - path->uptime));
@@ -394,49 +624,123 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 	stream_putw_at(obuf, sizep, entry_count);
 
 	bgp_dump_set_size(obuf, MSG_TABLE_DUMP_V2);
-	fwrite(STREAM_DATA(obuf), stream_get_endp(obuf), 1, bgp_dump_routes.fp);
+	bgp_dump_job_put(job, obuf);
 
 	return path;
 }
 
-
-/* Runs under child process. */
-static unsigned int bgp_dump_routes_func(int afi, int first_run,
-					 unsigned int seq)
+static void bgp_dump_routes_walk(struct thread *t)
 {
+	struct bgp_dump_job *job = THREAD_ARG(t);
 	struct bgp_path_info *path;
-	struct bgp_dest *dest;
-	struct bgp *bgp;
-	struct bgp_table *table;
+	unsigned int records = 0;
 
-	bgp = bgp_get_default();
-	if (!bgp)
-		return seq;
+	if (CHECK_FLAG(job->bgp->flags, BGP_FLAG_DELETE_IN_PROGRESS)) {
+		bgp_dump_routes_end(job);
+		return;
+	}
 
-	if (bgp_dump_routes.fp == NULL)
-		return seq;
+	/* Let the writer catch up */
+	if (bgp_dump_job_queued(job) > BGP_DUMP_QUEUE_MAX) {
+		thread_add_timer_msec(bm->master, bgp_dump_routes_walk, job,
+				      BGP_DUMP_BACKOFF_MSEC, &job->t_walk);
+		return;
+	}
 
-	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6 peers,
-	   so this should only be done on the first call to
-	   bgp_dump_routes_func.
-	   ( this function will be called once for ipv4 and once for ipv6 ) */
-	if (first_run)
-		bgp_dump_routes_index_table(bgp);
+	while (records < BGP_DUMP_WALK_QUANTUM) {
+		if (!job->dest) {
+			if (job->afi == AFI_IP6)
+				break;
 
-	/* Walk down each BGP route. */
-	table = bgp->rib[afi][SAFI_UNICAST];
+			job->afi = AFI_IP6;
+			job->dest = bgp_table_top(
+				job->bgp->rib[AFI_IP6][SAFI_UNICAST]);
+			continue;
+		}
 
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		path = bgp_dest_get_bgp_path_info(dest);
+		path = bgp_dump_path_next(job,
+					  bgp_dest_get_bgp_path_info(job->dest));
 		while (path) {
-			path = bgp_dump_route_node_record(afi, dest, path, seq);
-			seq++;
+			path = bgp_dump_route_node_record(job, job->afi,
+							  job->dest, path,
+							  job->seq);
+			job->seq++;
+			records++;
 		}
+
+		job->dest = bgp_route_next(job->dest);
 	}
 
-	fflush(bgp_dump_routes.fp);
+	if (job->dest || job->afi != AFI_IP6) {
+		thread_add_event(bm->master, bgp_dump_routes_walk, job, 0,
+				 &job->t_walk);
+		return;
+	}
 
-	return seq;
+	bgp_dump_routes_end(job);
+}
+
+static void bgp_dump_routes_start(struct bgp_dump *bgp_dump)
+{
+	struct bgp_dump_job *job;
+	struct bgp *bgp;
+
+	bgp = bgp_get_default();
+	if (!bgp) {
+		/* For a RIB dump there's no point in leaving the file open
+		 * until the next scheduled dump starts.
+		 */
+		fclose(bgp_dump->fp);
+		bgp_dump->fp = NULL;
+		return;
+	}
+
+	job = XCALLOC(MTYPE_BGP_DUMP_JOB, sizeof(*job));
+	pthread_mutex_init(&job->mtx, NULL);
+	job->chunks = stream_fifo_new();
+
+	/* The writer owns the file from now on */
+	job->fp = bgp_dump->fp;
+	bgp_dump->fp = NULL;
+
+	job->bgp = bgp_lock(bgp);
+	job->peers = hash_create(bgp_dump_peer_hash_key, bgp_dump_peer_hash_cmp,
+				 "BGP Dump Peers");
+	job->afi = AFI_IP;
+	job->dest = bgp_table_top(bgp->rib[AFI_IP][SAFI_UNICAST]);
+
+	listnode_add(bgp_dump_jobs, job);
+	bgp_dump->job = job;
+
+	bgp_dump_routes_index_table(job, bgp);
+
+	thread_add_event(bm->master, bgp_dump_routes_walk, job, 0,
+			 &job->t_walk);
+}
+
+/* Stop walking, once complete or aborted, and let the writer finish up. */
+static void bgp_dump_routes_end(struct bgp_dump_job *job)
+{
+	THREAD_OFF(job->t_walk);
+
+	if (job->dest) {
+		bgp_dest_unlock_node(job->dest);
+		job->dest = NULL;
+	}
+	bgp_unlock(job->bgp);
+	job->bgp = NULL;
+	bgp_dump_job_peers_free(job);
+
+	bgp_dump_job_flush(job);
+
+	frr_with_mutex(&job->mtx) {
+		job->finished = true;
+	}
+	thread_add_event(bgp_pth_dump->master, bgp_dump_job_write, job, 0,
+			 &job->t_write);
+
+	if (bgp_dump_routes.job == job)
+		bgp_dump_routes.job = NULL;
 }
 
 static void bgp_dump_interval_func(struct thread *t)
@@ -444,19 +748,16 @@ static void bgp_dump_interval_func(struct thread *t)
 	struct bgp_dump *bgp_dump;
 	bgp_dump = THREAD_ARG(t);
 
+	if (bgp_dump->job)
+		flog_warn(EC_BGP_DUMP,
+			  "%s: previous routes dump still in progress, skipping",
+			  __func__);
 	/* Reschedule dump even if file couldn't be opened this time... */
-	if (bgp_dump_open_file(bgp_dump) != NULL) {
+	else if (bgp_dump_open_file(bgp_dump) != NULL) {
 		/* In case of bgp_dump_routes, we need special route dump
 		 * function. */
-		if (bgp_dump->type == BGP_DUMP_ROUTES) {
-			unsigned int seq = bgp_dump_routes_func(AFI_IP, 1, 0);
-			bgp_dump_routes_func(AFI_IP6, 0, seq);
-			/* Close the file now. For a RIB dump there's no point
-			 * in leaving
-			 * it open until the next scheduled dump starts. */
-			fclose(bgp_dump->fp);
-			bgp_dump->fp = NULL;
-		}
+		if (bgp_dump->type == BGP_DUMP_ROUTES)
+			bgp_dump_routes_start(bgp_dump);
 	}
 
 	/* if interval is set reschedule */
@@ -692,6 +993,10 @@ static int bgp_dump_set(struct vty *vty, struct bgp_dump *bgp_dump,
 
 static int bgp_dump_unset(struct bgp_dump *bgp_dump)
 {
+	/* Stop walking the RIB, what was dumped so far is still written. */
+	if (bgp_dump->job)
+		bgp_dump_routes_end(bgp_dump->job);
+
 	/* Removing file name. */
 	XFREE(MTYPE_BGP_DUMP_STR, bgp_dump->filename);
 
@@ -859,6 +1164,8 @@ void bgp_dump_init(void)
 		stream_new((BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE * 2)
 			   + BGP_DUMP_MSG_HEADER + BGP_DUMP_HEADER_SIZE);
 
+	bgp_dump_jobs = list_new();
+
 	install_node(&bgp_dump_node);
 
 	install_element(CONFIG_NODE, &dump_bgp_all_cmd);
@@ -870,10 +1177,16 @@ void bgp_dump_init(void)
 
 void bgp_dump_finish(void)
 {
+	struct bgp_dump_job *job;
+
 	bgp_dump_unset(&bgp_dump_all);
 	bgp_dump_unset(&bgp_dump_updates);
 	bgp_dump_unset(&bgp_dump_routes);
 
+	while ((job = listnode_head(bgp_dump_jobs)))
+		bgp_dump_job_free(job);
+	list_delete(&bgp_dump_jobs);
+
 	stream_free(bgp_dump_obuf);
 	bgp_dump_obuf = NULL;
 	hook_unregister(bgp_packet_dump, bgp_dump_packet);
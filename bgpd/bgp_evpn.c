@@ -585,6 +585,108 @@ struct bgp_dest *bgp_global_evpn_node_lookup(struct bgp_table *table, afi_t afi,
 	return bgp_afi_node_lookup(table, afi, safi, (struct prefix *)evp, prd);
 }
 
+/*
+ * Remote MACIP adds and deletes are coalesced into one ZAPI message per run
+ * of consecutive messages of the same type; zebra's handlers loop over all
+ * entries in a message.  This cuts down on per-message overhead on both
+ * sides when importing or withdrawing a large number of type-2 routes, e.g.
+ * after a remote VTEP restarts.
+ *
+ * The batch goes out when the type changes, when the message is full, when
+ * any other EVPN message is sent to zebra (to keep ordering), or at the end
+ * of the current event at the latest.
+ */
+struct bgp_evpn_macip_batch {
+	struct stream *s;
+	uint16_t cmd;
+	vrf_id_t vrf_id;
+	unsigned int count;
+	struct thread *t_flush;
+};
+
+static struct bgp_evpn_macip_batch evpn_macip_batch;
+
+/* VNI, MAC, IP length & IP, VTEP, flags, seq, ESI */
+#define EVPN_MACIP_ENTRY_MAX                                                   \
+	(4 + ETH_ALEN + 2 + IPV6_MAX_BYTELEN + IPV4_MAX_BYTELEN + 1 + 4       \
+	 + sizeof(esi_t))
+
+int bgp_evpn_zebra_macip_flush(void)
+{
+	struct bgp_evpn_macip_batch *batch = &evpn_macip_batch;
+	struct stream *s;
+	int ret;
+
+	THREAD_OFF(batch->t_flush);
+
+	if (!batch->count)
+		return 0;
+
+	if (!zclient || zclient->sock < 0) {
+		stream_reset(batch->s);
+		batch->count = 0;
+		return 0;
+	}
+
+	stream_putw_at(batch->s, 0, stream_get_endp(batch->s));
+
+	if (bgp_debug_zebra(NULL))
+		zlog_debug("Tx %u %s MACIP entries in one message",
+			   batch->count,
+			   batch->cmd == ZEBRA_REMOTE_MACIP_ADD ? "ADD" : "DEL");
+
+	s = zclient->obuf;
+	stream_reset(s);
+	stream_put(s, STREAM_DATA(batch->s), stream_get_endp(batch->s));
+
+	stream_reset(batch->s);
+	batch->count = 0;
+
+	ret = zclient_send_message(zclient);
+	return ret < 0 ? -1 : 0;
+}
+
+static void bgp_evpn_zebra_macip_flush_event(struct thread *thread)
+{
+	bgp_evpn_zebra_macip_flush();
+}
+
+static void bgp_evpn_zebra_macip_batch_free(void)
+{
+	bgp_evpn_zebra_macip_flush();
+	if (evpn_macip_batch.s)
+		stream_free(evpn_macip_batch.s);
+	evpn_macip_batch.s = NULL;
+}
+
+/* Start a new entry in the batch, flushing it first if it can't take one */
+static struct stream *bgp_evpn_zebra_macip_batch_get(uint16_t cmd,
+						     vrf_id_t vrf_id)
+{
+	struct bgp_evpn_macip_batch *batch = &evpn_macip_batch;
+
+	if (!batch->s)
+		batch->s = stream_new(ZEBRA_MAX_PACKET_SIZ);
+
+	if (batch->count
+	    && (batch->cmd != cmd || batch->vrf_id != vrf_id
+		|| STREAM_WRITEABLE(batch->s) < EVPN_MACIP_ENTRY_MAX))
+		bgp_evpn_zebra_macip_flush();
+
+	if (!batch->count) {
+		zclient_create_header(batch->s, cmd, vrf_id);
+		batch->cmd = cmd;
+		batch->vrf_id = vrf_id;
+	}
+
+	batch->count++;
+	if (!batch->t_flush)
+		thread_add_event(bm->master, bgp_evpn_zebra_macip_flush_event,
+				 NULL, 0, &batch->t_flush);
+
+	return batch->s;
+}
+
 /*
  * Add (update) or delete MACIP from zebra.
  */
@@ -612,12 +714,10 @@ static int bgp_zebra_send_remote_macip(struct bgp *bgp, struct bgpevpn *vpn,
 
 	if (!esi)
 		esi = zero_esi;
-	s = zclient->obuf;
-	stream_reset(s);
-
-	zclient_create_header(
-		s, add ? ZEBRA_REMOTE_MACIP_ADD : ZEBRA_REMOTE_MACIP_DEL,
+	s = bgp_evpn_zebra_macip_batch_get(
+		add ? ZEBRA_REMOTE_MACIP_ADD : ZEBRA_REMOTE_MACIP_DEL,
 		bgp->vrf_id);
+
 	stream_putl(s, vpn->vni);
 	stream_put(s, &p->prefix.macip_addr.mac.octet, ETH_ALEN); /* Mac Addr */
 	/* IP address length and IP address, if any. */
@@ -645,8 +745,6 @@ static int bgp_zebra_send_remote_macip(struct bgp *bgp, struct bgpevpn *vpn,
 		stream_put(s, esi, sizeof(esi_t));
 	}
 
-	stream_putw_at(s, 0, stream_get_endp(s));
-
 	if (bgp_debug_zebra(NULL))
 		zlog_debug(
 			"Tx %s MACIP, VNI %u MAC %pEA IP %pIA flags 0x%x seq %u remote VTEP %pI4",
@@ -657,7 +755,7 @@ static int bgp_zebra_send_remote_macip(struct bgp *bgp, struct bgpevpn *vpn,
 	frrtrace(5, frr_bgp, evpn_mac_ip_zsend, add, vpn, p, remote_vtep_ip,
 		 esi);
 
-	return zclient_send_message(zclient);
+	return 0;
 }
 
 /*
@@ -682,6 +780,8 @@ static int bgp_zebra_send_remote_vtep(struct bgp *bgp, struct bgpevpn *vpn,
 		return 0;
 	}
 
+	bgp_evpn_zebra_macip_flush();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -2399,8 +2499,8 @@ bgp_create_evpn_bgp_path_info(struct bgp_path_info *parent_pi,
 		memcpy(&pi->extra->label, &parent_pi->extra->label,
 		       sizeof(pi->extra->label));
 		pi->extra->num_labels = parent_pi->extra->num_labels;
-		pi->extra->igpmetric = parent_pi->extra->igpmetric;
 	}
+	pi->igpmetric = parent_pi->igpmetric;
 	bgp_path_info_add(dest, pi);
 
 	return pi;
@@ -5984,6 +6084,9 @@ void bgp_evpn_cleanup_on_disable(struct bgp *bgp)
  */
 void bgp_evpn_cleanup(struct bgp *bgp)
 {
+	if (bgp == bgp_get_evpn())
+		bgp_evpn_zebra_macip_batch_free();
+
 	hash_iterate(bgp->vnihash,
 		     (void (*)(struct hash_bucket *, void *))free_vni_entry,
 		     bgp);
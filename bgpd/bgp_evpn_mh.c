@@ -1395,6 +1395,8 @@ static int bgp_zebra_send_remote_es_vtep(struct bgp *bgp,
 	if (es_vtep->flags & BGP_EVPNES_VTEP_ESR)
 		flags |= ZAPI_ES_VTEP_FLAG_ESR_RXED;
 
+	bgp_evpn_zebra_macip_flush();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -4441,6 +4443,8 @@ static void bgp_evpn_nh_zebra_update_send(struct bgp_evpn_nh *nh, bool add)
 		return;
 	}
 
+	bgp_evpn_zebra_macip_flush();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -30,6 +30,7 @@
 #include "workqueue.h"
 #include "zclient.h"
 #include "mpls.h"
+#include "monotime.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_labelpool.h"
@@ -47,8 +48,13 @@ extern struct zclient *zclient;
  */
 static struct labelpool *lp;
 
-/* request this many labels at a time from zebra */
-#define LP_CHUNK_SIZE	50
+/*
+ * Request this many labels at a time from zebra to begin with. The size of
+ * successive requests doubles up to LP_CHUNK_SIZE_MAX, so that bringing up
+ * many labeled routes only takes a handful of round trips to zebra.
+ */
+#define LP_CHUNK_SIZE		50
+#define LP_CHUNK_SIZE_MAX	16384
 
 DEFINE_MTYPE_STATIC(BGPD, BGP_LABEL_CHUNK, "BGP Label Chunk");
 DEFINE_MTYPE_STATIC(BGPD, BGP_LABEL_FIFO, "BGP Label FIFO item");
@@ -58,8 +64,13 @@ DEFINE_MTYPE_STATIC(BGPD, BGP_LABEL_CBQ, "BGP Dynamic Label Callback");
 struct lp_chunk {
 	uint32_t	first;
 	uint32_t	last;
+	uint32_t	nfree;		/* unallocated labels */
+	uint32_t	lowest_free;	/* no free label below this index */
+	uint32_t	*allocated;	/* bitmap, one bit per label */
 };
 
+#define LP_CHUNK_WORD_BITS	32
+
 /*
  * label control block
  */
@@ -78,6 +89,7 @@ struct lp_lcb {
 struct lp_fifo {
 	struct lp_fifo_item fifo;
 	struct lp_lcb	lcb;
+	struct timeval	requested;
 };
 
 DECLARE_LIST(lp_fifo, struct lp_fifo, fifo);
@@ -90,6 +102,82 @@ struct lp_cbq_item {
 	bool		allocated;	/* false = lost */
 };
 
+static const char *const lp_latency_str[LP_LATENCY_BUCKETS] = {
+	"<1ms", "<10ms", "<100ms", "<1s", ">=1s",
+};
+
+static const char *const lp_latency_json[LP_LATENCY_BUCKETS] = {
+	"lessThan1ms", "lessThan10ms", "lessThan100ms", "lessThan1s",
+	"atLeast1s",
+};
+
+/* Account for a request filled, usecs after it was made. */
+static void lp_latency_record(int64_t usecs)
+{
+	unsigned int i;
+	int64_t limit = 1000;
+
+	for (i = 0; i < LP_LATENCY_BUCKETS - 1; i++, limit *= 10)
+		if (usecs < limit)
+			break;
+
+	lp->latency[i]++;
+}
+
+static struct lp_chunk *lp_chunk_find(uintptr_t lbl)
+{
+	struct listnode *node;
+	struct lp_chunk *chunk;
+
+	for (ALL_LIST_ELEMENTS_RO(lp->chunks, node, chunk))
+		if (lbl >= chunk->first && lbl <= chunk->last)
+			return chunk;
+
+	return NULL;
+}
+
+/* Take a label out of use: clear it in its chunk's bitmap. */
+static void lp_label_release(uintptr_t lbl)
+{
+	struct lp_chunk *chunk;
+	uint32_t index;
+
+	skiplist_delete(lp->inuse, (void *)lbl, NULL);
+
+	chunk = lp_chunk_find(lbl);
+	if (!chunk)
+		return;
+
+	index = lbl - chunk->first;
+	if (!(chunk->allocated[index / LP_CHUNK_WORD_BITS]
+	      & (1U << (index % LP_CHUNK_WORD_BITS))))
+		return;
+
+	chunk->allocated[index / LP_CHUNK_WORD_BITS] &=
+		~(1U << (index % LP_CHUNK_WORD_BITS));
+	chunk->nfree++;
+	lp->free_count++;
+	if (index < chunk->lowest_free)
+		chunk->lowest_free = index;
+}
+
+/* Ask zebra for another chunk, each one bigger than the last. */
+static void lp_chunk_request(void)
+{
+	if (!zclient || zclient->sock < 0)
+		return;
+
+	if (zclient_send_get_label_chunk(zclient, 0, lp->next_chunksize,
+					 MPLS_LABEL_BASE_ANY)
+	    == ZCLIENT_SEND_FAILURE)
+		return;
+
+	lp->pending_count += lp->next_chunksize;
+	if (lp->next_chunksize < LP_CHUNK_SIZE_MAX)
+		lp->next_chunksize = MIN(lp->next_chunksize * 2,
+					 LP_CHUNK_SIZE_MAX);
+}
+
 static wq_item_status lp_cbq_docallback(struct work_queue *wq, void *data)
 {
 	struct lp_cbq_item *lcbq = data;
@@ -140,7 +228,7 @@ static wq_item_status lp_cbq_docallback(struct work_queue *wq, void *data)
 						skiplist_delete(lp->ledger,
 							labelid, NULL);
 				}
-				skiplist_delete(lp->inuse, (void *)lbl, NULL);
+				lp_label_release(lbl);
 			}
 		}
 	}
@@ -160,7 +248,10 @@ static void lp_lcb_free(void *goner)
 
 static void lp_chunk_free(void *goner)
 {
-	XFREE(MTYPE_BGP_LABEL_CHUNK, goner);
+	struct lp_chunk *chunk = goner;
+
+	XFREE(MTYPE_BGP_LABEL_CHUNK, chunk->allocated);
+	XFREE(MTYPE_BGP_LABEL_CHUNK, chunk);
 }
 
 void bgp_lp_init(struct thread_master *master, struct labelpool *pool)
@@ -175,6 +266,7 @@ void bgp_lp_init(struct thread_master *master, struct labelpool *pool)
 	lp->chunks = list_new();
 	lp->chunks->del = lp_chunk_free;
 	lp_fifo_init(&lp->requests);
+	lp->next_chunksize = LP_CHUNK_SIZE;
 	lp->callback_q = work_queue_new(master, "label callbacks");
 
 	lp->callback_q->spec.workfunc = lp_cbq_docallback;
@@ -239,17 +331,41 @@ static mpls_label_t get_label_from_pool(void *labelid)
 	int debug = BGP_DEBUG(labelpool, LABELPOOL);
 
 	/*
-	 * Find a free label
-	 * Linear search is not efficient but should be executed infrequently.
+	 * Find a free label: first chunk with room, then first clear bit
+	 * in its allocation bitmap.
 	 */
 	for (ALL_LIST_ELEMENTS_RO(lp->chunks, node, chunk)) {
+		uint32_t size = chunk->last - chunk->first + 1;
+		uint32_t w, index;
 		uintptr_t lbl;
 
+		if (!chunk->nfree)
+			continue;
+
 		if (debug)
-			zlog_debug("%s: chunk first=%u last=%u",
-				__func__, chunk->first, chunk->last);
+			zlog_debug("%s: chunk first=%u last=%u nfree=%u",
+				__func__, chunk->first, chunk->last,
+				chunk->nfree);
+
+		w = chunk->lowest_free / LP_CHUNK_WORD_BITS;
+		while (w * LP_CHUNK_WORD_BITS < size) {
+			if (chunk->allocated[w] == UINT32_MAX) {
+				w++;
+				continue;
+			}
+
+			index = w * LP_CHUNK_WORD_BITS
+				+ ffs(~chunk->allocated[w]) - 1;
+			if (index >= size)
+				break;
+
+			chunk->allocated[w] |= 1U << (index % LP_CHUNK_WORD_BITS);
+			chunk->nfree--;
+			chunk->lowest_free = index + 1;
+			lp->free_count--;
+
+			lbl = chunk->first + index;
 
-		for (lbl = chunk->first; lbl <= chunk->last; ++lbl) {
 			/* labelid is key to all-request "ledger" list */
 			if (!skiplist_insert(lp->inuse, (void *)lbl, labelid)) {
 				/*
@@ -361,6 +477,14 @@ void bgp_lp_get(
 
 		work_queue_add(lp->callback_q, q);
 
+		if (!requested)
+			lp_latency_record(0);
+
+		/* Running low: get the next chunk before we run out */
+		if (lp->free_count < lp->next_chunksize / 4
+		    && !lp->pending_count)
+			lp_chunk_request();
+
 		return;
 	}
 
@@ -384,19 +508,14 @@ void bgp_lp_get(
 		sizeof(struct lp_fifo));
 
 	lf->lcb = *lcb;
+	monotime(&lf->requested);
 	/* if this is a LU request, lock node before queueing */
 	check_bgp_lu_cb_lock(lcb);
 
 	lp_fifo_add_tail(&lp->requests, lf);
 
-	if (lp_fifo_count(&lp->requests) > lp->pending_count) {
-		if (!zclient || zclient->sock < 0)
-			return;
-		if (zclient_send_get_label_chunk(zclient, 0, LP_CHUNK_SIZE,
-						 MPLS_LABEL_BASE_ANY)
-		    != ZCLIENT_SEND_FAILURE)
-			lp->pending_count += LP_CHUNK_SIZE;
-	}
+	if (lp_fifo_count(&lp->requests) > lp->pending_count)
+		lp_chunk_request();
 }
 
 void bgp_lp_release(
@@ -411,7 +530,7 @@ void bgp_lp_release(
 			uintptr_t lbl = label;
 
 			/* no longer in use */
-			skiplist_delete(lp->inuse, (void *)lbl, NULL);
+			lp_label_release(lbl);
 
 			/* no longer requested */
 			skiplist_delete(lp->ledger, labelid, NULL);
@@ -439,8 +558,13 @@ void bgp_lp_event_chunk(uint8_t keep, uint32_t first, uint32_t last)
 
 	chunk->first = first;
 	chunk->last = last;
+	chunk->nfree = last - first + 1;
+	chunk->allocated = XCALLOC(MTYPE_BGP_LABEL_CHUNK,
+				   (chunk->nfree / LP_CHUNK_WORD_BITS + 1)
+					   * sizeof(uint32_t));
 
 	listnode_add(lp->chunks, chunk);
+	lp->free_count += chunk->nfree;
 
 	lp->pending_count -= (last - first + 1);
 
@@ -513,6 +637,7 @@ void bgp_lp_event_chunk(uint8_t keep, uint32_t first, uint32_t last)
 				__func__, q->label, q->labelid);
 
 		work_queue_add(lp->callback_q, q);
+		lp_latency_record(monotime_since(&lf->requested, NULL));
 
 finishedrequest:
 		lp_fifo_del(&lp->requests, lf);
@@ -567,6 +692,7 @@ void bgp_lp_event_zebra_up(void)
 	 * Invalidate current list of chunks
 	 */
 	list_delete_all_node(lp->chunks);
+	lp->free_count = 0;
 
 	/*
 	 * Invalidate any existing labels and requeue them as requests
@@ -604,6 +730,7 @@ void bgp_lp_event_zebra_up(void)
 				sizeof(struct lp_fifo));
 
 			lf->lcb = *lcb;
+			monotime(&lf->requested);
 			check_bgp_lu_cb_lock(lcb);
 			lp_fifo_add_tail(&lp->requests, lf);
 		}
@@ -619,7 +746,8 @@ DEFUN(show_bgp_labelpool_summary, show_bgp_labelpool_summary_cmd,
       "BGP Labelpool summary\n" JSON_STR)
 {
 	bool uj = use_json(argc, argv);
-	json_object *json = NULL;
+	json_object *json = NULL, *json_latency;
+	unsigned int i;
 
 	if (!lp) {
 		if (uj)
@@ -648,6 +776,14 @@ CPP_NOTICE("Remove JSON object commands with keys starting with capital")
 		json_object_int_add(json, "pending", lp->pending_count);
 		json_object_int_add(json, "Reconnects", lp->reconnect_count);
 		json_object_int_add(json, "reconnects", lp->reconnect_count);
+		json_object_int_add(json, "freeLabels", lp->free_count);
+		json_object_int_add(json, "nextChunkSize", lp->next_chunksize);
+		json_latency = json_object_new_object();
+		for (i = 0; i < LP_LATENCY_BUCKETS; i++)
+			json_object_int_add(json_latency, lp_latency_json[i],
+					    lp->latency[i]);
+		json_object_object_add(json, "allocationLatency",
+				       json_latency);
 		vty_json(vty, json);
 	} else {
 		vty_out(vty, "Labelpool Summary\n");
@@ -661,6 +797,12 @@ CPP_NOTICE("Remove JSON object commands with keys starting with capital")
 			"LabelChunks:", listcount(lp->chunks));
 		vty_out(vty, "%-13s %d\n", "Pending:", lp->pending_count);
 		vty_out(vty, "%-13s %d\n", "Reconnects:", lp->reconnect_count);
+		vty_out(vty, "%-13s %u\n", "FreeLabels:", lp->free_count);
+		vty_out(vty, "%-13s %u\n", "NextChunk:", lp->next_chunksize);
+		vty_out(vty, "Allocation latency:\n");
+		for (i = 0; i < LP_LATENCY_BUCKETS; i++)
+			vty_out(vty, "  %-11s %" PRIu64 "\n",
+				lp_latency_str[i], lp->latency[i]);
 	}
 	return CMD_SUCCESS;
 }
@@ -33,6 +33,9 @@
 
 PREDECL_LIST(lp_fifo);
 
+/* Allocation latency histogram: <1ms, <10ms, <100ms, <1s, >=1s */
+#define LP_LATENCY_BUCKETS	5
+
 struct labelpool {
 	struct skiplist		*ledger;	/* all requests */
 	struct skiplist		*inuse;		/* individual labels */
@@ -41,6 +44,9 @@ struct labelpool {
 	struct work_queue	*callback_q;
 	uint32_t		pending_count;	/* requested from zebra */
 	uint32_t reconnect_count;		/* zebra reconnections */
+	uint32_t		free_count;	/* unallocated, in chunks */
+	uint32_t		next_chunksize;	/* size of next request */
+	uint64_t		latency[LP_LATENCY_BUCKETS];
 };
 
 extern void bgp_lp_init(struct thread_master *master, struct labelpool *pool);
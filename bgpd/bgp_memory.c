@@ -108,6 +108,8 @@ DEFINE_MTYPE(BGPD, TIP_ADDR, "BGP own tunnel-ip address");
 DEFINE_MTYPE(BGPD, BGP_REDIST, "BGP redistribution");
 DEFINE_MTYPE(BGPD, BGP_FILTER_NAME, "BGP Filter Information");
 DEFINE_MTYPE(BGPD, BGP_DUMP_STR, "BGP Dump String Information");
+DEFINE_MTYPE(BGPD, BGP_DUMP_JOB, "BGP Dump Job");
+DEFINE_MTYPE(BGPD, BGP_DUMP_PEER, "BGP Dump Peer Index");
 DEFINE_MTYPE(BGPD, ENCAP_TLV, "ENCAP TLV");
 
 DEFINE_MTYPE(BGPD, BGP_TEA_OPTIONS, "BGP TEA Options");
@@ -144,4 +146,6 @@ DEFINE_MTYPE(BGPD, BGP_SRV6_L3VPN, "BGP prefix-sid srv6 l3vpn servcie");
 DEFINE_MTYPE(BGPD, BGP_SRV6_VPN, "BGP prefix-sid srv6 vpn service");
 DEFINE_MTYPE(BGPD, BGP_SRV6_SID, "BGP srv6 segment-id");
 DEFINE_MTYPE(BGPD, BGP_SRV6_FUNCTION, "BGP srv6 function");
+
+DEFINE_MTYPE(BGPD, BGP_VPN_IMPORT_RT, "BGP VPN Import RT");
 DEFINE_MTYPE(BGPD, EVPN_REMOTE_IP, "BGP EVPN Remote IP hash entry");
@@ -104,6 +104,8 @@ DECLARE_MTYPE(TIP_ADDR);
 DECLARE_MTYPE(BGP_REDIST);
 DECLARE_MTYPE(BGP_FILTER_NAME);
 DECLARE_MTYPE(BGP_DUMP_STR);
+DECLARE_MTYPE(BGP_DUMP_JOB);
+DECLARE_MTYPE(BGP_DUMP_PEER);
 DECLARE_MTYPE(ENCAP_TLV);
 
 DECLARE_MTYPE(BGP_TEA_OPTIONS);
@@ -142,6 +144,8 @@ DECLARE_MTYPE(BGP_SRV6_VPN);
 DECLARE_MTYPE(BGP_SRV6_SID);
 DECLARE_MTYPE(BGP_SRV6_FUNCTION);
 
+DECLARE_MTYPE(BGP_VPN_IMPORT_RT);
+
 DECLARE_MTYPE(EVPN_REMOTE_IP);
 
 #endif /* _QUAGGA_BGP_MEMORY_H */
@@ -29,6 +29,8 @@
 #include "filter.h"
 #include "mpls.h"
 #include "json.h"
+#include "hash.h"
+#include "jhash.h"
 #include "zclient.h"
 
 #include "bgpd/bgpd.h"
@@ -657,6 +659,157 @@ static bool ecom_intersect(struct ecommunity *e1, struct ecommunity *e2)
 	return false;
 }
 
+/*
+ * Import route target index: maps each route target found in a VRF's
+ * "rt vpn import" list to the VRF instances importing it, so that a VPN
+ * update only visits the VRFs it can actually be leaked into rather than
+ * every instance in bm->bgp. It is built lazily on first use and thrown
+ * away by vpn_leak_import_rt_index_invalidate() whenever an import list
+ * or the instance list changes.
+ */
+struct vpn_import_rt_node {
+	afi_t afi;
+	struct ecommunity_val rt;
+
+	/* VRF instances importing this RT, in bm->bgp order */
+	struct list *vrfs;
+};
+
+static unsigned int vpn_import_rt_hash_key_make(const void *p)
+{
+	const struct vpn_import_rt_node *irt = p;
+
+	return jhash(irt->rt.val, ECOMMUNITY_SIZE, irt->afi);
+}
+
+static bool vpn_import_rt_hash_cmp(const void *p1, const void *p2)
+{
+	const struct vpn_import_rt_node *irt1 = p1;
+	const struct vpn_import_rt_node *irt2 = p2;
+
+	return irt1->afi == irt2->afi
+	       && !memcmp(irt1->rt.val, irt2->rt.val, ECOMMUNITY_SIZE);
+}
+
+static void *vpn_import_rt_alloc(void *p)
+{
+	const struct vpn_import_rt_node *tmp = p;
+	struct vpn_import_rt_node *irt;
+
+	irt = XCALLOC(MTYPE_BGP_VPN_IMPORT_RT, sizeof(*irt));
+	irt->afi = tmp->afi;
+	irt->rt = tmp->rt;
+	irt->vrfs = list_new();
+
+	return irt;
+}
+
+static void vpn_import_rt_free(void *p)
+{
+	struct vpn_import_rt_node *irt = p;
+
+	list_delete(&irt->vrfs);
+	XFREE(MTYPE_BGP_VPN_IMPORT_RT, irt);
+}
+
+void vpn_leak_import_rt_index_invalidate(void)
+{
+	if (!bm->vpn_import_rt_hash)
+		return;
+
+	hash_clean(bm->vpn_import_rt_hash, vpn_import_rt_free);
+	hash_free(bm->vpn_import_rt_hash);
+	bm->vpn_import_rt_hash = NULL;
+}
+
+static struct hash *vpn_import_rt_index(void)
+{
+	struct listnode *node;
+	struct bgp *bgp;
+	struct ecommunity *ecom;
+	struct vpn_import_rt_node tmp;
+	struct vpn_import_rt_node *irt;
+	afi_t afi;
+	uint32_t i;
+
+	if (bm->vpn_import_rt_hash)
+		return bm->vpn_import_rt_hash;
+
+	bm->vpn_import_rt_hash =
+		hash_create(vpn_import_rt_hash_key_make, vpn_import_rt_hash_cmp,
+			    "BGP VPN Import RT Hash");
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		for (afi = AFI_IP; afi < AFI_MAX; afi++) {
+			ecom = bgp->vpn_policy[afi]
+				       .rtlist[BGP_VPN_POLICY_DIR_FROMVPN];
+			if (!ecom)
+				continue;
+
+			for (i = 0; i < ecom->size; i++) {
+				memset(&tmp, 0, sizeof(tmp));
+				tmp.afi = afi;
+				memcpy(tmp.rt.val,
+				       ecom->val + (i * ecom->unit_size),
+				       ECOMMUNITY_SIZE);
+
+				irt = hash_get(bm->vpn_import_rt_hash, &tmp,
+					       vpn_import_rt_alloc);
+				if (!listnode_lookup(irt->vrfs, bgp))
+					listnode_add(irt->vrfs, bgp);
+			}
+		}
+	}
+
+	return bm->vpn_import_rt_hash;
+}
+
+static struct vpn_import_rt_node *
+vpn_import_rt_lookup(afi_t afi, struct ecommunity *ecom, uint32_t idx)
+{
+	struct vpn_import_rt_node tmp;
+
+	memset(&tmp, 0, sizeof(tmp));
+	tmp.afi = afi;
+	memcpy(tmp.rt.val, ecom->val + (idx * ecom->unit_size),
+	       ECOMMUNITY_SIZE);
+
+	return hash_lookup(vpn_import_rt_index(), &tmp);
+}
+
+/* VRF instances importing the idx'th RT of ecom, or NULL if there are none */
+struct list *vpn_leak_import_rt_vrfs(afi_t afi, struct ecommunity *ecom,
+				     uint32_t idx)
+{
+	struct vpn_import_rt_node *irt;
+
+	irt = vpn_import_rt_lookup(afi, ecom, idx);
+
+	return irt ? irt->vrfs : NULL;
+}
+
+/*
+ * A VRF importing several of the route's RTs is listed under each of them:
+ * only act on it for the first one.
+ */
+static bool vpn_import_rt_seen(struct bgp *bgp_vrf, afi_t afi,
+			       struct ecommunity *ecom, uint32_t idx)
+{
+	struct ecommunity *rtlist =
+		bgp_vrf->vpn_policy[afi].rtlist[BGP_VPN_POLICY_DIR_FROMVPN];
+	uint32_t i, j;
+
+	for (i = 0; i < idx; i++) {
+		for (j = 0; j < rtlist->size; j++) {
+			if (!memcmp(ecom->val + (i * ecom->unit_size),
+				    rtlist->val + (j * rtlist->unit_size),
+				    ECOMMUNITY_SIZE))
+				return true;
+		}
+	}
+	return false;
+}
+
 static bool labels_same(struct bgp_path_info *bpi, mpls_label_t *label,
 			uint32_t n)
 {
@@ -1658,35 +1811,93 @@ vpn_leak_to_vrf_update_onevrf(struct bgp *bgp_vrf,	    /* to */
 void vpn_leak_to_vrf_update(struct bgp *bgp_vpn,	    /* from */
 			    struct bgp_path_info *path_vpn) /* route */
 {
-	struct listnode *mnode, *mnnode;
+	const struct prefix *p = bgp_dest_get_prefix(path_vpn->net);
+	afi_t afi = family2afi(p->family);
+	struct ecommunity *ecom = bgp_attr_get_ecommunity(path_vpn->attr);
+	struct vpn_import_rt_node *irt;
+	struct listnode *mnode;
 	struct bgp *bgp;
+	uint32_t i;
 
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
 
 	if (debug)
 		zlog_debug("%s: start (path_vpn=%p)", __func__, path_vpn);
 
-	/* Loop over VRFs */
-	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
+	if (!ecom)
+		return;
 
-		if (!path_vpn->extra
-		    || path_vpn->extra->bgp_orig != bgp) { /* no loop */
-			vpn_leak_to_vrf_update_onevrf(bgp, bgp_vpn, path_vpn);
+	/* Loop over VRFs importing one of the route's RTs */
+	for (i = 0; i < ecom->size; i++) {
+		irt = vpn_import_rt_lookup(afi, ecom, i);
+		if (!irt)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(irt->vrfs, mnode, bgp)) {
+			if (vpn_import_rt_seen(bgp, afi, ecom, i))
+				continue;
+
+			if (!path_vpn->extra
+			    || path_vpn->extra->bgp_orig != bgp) { /* no loop */
+				vpn_leak_to_vrf_update_onevrf(bgp, bgp_vpn,
+							      path_vpn);
+			}
 		}
 	}
 }
 
+static void
+vpn_leak_to_vrf_withdraw_onevrf(struct bgp *bgp_vrf,		 /* to */
+				struct bgp_path_info *path_vpn) /* route */
+{
+	const struct prefix *p = bgp_dest_get_prefix(path_vpn->net);
+	afi_t afi = family2afi(p->family);
+	safi_t safi = SAFI_UNICAST;
+	struct bgp_dest *bn;
+	struct bgp_path_info *bpi;
+	const char *debugmsg;
+
+	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
+
+	if (!vpn_leak_from_vpn_active(bgp_vrf, afi, &debugmsg)) {
+		if (debug)
+			zlog_debug("%s: skipping: %s", __func__, debugmsg);
+		return;
+	}
+
+	if (debug)
+		zlog_debug("%s: withdrawing from vrf %s", __func__,
+			   bgp_vrf->name_pretty);
+
+	bn = bgp_afi_node_get(bgp_vrf->rib[afi][safi], afi, safi, p, NULL);
+
+	for (bpi = bgp_dest_get_bgp_path_info(bn); bpi; bpi = bpi->next) {
+		if (bpi->extra
+		    && (struct bgp_path_info *)bpi->extra->parent == path_vpn) {
+			break;
+		}
+	}
+
+	if (bpi) {
+		if (debug)
+			zlog_debug("%s: deleting bpi %p", __func__, bpi);
+		bgp_aggregate_decrement(bgp_vrf, p, bpi, afi, safi);
+		bgp_path_info_delete(bn, bpi);
+		bgp_process(bgp_vrf, bn, afi, safi);
+	}
+	bgp_dest_unlock_node(bn);
+}
+
 void vpn_leak_to_vrf_withdraw(struct bgp *bgp_vpn,	    /* from */
 			      struct bgp_path_info *path_vpn) /* route */
 {
 	const struct prefix *p;
 	afi_t afi;
-	safi_t safi = SAFI_UNICAST;
 	struct bgp *bgp;
-	struct listnode *mnode, *mnnode;
-	struct bgp_dest *bn;
-	struct bgp_path_info *bpi;
-	const char *debugmsg;
+	struct listnode *mnode;
+	struct ecommunity *ecom;
+	struct vpn_import_rt_node *irt;
+	uint32_t i;
 
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
 
@@ -1716,47 +1927,22 @@ void vpn_leak_to_vrf_withdraw(struct bgp *bgp_vpn,	    /* from */
 	p = bgp_dest_get_prefix(path_vpn->net);
 	afi = family2afi(p->family);
 
-	/* Loop over VRFs */
-	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
-		if (!vpn_leak_from_vpn_active(bgp, afi, &debugmsg)) {
-			if (debug)
-				zlog_debug("%s: skipping: %s", __func__,
-					   debugmsg);
-			continue;
-		}
-
-		/* Check for intersection of route targets */
-		if (!ecom_intersect(bgp->vpn_policy[afi]
-					    .rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
-				    bgp_attr_get_ecommunity(path_vpn->attr))) {
+	ecom = bgp_attr_get_ecommunity(path_vpn->attr);
+	if (!ecom)
+		return;
 
+	/* Loop over VRFs importing one of the route's RTs */
+	for (i = 0; i < ecom->size; i++) {
+		irt = vpn_import_rt_lookup(afi, ecom, i);
+		if (!irt)
 			continue;
-		}
-
-		if (debug)
-			zlog_debug("%s: withdrawing from vrf %s", __func__,
-				   bgp->name_pretty);
 
-		bn = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
-
-		for (bpi = bgp_dest_get_bgp_path_info(bn); bpi;
-		     bpi = bpi->next) {
-			if (bpi->extra
-			    && (struct bgp_path_info *)bpi->extra->parent
-				       == path_vpn) {
-				break;
-			}
-		}
+		for (ALL_LIST_ELEMENTS_RO(irt->vrfs, mnode, bgp)) {
+			if (vpn_import_rt_seen(bgp, afi, ecom, i))
+				continue;
 
-		if (bpi) {
-			if (debug)
-				zlog_debug("%s: deleting bpi %p", __func__,
-					   bpi);
-			bgp_aggregate_decrement(bgp, p, bpi, afi, safi);
-			bgp_path_info_delete(bn, bpi);
-			bgp_process(bgp, bn, afi, safi);
+			vpn_leak_to_vrf_withdraw_onevrf(bgp, path_vpn);
 		}
-		bgp_dest_unlock_node(bn);
 	}
 }
 
@@ -1970,6 +2156,7 @@ void vpn_handle_router_id_update(struct bgp *bgp, bool withdraw,
 						.rtlist[idir],
 					(struct ecommunity_val *)ecom->val);
 			}
+			vpn_leak_import_rt_index_invalidate();
 		} else {
 			/* New router-id derive auto RD and RT and export
 			 * to VPN
@@ -2002,6 +2189,7 @@ void vpn_handle_router_id_update(struct bgp *bgp, bool withdraw,
 					bgp_import->vpn_policy[afi].rtlist[idir]
 						= ecommunity_dup(ecom);
 			}
+			vpn_leak_import_rt_index_invalidate();
 
 			/* Update routes to VPN */
 			vpn_leak_postchange(BGP_VPN_POLICY_DIR_TOVPN,
@@ -2123,6 +2311,7 @@ void vrf_import_from_vrf(struct bgp *to_bgp, struct bgp *from_bgp,
 					 .rtlist[idir], ecom);
 	else
 		to_bgp->vpn_policy[afi].rtlist[idir] = ecommunity_dup(ecom);
+	vpn_leak_import_rt_index_invalidate();
 	SET_FLAG(to_bgp->af_flags[afi][safi], BGP_CONFIG_VRF_TO_VRF_IMPORT);
 
 	if (debug) {
@@ -2213,11 +2402,13 @@ void vrf_unimport_from_vrf(struct bgp *to_bgp, struct bgp *from_bgp,
 				   BGP_CONFIG_VRF_TO_VRF_IMPORT);
 		if (to_bgp->vpn_policy[afi].rtlist[idir])
 			ecommunity_free(&to_bgp->vpn_policy[afi].rtlist[idir]);
+		vpn_leak_import_rt_index_invalidate();
 	} else {
 		ecom = from_bgp->vpn_policy[afi].rtlist[edir];
 		if (ecom)
 			ecommunity_del_val(to_bgp->vpn_policy[afi].rtlist[idir],
 				   (struct ecommunity_val *)ecom->val);
+		vpn_leak_import_rt_index_invalidate();
 		vpn_leak_postchange(idir, afi, bgp_get_default(), to_bgp);
 	}
 
@@ -3128,11 +3319,13 @@ void bgp_vpn_leak_export(struct bgp *from_bgp)
 				/* remove import rt, it will be readded
 				 * as part of import from vrf.
 				 */
-				if (ecom)
+				if (ecom) {
 					ecommunity_del_val(
 						to_vpolicy->rtlist[idir],
 						(struct ecommunity_val *)
 							ecom->val);
+					vpn_leak_import_rt_index_invalidate();
+				}
 				vrf_import_from_vrf(to_bgp, from_bgp,
 						    afi, safi);
 				break;
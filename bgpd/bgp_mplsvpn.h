@@ -73,6 +73,10 @@ extern void vpn_leak_to_vrf_update_all(struct bgp *bgp_vrf, struct bgp *bgp_vpn,
 extern void vpn_leak_to_vrf_update(struct bgp *bgp_vpn,
 				   struct bgp_path_info *path_vpn);
 
+extern void vpn_leak_import_rt_index_invalidate(void);
+extern struct list *vpn_leak_import_rt_vrfs(afi_t afi, struct ecommunity *ecom,
+					    uint32_t idx);
+
 extern void vpn_leak_to_vrf_withdraw(struct bgp *bgp_vpn,
 				     struct bgp_path_info *path_vpn);
 
@@ -317,10 +317,10 @@ int bgp_find_or_add_nexthop(struct bgp *bgp_route, struct bgp *bgp_nexthop,
 		/* updates NHT pi list reference */
 		path_nh_map(pi, bnc, true);
 
-		if (CHECK_FLAG(bnc->flags, BGP_NEXTHOP_VALID) && bnc->metric)
-			(bgp_path_info_extra_get(pi))->igpmetric = bnc->metric;
-		else if (pi->extra)
-			pi->extra->igpmetric = 0;
+		if (CHECK_FLAG(bnc->flags, BGP_NEXTHOP_VALID))
+			pi->igpmetric = bnc->metric;
+		else
+			pi->igpmetric = 0;
 	} else if (peer) {
 		/*
 		 * Let's not accidently save the peer data for a peer
@@ -1060,11 +1060,10 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 
 		/* Copy the metric to the path. Will be used for bestpath
 		 * computation */
-		if (bgp_isvalid_nexthop(bnc) && bnc->metric)
-			(bgp_path_info_extra_get(path))->igpmetric =
-				bnc->metric;
-		else if (path->extra)
-			path->extra->igpmetric = 0;
+		if (bgp_isvalid_nexthop(bnc))
+			path->igpmetric = bnc->metric;
+		else
+			path->igpmetric = 0;
 
 		if (CHECK_FLAG(bnc->change_flags, BGP_NEXTHOP_METRIC_CHANGED)
 		    || CHECK_FLAG(bnc->change_flags, BGP_NEXTHOP_CHANGED)
@@ -368,7 +368,8 @@ static void bgp_write_proceed_actions(struct peer *peer)
 
 		/* No packets to send, see if EOR is pending */
 		if (CHECK_FLAG(peer->cap, PEER_CAP_RESTART_RCV)) {
-			if (!subgrp->t_coalesce && peer->afc_nego[afi][safi]
+			if (!subgrp->t_coalesce && !subgrp->t_announce_table
+			    && peer->afc_nego[afi][safi]
 			    && peer->synctime
 			    && !CHECK_FLAG(peer->af_sflags[afi][safi],
 					   PEER_STATUS_EOR_SEND)
@@ -451,7 +452,8 @@ void bgp_generate_updgrp_packets(struct thread *thread)
 			 * yet.
 			 */
 			if (!next_pkt || !next_pkt->buffer) {
-				if (!paf->t_announce_route) {
+				if (!paf->t_announce_route
+				    && !PAF_SUBGRP(paf)->t_announce_table) {
 					/* Make sure we supress BGP UPDATES
 					 * for normal processing later again.
 					 */
@@ -493,6 +495,7 @@ void bgp_generate_updgrp_packets(struct thread *thread)
 				if (CHECK_FLAG(peer->cap,
 					       PEER_CAP_RESTART_RCV)) {
 					if (!(PAF_SUBGRP(paf))->t_coalesce
+					    && !(PAF_SUBGRP(paf))->t_announce_table
 					    && peer->afc_nego[afi][safi]
 					    && peer->synctime
 					    && !CHECK_FLAG(
@@ -1879,9 +1882,6 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 
 	peer->update_time = bgp_clock();
 
-	/* Notify BGP Conditional advertisement scanner process */
-	peer->advmap_table_change = true;
-
 	return Receive_UPDATE_message;
 }
 
@@ -88,6 +88,7 @@
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_flowspec_util.h"
 #include "bgpd/bgp_pbr.h"
+#include "bgpd/bgp_conditional_adv.h"
 
 #ifndef VTYSH_EXTRACT_PL
 #include "bgpd/bgp_route_clippy.c"
@@ -133,6 +134,12 @@ DEFINE_HOOK(bgp_process,
 	     struct peer *peer, bool withdraw),
 	    (bgp, afi, safi, bn, peer, withdraw));
 
+DEFINE_HOOK(bgp_route_update,
+	    (struct bgp * bgp, afi_t afi, safi_t safi, struct bgp_dest *bn,
+	     struct bgp_path_info *old_route,
+	     struct bgp_path_info *new_route),
+	    (bgp, afi, safi, bn, old_route, new_route));
+
 /** Test if path is suppressed. */
 static bool bgp_path_suppressed(struct bgp_path_info *pi)
 {
@@ -394,6 +401,7 @@ static int bgp_dest_set_defer_flag(struct bgp_dest *dest, bool delete)
 void bgp_path_info_add(struct bgp_dest *dest, struct bgp_path_info *pi)
 {
 	struct bgp_path_info *top;
+	struct bgp_table *table = bgp_dest_table(dest);
 
 	top = bgp_dest_get_bgp_path_info(dest);
 
@@ -406,6 +414,9 @@ void bgp_path_info_add(struct bgp_dest *dest, struct bgp_path_info *pi)
 	bgp_path_info_lock(pi);
 	bgp_dest_lock_node(dest);
 	peer_lock(pi->peer); /* bgp_path_info peer reference */
+	if (bgp_path_info_peer_indexed(pi))
+		bgp_peer_paths_add_tail(
+			&pi->peer->paths[table->afi][table->safi], pi);
 	bgp_dest_set_defer_flag(dest, false);
 	hook_call(bgp_snmp_update_stats, dest, pi, true);
 }
@@ -414,6 +425,12 @@ void bgp_path_info_add(struct bgp_dest *dest, struct bgp_path_info *pi)
    completion callback *only* */
 void bgp_path_info_reap(struct bgp_dest *dest, struct bgp_path_info *pi)
 {
+	struct bgp_table *table = bgp_dest_table(dest);
+
+	if (bgp_path_info_peer_indexed(pi))
+		bgp_peer_paths_del(&pi->peer->paths[table->afi][table->safi],
+				   pi);
+
 	if (pi->next)
 		pi->next->prev = pi->prev;
 	if (pi->prev)
@@ -1051,12 +1068,8 @@ static int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 	}
 
 	/* 8. IGP metric check. */
-	newm = existm = 0;
-
-	if (new->extra)
-		newm = new->extra->igpmetric;
-	if (exist->extra)
-		existm = exist->extra->igpmetric;
+	newm = new->igpmetric;
+	existm = exist->igpmetric;
 
 	if (newm < existm) {
 		if (debug && peer_sort_ret < 0)
@@ -1805,24 +1818,6 @@ void bgp_attr_add_gshut_community(struct attr *attr)
 }
 
 
-/* Notify BGP Conditional advertisement scanner process. */
-void bgp_notify_conditional_adv_scanner(struct update_subgroup *subgrp)
-{
-	struct peer *peer = SUBGRP_PEER(subgrp);
-	afi_t afi = SUBGRP_AFI(subgrp);
-	safi_t safi = SUBGRP_SAFI(subgrp);
-	struct bgp_filter *filter = &peer->filter[afi][safi];
-
-	if (!ADVERTISE_MAP_NAME(filter))
-		return;
-
-	if (!CHECK_FLAG(peer->flags, PEER_FLAG_CONFIG_NODE))
-		return;
-
-	peer->advmap_table_change = true;
-}
-
-
 void subgroup_announce_reset_nhop(uint8_t family, struct attr *attr)
 {
 	if (family == AF_INET) {
@@ -2985,6 +2980,9 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 			__func__, dest, bgp->name_pretty, afi2str(afi),
 			safi2str(safi), old_select, new_select);
 
+	/* Flag conditional advertisement state affected by this change */
+	bgp_conditional_adv_dest_update(bgp, afi, safi, dest);
+
 	/* If best route remains the same and this is not due to user-initiated
 	 * clear, see exactly what needs to be done.
 	 */
@@ -3020,6 +3018,9 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 		if (CHECK_FLAG(old_select->flags, BGP_PATH_ATTR_CHANGED)
 		    || CHECK_FLAG(old_select->flags, BGP_PATH_LINK_BW_CHG)
 		    || CHECK_FLAG(dest->flags, BGP_NODE_LABEL_CHANGED)) {
+			hook_call(bgp_route_update, bgp, afi, safi, dest,
+				  old_select, new_select);
+
 			group_announce_route(bgp, afi, safi, dest, new_select);
 
 			/* unicast routes must also be annouced to
@@ -3076,6 +3077,9 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 		UNSET_FLAG(new_select->flags, BGP_PATH_LINK_BW_CHG);
 	}
 
+	hook_call(bgp_route_update, bgp, afi, safi, dest, old_select,
+		  new_select);
+
 #ifdef ENABLE_BGP_VNC
 	if ((afi == AFI_IP || afi == AFI_IP6) && (safi == SAFI_UNICAST)) {
 		if (old_select != new_select) {
@@ -5166,99 +5170,74 @@ static void bgp_clear_node_queue_init(struct peer *peer)
 	peer->clear_node_queue->spec.data = peer;
 }
 
-static void bgp_clear_route_table(struct peer *peer, afi_t afi, safi_t safi,
-				  struct bgp_table *table)
+/* With AddPath a peer may have several paths for a prefix; only queue the
+ * dest for the first of them, bgp_clear_route_node() handles them all.
+ * Imported paths carry their parent's peer but are not on peer->paths, so
+ * they must not count as the first one.
+ */
+static bool bgp_clear_route_first_path(struct bgp_dest *dest,
+				       struct bgp_path_info *pi)
 {
-	struct bgp_dest *dest;
-	int force = peer->bgp->process_queue ? 0 : 1;
+	struct bgp_path_info *iter;
 
-	if (!table)
-		table = peer->bgp->rib[afi][safi];
+	for (iter = bgp_dest_get_bgp_path_info(dest); iter; iter = iter->next) {
+		if (!bgp_path_info_peer_indexed(iter))
+			continue;
+		if (iter->peer == pi->peer)
+			return iter == pi;
+	}
 
-	/* If still no table => afi/safi isn't configured at all or smth. */
-	if (!table)
-		return;
+	return false;
+}
 
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		struct bgp_path_info *pi, *next;
-		struct bgp_adj_in *ain;
-		struct bgp_adj_in *ain_next;
-
-		/* XXX:TODO: This is suboptimal, every non-empty route_node is
-		 * queued for every clearing peer, regardless of whether it is
-		 * relevant to the peer at hand.
-		 *
-		 * Overview: There are 3 different indices which need to be
-		 * scrubbed, potentially, when a peer is removed:
-		 *
-		 * 1 peer's routes visible via the RIB (ie accepted routes)
-		 * 2 peer's routes visible by the (optional) peer's adj-in index
-		 * 3 other routes visible by the peer's adj-out index
-		 *
-		 * 3 there is no hurry in scrubbing, once the struct peer is
-		 * removed from bgp->peer, we could just GC such deleted peer's
-		 * adj-outs at our leisure.
-		 *
-		 * 1 and 2 must be 'scrubbed' in some way, at least made
-		 * invisible via RIB index before peer session is allowed to be
-		 * brought back up. So one needs to know when such a 'search' is
-		 * complete.
-		 *
-		 * Ideally:
-		 *
-		 * - there'd be a single global queue or a single RIB walker
-		 * - rather than tracking which route_nodes still need to be
-		 *   examined on a peer basis, we'd track which peers still
-		 *   aren't cleared
-		 *
-		 * Given that our per-peer prefix-counts now should be reliable,
-		 * this may actually be achievable. It doesn't seem to be a huge
-		 * problem at this time,
-		 *
-		 * It is possible that we have multiple paths for a prefix from
-		 * a peer
-		 * if that peer is using AddPath.
-		 */
-		ain = dest->adj_in;
-		while (ain) {
-			ain_next = ain->next;
+static void bgp_clear_route_peer(struct peer *peer, afi_t afi, safi_t safi)
+{
+	struct bgp_dest *dest;
+	struct bgp_path_info *pi;
+	struct bgp_adj_in *ain;
+	struct bgp_clear_node_queue *cnq;
+	int force = peer->bgp->process_queue ? 0 : 1;
 
-			if (ain->peer == peer)
-				bgp_adj_in_remove(dest, ain);
+	/* There are 3 different indices which need to be scrubbed,
+	 * potentially, when a peer is removed:
+	 *
+	 * 1 peer's routes visible via the RIB (ie accepted routes)
+	 * 2 peer's routes visible by the (optional) peer's adj-in index
+	 * 3 other routes visible by the peer's adj-out index
+	 *
+	 * 3 there is no hurry in scrubbing, once the struct peer is
+	 * removed from bgp->peer, we could just GC such deleted peer's
+	 * adj-outs at our leisure.
+	 *
+	 * 1 and 2 are found through the per-peer lists, so only the
+	 * peer's own routes are visited rather than the whole table.
+	 */
+	frr_each_safe (bgp_peer_adj_in, &peer->adj_in[afi][safi], ain)
+		bgp_adj_in_remove(ain->dest, ain);
 
-			ain = ain_next;
+	frr_each_safe (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		dest = pi->net;
+
+		if (force) {
+			bgp_path_info_reap(dest, pi);
+			continue;
 		}
 
-		for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = next) {
-			next = pi->next;
-			if (pi->peer != peer)
-				continue;
+		if (!bgp_clear_route_first_path(dest, pi))
+			continue;
 
-			if (force)
-				bgp_path_info_reap(dest, pi);
-			else {
-				struct bgp_clear_node_queue *cnq;
-
-				/* both unlocked in bgp_clear_node_queue_del */
-				bgp_table_lock(bgp_dest_table(dest));
-				bgp_dest_lock_node(dest);
-				cnq = XCALLOC(
-					MTYPE_BGP_CLEAR_NODE_QUEUE,
-					sizeof(struct bgp_clear_node_queue));
-				cnq->dest = dest;
-				work_queue_add(peer->clear_node_queue, cnq);
-				break;
-			}
-		}
+		/* both unlocked in bgp_clear_node_queue_del */
+		bgp_table_lock(bgp_dest_table(dest));
+		bgp_dest_lock_node(dest);
+		cnq = XCALLOC(MTYPE_BGP_CLEAR_NODE_QUEUE,
+			      sizeof(struct bgp_clear_node_queue));
+		cnq->dest = dest;
+		work_queue_add(peer->clear_node_queue, cnq);
 	}
-	return;
 }
 
 void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
 {
-	struct bgp_dest *dest;
-	struct bgp_table *table;
-
 	if (peer->clear_node_queue == NULL)
 		bgp_clear_node_queue_init(peer);
 
@@ -5282,17 +5261,7 @@ void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
 	if (!peer->clear_node_queue->thread)
 		peer_lock(peer);
 
-	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN)
-		bgp_clear_route_table(peer, afi, safi, NULL);
-	else
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
-
-			bgp_clear_route_table(peer, afi, safi, table);
-		}
+	bgp_clear_route_peer(peer, afi, safi);
 
 	/* unlock if no nodes got added to the clear-node-queue. */
 	if (!peer->clear_node_queue->thread)
@@ -5314,28 +5283,13 @@ void bgp_clear_route_all(struct peer *peer)
 
 void bgp_clear_adj_in(struct peer *peer, afi_t afi, safi_t safi)
 {
-	struct bgp_table *table;
-	struct bgp_dest *dest;
 	struct bgp_adj_in *ain;
-	struct bgp_adj_in *ain_next;
-
-	table = peer->bgp->rib[afi][safi];
 
 	/* It is possible that we have multiple paths for a prefix from a peer
 	 * if that peer is using AddPath.
 	 */
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		ain = dest->adj_in;
-
-		while (ain) {
-			ain_next = ain->next;
-
-			if (ain->peer == peer)
-				bgp_adj_in_remove(dest, ain);
-
-			ain = ain_next;
-		}
-	}
+	frr_each_safe (bgp_peer_adj_in, &peer->adj_in[afi][safi], ain)
+		bgp_adj_in_remove(ain->dest, ain);
 }
 
 /* If any of the routes from the peer have been marked with the NO_LLGR
@@ -5347,155 +5301,49 @@ void bgp_clear_stale_route(struct peer *peer, afi_t afi, safi_t safi)
 {
 	struct bgp_dest *dest;
 	struct bgp_path_info *pi;
-	struct bgp_table *table;
 
-	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			struct bgp_dest *rm;
+	frr_each_safe (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		if (CHECK_FLAG(peer->af_sflags[afi][safi],
+			       PEER_STATUS_LLGR_WAIT) &&
+		    bgp_attr_get_community(pi->attr) &&
+		    !community_include(bgp_attr_get_community(pi->attr),
+				       COMMUNITY_NO_LLGR))
+			continue;
+		if (!CHECK_FLAG(pi->flags, BGP_PATH_STALE))
+			continue;
 
-			/* look for neighbor in tables */
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
+		dest = pi->net;
 
-			for (rm = bgp_table_top(table); rm;
-			     rm = bgp_route_next(rm))
-				for (pi = bgp_dest_get_bgp_path_info(rm); pi;
-				     pi = pi->next) {
-					if (pi->peer != peer)
-						continue;
-					if (CHECK_FLAG(
-						    peer->af_sflags[afi][safi],
-						    PEER_STATUS_LLGR_WAIT) &&
-					    bgp_attr_get_community(pi->attr) &&
-					    !community_include(
-						    bgp_attr_get_community(
-							    pi->attr),
-						    COMMUNITY_NO_LLGR))
-						continue;
-					if (!CHECK_FLAG(pi->flags,
-							BGP_PATH_STALE))
-						continue;
+		if (safi == SAFI_UNICAST &&
+		    (peer->bgp->inst_type == BGP_INSTANCE_TYPE_VRF ||
+		     peer->bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT))
+			vpn_leak_from_vrf_withdraw(bgp_get_default(),
+						   peer->bgp, pi);
 
-					/*
-					 * If this is VRF leaked route
-					 * process for withdraw.
-					 */
-					if (pi->sub_type ==
-						    BGP_ROUTE_IMPORTED &&
-					    peer->bgp->inst_type ==
-						    BGP_INSTANCE_TYPE_DEFAULT)
-						vpn_leak_to_vrf_withdraw(
-							peer->bgp, pi);
-
-					bgp_rib_remove(rm, pi, peer, afi, safi);
-					break;
-				}
-		}
-	} else {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest))
-			for (pi = bgp_dest_get_bgp_path_info(dest); pi;
-			     pi = pi->next) {
-				if (pi->peer != peer)
-					continue;
-				if (CHECK_FLAG(peer->af_sflags[afi][safi],
-					       PEER_STATUS_LLGR_WAIT) &&
-				    bgp_attr_get_community(pi->attr) &&
-				    !community_include(
-					    bgp_attr_get_community(pi->attr),
-					    COMMUNITY_NO_LLGR))
-					continue;
-				if (!CHECK_FLAG(pi->flags, BGP_PATH_STALE))
-					continue;
-				if (safi == SAFI_UNICAST &&
-				    (peer->bgp->inst_type ==
-					     BGP_INSTANCE_TYPE_VRF ||
-				     peer->bgp->inst_type ==
-					     BGP_INSTANCE_TYPE_DEFAULT))
-					vpn_leak_from_vrf_withdraw(
-						bgp_get_default(), peer->bgp,
-						pi);
-
-				bgp_rib_remove(dest, pi, peer, afi, safi);
-				break;
-			}
+		bgp_rib_remove(dest, pi, peer, afi, safi);
 	}
 }
 
 void bgp_set_stale_route(struct peer *peer, afi_t afi, safi_t safi)
 {
-	struct bgp_dest *dest, *ndest;
 	struct bgp_path_info *pi;
-	struct bgp_table *table;
-
-	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
 
-			for (ndest = bgp_table_top(table); ndest;
-			     ndest = bgp_route_next(ndest)) {
-				for (pi = bgp_dest_get_bgp_path_info(ndest); pi;
-				     pi = pi->next) {
-					if (pi->peer != peer)
-						continue;
+	if (!CHECK_FLAG(peer->af_sflags[afi][safi],
+			PEER_STATUS_ENHANCED_REFRESH))
+		return;
 
-					if ((CHECK_FLAG(
-						    peer->af_sflags[afi][safi],
-						    PEER_STATUS_ENHANCED_REFRESH))
-					    && !CHECK_FLAG(pi->flags,
-							   BGP_PATH_STALE)
-					    && !CHECK_FLAG(
-						       pi->flags,
-						       BGP_PATH_UNUSEABLE)) {
-						if (bgp_debug_neighbor_events(
-							    peer))
-							zlog_debug(
-								"%s: route-refresh for %s/%s, marking prefix %pFX as stale",
-								peer->host,
-								afi2str(afi),
-								safi2str(safi),
-								bgp_dest_get_prefix(
-									ndest));
-
-						bgp_path_info_set_flag(
-							ndest, pi,
-							BGP_PATH_STALE);
-					}
-				}
-			}
-		}
-	} else {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			for (pi = bgp_dest_get_bgp_path_info(dest); pi;
-			     pi = pi->next) {
-				if (pi->peer != peer)
-					continue;
+	frr_each (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		if (CHECK_FLAG(pi->flags, BGP_PATH_STALE)
+		    || CHECK_FLAG(pi->flags, BGP_PATH_UNUSEABLE))
+			continue;
 
-				if ((CHECK_FLAG(peer->af_sflags[afi][safi],
-						PEER_STATUS_ENHANCED_REFRESH))
-				    && !CHECK_FLAG(pi->flags, BGP_PATH_STALE)
-				    && !CHECK_FLAG(pi->flags,
-						   BGP_PATH_UNUSEABLE)) {
-					if (bgp_debug_neighbor_events(peer))
-						zlog_debug(
-							"%s: route-refresh for %s/%s, marking prefix %pFX as stale",
-							peer->host,
-							afi2str(afi),
-							safi2str(safi),
-							bgp_dest_get_prefix(
-								dest));
+		if (bgp_debug_neighbor_events(peer))
+			zlog_debug(
+				"%s: route-refresh for %s/%s, marking prefix %pFX as stale",
+				peer->host, afi2str(afi), safi2str(safi),
+				bgp_dest_get_prefix(pi->net));
 
-					bgp_path_info_set_flag(dest, pi,
-							       BGP_PATH_STALE);
-				}
-			}
-		}
+		bgp_path_info_set_flag(pi->net, pi, BGP_PATH_STALE);
 	}
 }
 
@@ -10127,14 +9975,12 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 		else
 			vty_out(vty, " (inaccessible)");
 	} else {
-		if (path->extra && path->extra->igpmetric) {
+		if (path->igpmetric) {
 			if (json_paths)
 				json_object_int_add(json_nexthop_global,
-						    "metric",
-						    path->extra->igpmetric);
+						    "metric", path->igpmetric);
 			else
-				vty_out(vty, " (metric %u)",
-					path->extra->igpmetric);
+				vty_out(vty, " (metric %u)", path->igpmetric);
 		}
 
 		/* IGP cost is 0, display this only for json */
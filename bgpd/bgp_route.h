@@ -169,9 +169,6 @@ struct bgp_path_info_extra {
 	/** List of aggregations that suppress this path. */
 	struct list *aggr_suppressors;
 
-	/* Nexthop reachability check.  */
-	uint32_t igpmetric;
-
 	/* MPLS label(s) - VNI(s) for EVPN-VxLAN  */
 	mpls_label_t label[BGP_MAX_LABELS];
 	uint32_t num_labels;
@@ -248,20 +245,17 @@ struct bgp_path_info_extra {
 	struct bgp_path_mh_info *mh_info;
 };
 
+/*
+ * There is one of these per received path, so the layout matters: the
+ * fields read by bgp_path_info_cmp() are grouped in the first cache line,
+ * and the IGP metric is kept inline so that paths with a resolved nexthop
+ * do not need a bgp_path_info_extra just to carry it.
+ */
 struct bgp_path_info {
 	/* For linked list. */
 	struct bgp_path_info *next;
 	struct bgp_path_info *prev;
 
-	/* For nexthop linked list */
-	LIST_ENTRY(bgp_path_info) nh_thread;
-
-	/* Back pointer to the prefix node */
-	struct bgp_dest *net;
-
-	/* Back pointer to the nexthop structure */
-	struct bgp_nexthop_cache *nexthop;
-
 	/* Peer structure.  */
 	struct peer *peer;
 
@@ -271,16 +265,9 @@ struct bgp_path_info {
 	/* Extra information */
 	struct bgp_path_info_extra *extra;
 
-
 	/* Multipath information */
 	struct bgp_path_info_mpath *mpath;
 
-	/* Uptime.  */
-	time_t uptime;
-
-	/* reference count */
-	int lock;
-
 	/* BGP information status.  */
 	uint16_t flags;
 #define BGP_PATH_IGP_CHANGED (1 << 0)
@@ -317,11 +304,43 @@ struct bgp_path_info {
 
 	unsigned short instance;
 
+	/* Nexthop reachability check.  */
+	uint32_t igpmetric;
+
 	/* Addpath identifiers */
 	uint32_t addpath_rx_id;
+
+	/* Uptime (monotime, seconds).  */
+	uint32_t uptime;
+
+	/* reference count */
+	int lock;
+
+	/* Back pointer to the prefix node */
+	struct bgp_dest *net;
+
+	/* Back pointer to the nexthop structure */
+	struct bgp_nexthop_cache *nexthop;
+
+	/* For nexthop linked list */
+	LIST_ENTRY(bgp_path_info) nh_thread;
+
+	/* For the list of paths from the same peer */
+	struct bgp_peer_paths_item peer_item;
+
 	struct bgp_addpath_info_data tx_addpath;
 };
 
+DECLARE_DLIST(bgp_peer_paths, struct bgp_path_info, peer_item);
+
+/* Imported copies (VRF, VNI and ES tables) are cleaned up through their
+ * parent path, so only a peer's own paths are kept on its list.
+ */
+static inline bool bgp_path_info_peer_indexed(const struct bgp_path_info *pi)
+{
+	return pi->sub_type != BGP_ROUTE_IMPORTED;
+}
+
 /* Structure used in BGP path selection */
 struct bgp_path_info_pair {
 	struct bgp_path_info *old;
@@ -622,6 +641,13 @@ DECLARE_HOOK(bgp_process,
 	      struct peer *peer, bool withdraw),
 	     (bgp, afi, safi, bn, peer, withdraw));
 
+/* called from bgp_process_main_one() when the selected path changed */
+DECLARE_HOOK(bgp_route_update,
+	     (struct bgp * bgp, afi_t afi, safi_t safi, struct bgp_dest *bn,
+	      struct bgp_path_info *old_route,
+	      struct bgp_path_info *new_route),
+	     (bgp, afi, safi, bn, old_route, new_route));
+
 /* BGP show options */
 #define BGP_SHOW_OPT_JSON (1 << 0)
 #define BGP_SHOW_OPT_WIDE (1 << 1)
@@ -776,7 +802,6 @@ extern void route_vty_out_overlay(struct vty *vty, const struct prefix *p,
 				  struct bgp_path_info *path, int display,
 				  json_object *json);
 
-extern void bgp_notify_conditional_adv_scanner(struct update_subgroup *subgrp);
 
 extern void subgroup_process_announce_selected(struct update_subgroup *subgrp,
 					       struct bgp_path_info *selected,
@@ -53,7 +53,8 @@ struct bgp_table {
 	uint64_t version;
 };
 
-enum bgp_path_selection_reason {
+/* Stored in every bgp_dest, hence packed down to a single byte. */
+enum __attribute__((packed)) bgp_path_selection_reason {
 	bgp_path_selection_none,
 	bgp_path_selection_first,
 	bgp_path_selection_evpn_sticky_mac,
@@ -114,9 +115,9 @@ struct bgp_node {
 #define BGP_NODE_LABEL_REQUESTED        (1 << 7)
 #define BGP_NODE_SOFT_RECONFIG (1 << 8)
 
-	struct bgp_addpath_node_data tx_addpath;
-
 	enum bgp_path_selection_reason reason;
+
+	struct bgp_addpath_node_data tx_addpath;
 };
 
 extern void bgp_delete_listnode(struct bgp_dest *dest);
@@ -114,6 +114,11 @@ static void sync_init(struct update_subgroup *subgrp,
 
 static void sync_delete(struct update_subgroup *subgrp)
 {
+	subgroup_attr_cache_flush(subgrp);
+	if (subgrp->attr_cache.s)
+		stream_free(subgrp->attr_cache.s);
+	subgrp->attr_cache.s = NULL;
+
 	XFREE(MTYPE_BGP_SYNCHRONISE, subgrp->sync);
 	if (subgrp->hash)
 		hash_free(subgrp->hash);
@@ -656,6 +661,9 @@ static int update_group_show_walkcb(struct update_group *updgrp, void *arg)
 		vty_out(vty, "    Coalesce Time: %u%s\n",
 			(UPDGRP_INST(subgrp->update_group))->coalesce_time,
 			subgrp->t_coalesce ? "(Running)" : "");
+		if (subgrp->t_announce_table)
+			vty_out(vty, "    Table walk in progress at %pBD\n",
+				subgrp->announce_dest);
 		vty_out(vty, "    Version: %" PRIu64 "\n", subgrp->version);
 		vty_out(vty, "    Packet queue length: %d\n",
 			bpacket_queue_length(SUBGRP_PKTQ(subgrp)));
@@ -840,6 +848,7 @@ static void update_subgroup_delete(struct update_subgroup *subgrp)
 
 	THREAD_OFF(subgrp->t_merge_check);
 	THREAD_OFF(subgrp->t_coalesce);
+	subgroup_announce_table_cancel(subgrp);
 
 	bpacket_queue_cleanup(SUBGRP_PKTQ(subgrp));
 	subgroup_clear_table(subgrp);
@@ -1075,6 +1084,13 @@ static int update_subgroup_can_merge_into(struct update_subgroup *subgrp,
 	if (subgrp->adj_count != target->adj_count)
 		return 0;
 
+	/*
+	 * A subgroup part way through a table walk has not caught up yet,
+	 * whatever its version says.
+	 */
+	if (subgrp->t_announce_table || target->t_announce_table)
+		return 0;
+
 	return update_subgroup_ready_for_merge(target);
 }
 
@@ -27,6 +27,8 @@
 #ifndef _QUAGGA_BGP_UPDGRP_H
 #define _QUAGGA_BGP_UPDGRP_H
 
+#include "hook.h"
+
 #include "bgp_advertise.h"
 
 /*
@@ -51,6 +53,9 @@
 #define BGP_MAX_SUBGROUP_COALESCE_TIME 10000
 #define BGP_PEER_ADJUST_SUBGROUP_COALESCE_TIME 50
 
+/* Prefixes walked per event when announcing a full table to a subgroup */
+#define BGP_ANNOUNCE_TABLE_QUANTUM 10000
+
 #define PEER_UPDGRP_FLAGS                                                      \
 	(PEER_FLAG_LOCAL_AS_NO_PREPEND | PEER_FLAG_LOCAL_AS_REPLACE_AS)
 
@@ -210,9 +215,27 @@ struct update_subgroup {
 	/* announcement attribute hash */
 	struct hash *hash;
 
+	/*
+	 * Path attributes as encoded for the last UPDATE built, so they can
+	 * be copied rather than re-encoded while the following packets carry
+	 * the same attribute.  See subgroup_packet_attribute().
+	 */
+	struct {
+		struct attr *attr;
+		struct peer *from;
+		struct in_addr from_id;
+		size_t pos;
+		struct stream *s;
+		struct bpacket_attr_vec_arr vecarr;
+	} attr_cache;
+
 	struct thread *t_coalesce;
 	uint32_t v_coalesce;
 
+	/* Resumable full table walk, see subgroup_announce_table_walk() */
+	struct thread *t_announce_table;
+	struct bgp_dest *announce_dest;
+
 	struct thread *t_merge_check;
 
 	/* table version that the subgroup has caught up to. */
@@ -454,9 +477,18 @@ extern void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 extern void bgp_adj_out_unset_subgroup(struct bgp_dest *dest,
 				       struct update_subgroup *subgrp,
 				       char withdraw, uint32_t addpath_tx_id);
+
+/* called when a subgroup's advertisement for dest was queued or withdrawn */
+DECLARE_HOOK(bgp_adj_out_updated,
+	     (struct update_subgroup *subgrp, struct bgp_dest *dest),
+	     (subgrp, dest));
+
 void subgroup_announce_table(struct update_subgroup *subgrp,
 			     struct bgp_table *table);
+extern void subgroup_announce_table_resume(struct thread *thread);
+extern void subgroup_announce_table_cancel(struct update_subgroup *subgrp);
 extern void subgroup_trigger_write(struct update_subgroup *subgrp);
+extern void subgroup_attr_cache_flush(struct update_subgroup *subgrp);
 
 extern int update_group_clear_update_dbg(struct update_group *updgrp,
 					 void *arg);
@@ -51,6 +51,10 @@
 #include "bgpd/bgp_advertise.h"
 #include "bgpd/bgp_addpath.h"
 
+DEFINE_HOOK(bgp_adj_out_updated,
+	    (struct update_subgroup *subgrp, struct bgp_dest *dest),
+	    (subgrp, dest));
+
 
 /********************
  * PRIVATE FUNCTIONS
@@ -219,9 +223,6 @@ static int group_announce_route_walkcb(struct update_group *updgrp, void *arg)
 				}
 			}
 		}
-
-		/* Notify BGP Conditional advertisement */
-		bgp_notify_conditional_adv_scanner(subgrp);
 	}
 
 	return UPDWALK_CONTINUE;
@@ -452,6 +453,24 @@ bgp_advertise_clean_subgroup(struct update_subgroup *subgrp,
 	return next;
 }
 
+/*
+ * Has the resumable table walk in progress (see
+ * subgroup_announce_table_walk()) yet to reach dest?  The adj-outs of such
+ * a dest are not in pscount: the walk counts them when it gets there.
+ */
+static bool subgroup_announce_table_ahead(struct update_subgroup *subgrp,
+					  struct bgp_dest *dest)
+{
+	struct bgp_dest *cursor = subgrp->announce_dest;
+
+	if (!cursor || bgp_dest_table(dest) != bgp_dest_table(cursor))
+		return false;
+
+	return route_table_prefix_iter_cmp(bgp_dest_get_prefix(dest),
+					   bgp_dest_get_prefix(cursor))
+	       >= 0;
+}
+
 void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 			      struct update_subgroup *subgrp, struct attr *attr,
 			      struct bgp_path_info *path)
@@ -490,7 +509,9 @@ void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 		if (!adj)
 			return;
 
-		subgrp->pscount++;
+		if (CHECK_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING)
+		    || !subgroup_announce_table_ahead(subgrp, dest))
+			subgrp->pscount++;
 	}
 
 	/* Check if we are sending the same route. This is needed to
@@ -557,6 +578,8 @@ void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 	bgp_adv_fifo_add_tail(&subgrp->sync->update, adv);
 
 	subgrp->version = MAX(subgrp->version, dest->version);
+
+	hook_call(bgp_adj_out_updated, subgrp, dest);
 }
 
 /* The only time 'withdraw' will be false is if we are sending
@@ -610,8 +633,11 @@ void bgp_adj_out_unset_subgroup(struct bgp_dest *dest,
 			/* Free allocated information.  */
 			adj_free(adj);
 		}
-		if (!CHECK_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING))
+		if (!CHECK_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING)
+		    && !subgroup_announce_table_ahead(subgrp, dest))
 			subgrp->pscount--;
+
+		hook_call(bgp_adj_out_updated, subgrp, dest);
 	}
 
 	subgrp->version = MAX(subgrp->version, dest->version);
@@ -642,32 +668,95 @@ void subgroup_clear_table(struct update_subgroup *subgrp)
 }
 
 /*
- * subgroup_announce_table
+ * subgroup_announce_table_dest
+ *
+ * Announce or withdraw the selected path(s) of a single prefix to the
+ * subgroup as part of a full table walk.
  */
-void subgroup_announce_table(struct update_subgroup *subgrp,
-			     struct bgp_table *table)
+static void subgroup_announce_table_dest(struct update_subgroup *subgrp,
+					 struct bgp_dest *dest, afi_t afi,
+					 safi_t safi, bool addpath_capable)
 {
-	struct bgp_dest *dest;
 	struct bgp_path_info *ri;
 	struct attr attr;
 	struct peer *peer;
-	afi_t afi;
-	safi_t safi;
-	bool addpath_capable;
 	struct bgp *bgp;
 	bool advertise;
+	const struct prefix *dest_p = bgp_dest_get_prefix(dest);
 
 	peer = SUBGRP_PEER(subgrp);
-	afi = SUBGRP_AFI(subgrp);
-	safi = SUBGRP_SAFI(subgrp);
 	bgp = SUBGRP_INST(subgrp);
-	addpath_capable = bgp_addpath_encode_tx(peer, afi, safi);
 
-	if (safi == SAFI_LABELED_UNICAST)
-		safi = SAFI_UNICAST;
+	/* Check if the route can be advertised */
+	advertise = bgp_check_advertise(bgp, dest);
 
-	if (!table)
-		table = peer->bgp->rib[afi][safi];
+	for (ri = bgp_dest_get_bgp_path_info(dest); ri; ri = ri->next)
+
+		if (bgp_check_selected(ri, peer, addpath_capable, afi, safi)) {
+			if (subgroup_announce_check(dest, ri, subgrp, dest_p,
+						    &attr, NULL)) {
+				/* Check if route can be advertised */
+				if (advertise) {
+					if (!bgp_check_withdrawal(bgp, dest))
+						bgp_adj_out_set_subgroup(
+							dest, subgrp, &attr,
+							ri);
+					else
+						bgp_adj_out_unset_subgroup(
+							dest, subgrp, 1,
+							bgp_addpath_id_for_peer(
+								peer, afi, safi,
+								&ri->tx_addpath));
+				}
+			} else {
+				/* If default originate is enabled for
+				 * the peer, do not send explicit
+				 * withdraw. This will prevent deletion
+				 * of default route advertised through
+				 * default originate
+				 */
+				if (CHECK_FLAG(peer->af_flags[afi][safi],
+					       PEER_FLAG_DEFAULT_ORIGINATE)
+				    && is_default_prefix(dest_p))
+					break;
+
+				bgp_adj_out_unset_subgroup(
+					dest, subgrp, 1,
+					bgp_addpath_id_for_peer(
+						peer, afi, safi,
+						&ri->tx_addpath));
+			}
+		}
+}
+
+/*
+ * subgroup_announce_table_afi_safi
+ *
+ * AFI/SAFI a table walk for the subgroup runs under (labeled-unicast
+ * shares the unicast table).
+ */
+static void subgroup_announce_table_afi_safi(struct update_subgroup *subgrp,
+					     afi_t *afi, safi_t *safi)
+{
+	*afi = SUBGRP_AFI(subgrp);
+	*safi = SUBGRP_SAFI(subgrp);
+
+	if (*safi == SAFI_LABELED_UNICAST)
+		*safi = SAFI_UNICAST;
+}
+
+/*
+ * subgroup_announce_table_begin
+ *
+ * Set up the subgroup for a full walk of the table.
+ */
+static void subgroup_announce_table_begin(struct update_subgroup *subgrp)
+{
+	struct peer *peer = SUBGRP_PEER(subgrp);
+	afi_t afi;
+	safi_t safi;
+
+	subgroup_announce_table_afi_safi(subgrp, &afi, &safi);
 
 	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN
 	    && CHECK_FLAG(peer->af_flags[afi][safi],
@@ -675,60 +764,16 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 		subgroup_default_originate(subgrp, 0);
 
 	subgrp->pscount = 0;
-	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
-
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		const struct prefix *dest_p = bgp_dest_get_prefix(dest);
-
-		/* Check if the route can be advertised */
-		advertise = bgp_check_advertise(bgp, dest);
-
-		for (ri = bgp_dest_get_bgp_path_info(dest); ri; ri = ri->next)
-
-			if (bgp_check_selected(ri, peer, addpath_capable, afi,
-					       safi)) {
-				if (subgroup_announce_check(dest, ri, subgrp,
-							    dest_p, &attr,
-							    NULL)) {
-					/* Check if route can be advertised */
-					if (advertise) {
-						if (!bgp_check_withdrawal(bgp,
-									  dest))
-							bgp_adj_out_set_subgroup(
-								dest, subgrp,
-								&attr, ri);
-						else
-							bgp_adj_out_unset_subgroup(
-								dest, subgrp, 1,
-								bgp_addpath_id_for_peer(
-									peer,
-									afi,
-									safi,
-									&ri->tx_addpath));
-					}
-				} else {
-					/* If default originate is enabled for
-					 * the peer, do not send explicit
-					 * withdraw. This will prevent deletion
-					 * of default route advertised through
-					 * default originate
-					 */
-					if (CHECK_FLAG(
-						    peer->af_flags[afi][safi],
-						    PEER_FLAG_DEFAULT_ORIGINATE)
-					    && is_default_prefix(bgp_dest_get_prefix(dest)))
-						break;
-
-					bgp_adj_out_unset_subgroup(
-						dest, subgrp, 1,
-						bgp_addpath_id_for_peer(
-							peer, afi, safi,
-							&ri->tx_addpath));
-				}
-			}
-	}
-	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+}
 
+/*
+ * subgroup_announce_table_end
+ *
+ * Wrap up once a full walk of the table has completed.
+ */
+static void subgroup_announce_table_end(struct update_subgroup *subgrp,
+					struct bgp_table *table)
+{
 	/*
 	 * We walked through the whole table -- make sure our version number
 	 * is consistent with the one on the table. This should allow
@@ -745,6 +790,141 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 	update_subgroup_trigger_merge_check(subgrp, 0);
 }
 
+/*
+ * subgroup_announce_table
+ *
+ * Walk the whole table in one go.  A resumable walk still in progress
+ * (e.g. one carried over by update_subgroup_split_peer()) is dropped first:
+ * it would otherwise count the prefixes past its cursor a second time.
+ */
+void subgroup_announce_table(struct update_subgroup *subgrp,
+			     struct bgp_table *table)
+{
+	struct bgp_dest *dest;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+	bool addpath_capable;
+
+	peer = SUBGRP_PEER(subgrp);
+	addpath_capable = bgp_addpath_encode_tx(peer, SUBGRP_AFI(subgrp),
+						SUBGRP_SAFI(subgrp));
+	subgroup_announce_table_afi_safi(subgrp, &afi, &safi);
+
+	if (!table)
+		table = peer->bgp->rib[afi][safi];
+
+	subgroup_announce_table_cancel(subgrp);
+	subgroup_announce_table_begin(subgrp);
+
+	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest))
+		subgroup_announce_table_dest(subgrp, dest, afi, safi,
+					     addpath_capable);
+	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+
+	subgroup_announce_table_end(subgrp, table);
+}
+
+/*
+ * subgroup_announce_table_walk
+ *
+ * Process up to BGP_ANNOUNCE_TABLE_QUANTUM prefixes of a resumable table
+ * walk, starting at subgrp->announce_dest.  If the table is not done yet,
+ * the walk is continued from a new event so that keepalives, other
+ * subgroups' walks and UPDATE generation for the prefixes already walked
+ * (which the I/O pthread can start writing out) get to run in between.
+ */
+static void subgroup_announce_table_walk(struct update_subgroup *subgrp)
+{
+	struct bgp_dest *dest = subgrp->announce_dest;
+	struct bgp_table *table = bgp_dest_table(dest);
+	afi_t afi;
+	safi_t safi;
+	bool addpath_capable;
+	unsigned int count = 0;
+
+	addpath_capable = bgp_addpath_encode_tx(
+		SUBGRP_PEER(subgrp), SUBGRP_AFI(subgrp), SUBGRP_SAFI(subgrp));
+	subgroup_announce_table_afi_safi(subgrp, &afi, &safi);
+
+	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+	for (; dest && count < BGP_ANNOUNCE_TABLE_QUANTUM;
+	     dest = bgp_route_next(dest), count++)
+		subgroup_announce_table_dest(subgrp, dest, afi, safi,
+					     addpath_capable);
+	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+
+	/* The lock taken by bgp_route_next() keeps dest in the table. */
+	subgrp->announce_dest = dest;
+	if (dest) {
+		thread_add_event(bm->master, subgroup_announce_table_resume,
+				 subgrp, 0, &subgrp->t_announce_table);
+		return;
+	}
+
+	subgroup_announce_table_end(subgrp, table);
+
+	/* Packets may be ready and an EOR may be due now the walk is done. */
+	subgroup_trigger_write(subgrp);
+}
+
+void subgroup_announce_table_resume(struct thread *thread)
+{
+	struct update_subgroup *subgrp = THREAD_ARG(thread);
+
+	if (bgp_debug_update(NULL, NULL, subgrp->update_group, 0))
+		zlog_debug("u%" PRIu64 ":s%" PRIu64
+			   " resuming table walk at %pBD",
+			   SUBGRP_UPDGRP(subgrp)->id, subgrp->id,
+			   subgrp->announce_dest);
+
+	subgroup_announce_table_walk(subgrp);
+}
+
+/*
+ * subgroup_announce_table_cancel
+ *
+ * Stop a resumable table walk that is in progress, if any.
+ */
+void subgroup_announce_table_cancel(struct update_subgroup *subgrp)
+{
+	THREAD_OFF(subgrp->t_announce_table);
+
+	if (subgrp->announce_dest) {
+		bgp_dest_unlock_node(subgrp->announce_dest);
+		subgrp->announce_dest = NULL;
+	}
+}
+
+/*
+ * subgroup_announce_table_start
+ *
+ * Start a resumable walk of the subgroup's table, restarting from the top
+ * if one was already in progress.
+ */
+static void subgroup_announce_table_start(struct update_subgroup *subgrp)
+{
+	struct bgp_table *table;
+	afi_t afi;
+	safi_t safi;
+
+	subgroup_announce_table_cancel(subgrp);
+
+	subgroup_announce_table_afi_safi(subgrp, &afi, &safi);
+	table = SUBGRP_INST(subgrp)->rib[afi][safi];
+
+	subgroup_announce_table_begin(subgrp);
+
+	subgrp->announce_dest = bgp_table_top(table);
+	if (!subgrp->announce_dest) {
+		subgroup_announce_table_end(subgrp, table);
+		return;
+	}
+
+	subgroup_announce_table_walk(subgrp);
+}
+
 /*
  * subgroup_announce_route
  *
@@ -760,6 +940,9 @@ void subgroup_announce_route(struct update_subgroup *subgrp)
 		update_subgroup_set_needs_refresh(subgrp, 0);
 	}
 
+	/* Policy or config that feeds the attribute encoding may have changed */
+	subgroup_attr_cache_flush(subgrp);
+
 	/*
 	 * First update is deferred until ORF or ROUTE-REFRESH is received
 	 */
@@ -773,7 +956,7 @@ void subgroup_announce_route(struct update_subgroup *subgrp)
 	if (SUBGRP_SAFI(subgrp) != SAFI_MPLS_VPN
 	    && SUBGRP_SAFI(subgrp) != SAFI_ENCAP
 	    && SUBGRP_SAFI(subgrp) != SAFI_EVPN)
-		subgroup_announce_table(subgrp, NULL);
+		subgroup_announce_table_start(subgrp);
 	else
 		for (dest = bgp_table_top(update_subgroup_rib(subgrp)); dest;
 		     dest = bgp_route_next(dest)) {
@@ -627,6 +627,72 @@ static void bpacket_attr_vec_arr_update(struct bpacket_attr_vec_arr *vecarr,
 		vecarr->entries[i].offset += pos;
 }
 
+/*
+ * subgroup_attr_cache_flush
+ *
+ * Forget the cached attribute encoding, e.g. because outbound policy or
+ * configuration that affects the encoding may have changed.
+ */
+void subgroup_attr_cache_flush(struct update_subgroup *subgrp)
+{
+	if (subgrp->attr_cache.attr)
+		bgp_attr_unintern(&subgrp->attr_cache.attr);
+	subgrp->attr_cache.from = NULL;
+}
+
+/*
+ * subgroup_packet_attribute
+ *
+ * Encode the path attributes (except MP_REACH_NLRI) for an UPDATE being
+ * built for the subgroup.  A prefix list sharing one attribute usually
+ * spans several packets, so the encoding of the previous packet is kept
+ * and copied if the next one starts with the same attribute from the same
+ * peer at the same offset.  The cache holds a reference on the attribute,
+ * so the pointer comparison cannot be fooled by a freed and reallocated
+ * attr.
+ */
+static bgp_size_t subgroup_packet_attribute(struct update_subgroup *subgrp,
+					    struct peer *peer,
+					    struct stream *s, struct attr *attr,
+					    struct bpacket_attr_vec_arr *vecarr,
+					    afi_t afi, safi_t safi,
+					    struct peer *from)
+{
+	size_t pos = stream_get_endp(s);
+	bgp_size_t len;
+
+	if (subgrp->attr_cache.attr == attr && subgrp->attr_cache.from == from
+	    && subgrp->attr_cache.pos == pos
+	    && (!from
+		|| IPV4_ADDR_SAME(&subgrp->attr_cache.from_id,
+				  &from->remote_id))) {
+		len = stream_get_endp(subgrp->attr_cache.s);
+		stream_put(s, STREAM_DATA(subgrp->attr_cache.s), len);
+		*vecarr = subgrp->attr_cache.vecarr;
+		return len;
+	}
+
+	len = bgp_packet_attribute(NULL, peer, s, attr, vecarr, NULL, afi,
+				   safi, from, NULL, NULL, 0, 0, 0);
+
+	subgroup_attr_cache_flush(subgrp);
+	if (!subgrp->attr_cache.s)
+		subgrp->attr_cache.s = stream_new(STREAM_SIZE(s));
+	if (len > STREAM_SIZE(subgrp->attr_cache.s))
+		return len;
+
+	stream_reset(subgrp->attr_cache.s);
+	stream_put(subgrp->attr_cache.s, STREAM_DATA(s) + pos, len);
+	subgrp->attr_cache.attr = bgp_attr_intern(attr);
+	subgrp->attr_cache.from = from;
+	if (from)
+		subgrp->attr_cache.from_id = from->remote_id;
+	subgrp->attr_cache.pos = pos;
+	subgrp->attr_cache.vecarr = *vecarr;
+
+	return len;
+}
+
 /*
  * Return if there are packets to build for this subgroup.
  */
@@ -750,9 +816,9 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 
 			/* 5: Encode all the attributes, except MP_REACH_NLRI
 			 * attr. */
-			total_attr_len = bgp_packet_attribute(
-				NULL, peer, s, adv->baa->attr, &vecarr, NULL,
-				afi, safi, from, NULL, NULL, 0, 0, 0);
+			total_attr_len = subgroup_packet_attribute(
+				subgrp, peer, s, adv->baa->attr, &vecarr, afi,
+				safi, from);
 
 			space_remaining =
 				STREAM_CONCAT_REMAIN(s, snlri, STREAM_SIZE(s))
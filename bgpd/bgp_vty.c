@@ -8745,6 +8745,8 @@ DEFPY (af_rt_vpn_imexport,
 						&bgp->vpn_policy[afi].rtlist[dir]);
 			bgp->vpn_policy[afi].rtlist[dir] = NULL;
 		}
+		if (dir == BGP_VPN_POLICY_DIR_FROMVPN)
+			vpn_leak_import_rt_index_invalidate();
 
 		vpn_leak_postchange(dir, afi, bgp_get_default(), bgp);
 	}
@@ -9874,7 +9876,7 @@ DEFUN (show_bgp_memory,
        "Global BGP memory statistics\n")
 {
 	char memstrbuf[MTYPE_MEMSTR_LEN];
-	unsigned long count;
+	unsigned long count, extra_count;
 
 	/* RIB related usage stats */
 	count = mtype_stats_alloc(MTYPE_BGP_NODE);
@@ -9886,12 +9888,22 @@ DEFUN (show_bgp_memory,
 	vty_out(vty, "%ld BGP routes, using %s of memory\n", count,
 		mtype_memstr(memstrbuf, sizeof(memstrbuf),
 			     count * sizeof(struct bgp_path_info)));
-	if ((count = mtype_stats_alloc(MTYPE_BGP_ROUTE_EXTRA)))
+	if ((extra_count = mtype_stats_alloc(MTYPE_BGP_ROUTE_EXTRA)))
 		vty_out(vty, "%ld BGP route ancillaries, using %s of memory\n",
-			count,
+			extra_count,
 			mtype_memstr(
 				memstrbuf, sizeof(memstrbuf),
-				count * sizeof(struct bgp_path_info_extra)));
+				extra_count
+					* sizeof(struct bgp_path_info_extra)));
+	if (count)
+		vty_out(vty,
+			"%zu bytes per BGP route (%zu with ancillary), %lu bytes per route on average\n",
+			sizeof(struct bgp_path_info),
+			sizeof(struct bgp_path_info)
+				+ sizeof(struct bgp_path_info_extra),
+			(count * sizeof(struct bgp_path_info)
+			 + extra_count * sizeof(struct bgp_path_info_extra))
+				/ count);
 
 	if ((count = mtype_stats_alloc(MTYPE_BGP_STATIC)))
 		vty_out(vty, "%ld Static routes, using %s of memory\n", count,
@@ -1136,6 +1136,10 @@ static void peer_free(struct peer *peer)
 		if (peer->filter[afi][safi].advmap.cname)
 			XFREE(MTYPE_BGP_FILTER_NAME,
 			      peer->filter[afi][safi].advmap.cname);
+
+		/* paths and adj-in entries hold a peer reference */
+		bgp_peer_paths_fini(&peer->paths[afi][safi]);
+		bgp_peer_adj_in_fini(&peer->adj_in[afi][safi]);
 	}
 
 	XFREE(MTYPE_PEER_TX_SHUTDOWN_MSG, peer->tx_shutdown_message);
@@ -1374,6 +1378,9 @@ struct peer *peer_new(struct bgp *bgp)
 		SET_FLAG(peer->af_flags_invert[afi][safi],
 			 PEER_FLAG_SEND_LARGE_COMMUNITY);
 		peer->addpath_type[afi][safi] = BGP_ADDPATH_NONE;
+
+		bgp_peer_paths_init(&peer->paths[afi][safi]);
+		bgp_peer_adj_in_init(&peer->adj_in[afi][safi]);
 	}
 
 	/* set nexthop-unchanged for l2vpn evpn by default */
@@ -3454,6 +3461,7 @@ int bgp_get(struct bgp **bgp_val, as_t *as, const char *name,
 	 */
 	bgp_handle_socket(bgp, vrf, VRF_UNKNOWN, true);
 	listnode_add(bm->bgp, bgp);
+	vpn_leak_import_rt_index_invalidate();
 
 	if (IS_BGP_INST_KNOWN_TO_ZEBRA(bgp)) {
 		if (BGP_DEBUG(zebra, ZEBRA))
@@ -3596,6 +3604,7 @@ int bgp_delete(struct bgp *bgp)
 	THREAD_OFF(bgp->t_maxmed_onstartup);
 	THREAD_OFF(bgp->t_update_delay);
 	THREAD_OFF(bgp->t_establish_wait);
+	bgp_conditional_adv_cleanup(bgp);
 
 	/* Set flag indicating bgp instance delete in progress */
 	SET_FLAG(bgp->flags, BGP_FLAG_DELETE_IN_PROGRESS);
@@ -3703,6 +3712,7 @@ int bgp_delete(struct bgp *bgp)
 	 * routes to be processed still referencing the struct bgp.
 	 */
 	listnode_delete(bm->bgp, bgp);
+	vpn_leak_import_rt_index_invalidate();
 
 	/* Free interfaces in this instance. */
 	bgp_if_finish(bgp);
@@ -7921,11 +7931,13 @@ static const struct cmd_variable_handler bgp_viewvrf_var_handlers[] = {
 
 struct frr_pthread *bgp_pth_io;
 struct frr_pthread *bgp_pth_ka;
+struct frr_pthread *bgp_pth_dump;
 
 static void bgp_pthreads_init(void)
 {
 	assert(!bgp_pth_io);
 	assert(!bgp_pth_ka);
+	assert(!bgp_pth_dump);
 
 	struct frr_pthread_attr io = {
 		.start = frr_pthread_attr_default.start,
@@ -7935,18 +7947,26 @@ static void bgp_pthreads_init(void)
 		.start = bgp_keepalives_start,
 		.stop = bgp_keepalives_stop,
 	};
+	struct frr_pthread_attr dump = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
 	bgp_pth_io = frr_pthread_new(&io, "BGP I/O thread", "bgpd_io");
 	bgp_pth_ka = frr_pthread_new(&ka, "BGP Keepalives thread", "bgpd_ka");
+	bgp_pth_dump = frr_pthread_new(&dump, "BGP MRT dump thread",
+				       "bgpd_dump");
 }
 
 void bgp_pthreads_run(void)
 {
 	frr_pthread_run(bgp_pth_io, NULL);
 	frr_pthread_run(bgp_pth_ka, NULL);
+	frr_pthread_run(bgp_pth_dump, NULL);
 
 	/* Wait until threads are ready. */
 	frr_pthread_wait_running(bgp_pth_io);
 	frr_pthread_wait_running(bgp_pth_ka);
+	frr_pthread_wait_running(bgp_pth_dump);
 }
 
 void bgp_pthreads_finish(void)
@@ -25,6 +25,7 @@
 #include <pthread.h>
 
 #include "hook.h"
+#include "typesafe.h"
 #include "frr_pthread.h"
 #include "lib/json.h"
 #include "vrf.h"
@@ -43,6 +44,13 @@
 #include "vxlan.h"
 #include "bgp_labelpool.h"
 #include "bgp_addpath_types.h"
+
+/* Per-peer indices of received paths and adj-in entries; struct peer holds
+ * the heads, the items live in bgp_path_info and bgp_adj_in.
+ */
+PREDECL_DLIST(bgp_peer_paths);
+PREDECL_DLIST(bgp_peer_adj_in);
+
 #include "bgp_nexthop.h"
 #include "bgp_io.h"
 
@@ -106,6 +114,7 @@ enum bgp_af_index {
 
 extern struct frr_pthread *bgp_pth_io;
 extern struct frr_pthread *bgp_pth_ka;
+extern struct frr_pthread *bgp_pth_dump;
 
 /* BGP master for system wide configurations and variables.  */
 struct bgp_master {
@@ -153,6 +162,11 @@ struct bgp_master {
 	/* BGP-EVPN VRF ID. Defaults to default VRF (if any) */
 	struct bgp* bgp_evpn;
 
+	/* Route targets imported from VPN -> VRF instances importing them.
+	 * Rebuilt on demand, NULL whenever an import RT list changes.
+	 */
+	struct hash *vpn_import_rt_hash;
+
 	/* How big should we set the socket buffer size */
 	uint32_t socket_buffer;
 
@@ -753,6 +767,7 @@ struct bgp {
 	uint32_t condition_check_period;
 	uint32_t condition_filter_count;
 	struct thread *t_condition_check;
+	struct list *condition_adv_list;
 
 	/* BGP VPN SRv6 backend */
 	bool srv6_enabled;
@@ -1128,9 +1143,6 @@ struct peer {
 	enum bgp_fsm_events last_event;
 	enum bgp_fsm_events last_major_event;
 
-	/* Peer index, used for dumping TABLE_DUMP_V2 format */
-	uint16_t table_dump_index;
-
 	/* Peer information */
 	int fd;		     /* File descriptor */
 	int ttl;	     /* TTL of TCP connection to the peer. */
@@ -1562,6 +1574,12 @@ struct peer {
 	/* Accepted prefix count */
 	uint32_t pcount[AFI_MAX][SAFI_MAX];
 
+	/* All paths and adj-in entries from this peer, so that clearing
+	 * the peer only touches its own routes.
+	 */
+	struct bgp_peer_paths_head paths[AFI_MAX][SAFI_MAX];
+	struct bgp_peer_adj_in_head adj_in[AFI_MAX][SAFI_MAX];
+
 	/* Max prefix count. */
 	uint32_t pmax[AFI_MAX][SAFI_MAX];
 	uint8_t pmax_threshold[AFI_MAX][SAFI_MAX];
@@ -1669,7 +1687,6 @@ struct peer {
 
 	/* Conditional advertisement */
 	bool advmap_config_change[AFI_MAX][SAFI_MAX];
-	bool advmap_table_change;
 
 	/* set TCP max segment size */
 	uint32_t tcp_mss;
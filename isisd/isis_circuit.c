@@ -907,10 +907,8 @@ void isis_circuit_down(struct isis_circuit *circuit)
 	circuit->upadjcount[1] = 0;
 
 	/* close the socket */
-	if (circuit->fd) {
-		close(circuit->fd);
-		circuit->fd = 0;
-	}
+	if (circuit->fd)
+		isis_sock_close(circuit);
 
 	if (circuit->rcv_stream != NULL) {
 		stream_free(circuit->rcv_stream);
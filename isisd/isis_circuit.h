@@ -36,6 +36,7 @@
 DECLARE_HOOK(isis_if_new_hook, (struct interface *ifp), (ifp));
 
 struct isis_lsp;
+struct isis_rx_ring;
 
 struct password {
 	struct password *next;
@@ -83,6 +84,7 @@ struct isis_circuit {
 	struct isis_area *area;      /* back pointer to the area */
 	struct interface *interface; /* interface info from z */
 	int fd;			     /* IS-IS l1/2 socket */
+	struct isis_rx_ring *rx_ring; /* PF_PACKET mmap receive ring */
 	int sap_length;		     /* SAP length for DLPI */
 	struct nlpids nlpids;
 	/*
@@ -870,6 +870,36 @@ void cli_show_isis_lsp_mtu(struct vty *vty, const struct lyd_node *dnode,
 	vty_out(vty, " lsp-mtu %s\n", yang_dnode_get_string(dnode, NULL));
 }
 
+/*
+ * XPath: /frr-isisd:isis/instance/lsp/tx-rate
+ */
+DEFPY_YANG(area_lsp_tx_rate, area_lsp_tx_rate_cmd,
+      "lsp-tx-rate (10-100000)$val",
+      "Configure the LSP flooding rate\n"
+      "LSPs sent per second on each circuit\n")
+{
+	nb_cli_enqueue_change(vty, "./lsp/tx-rate", NB_OP_MODIFY, val_str);
+
+	return nb_cli_apply_changes(vty, NULL);
+}
+
+DEFPY_YANG(no_area_lsp_tx_rate, no_area_lsp_tx_rate_cmd,
+      "no lsp-tx-rate [(10-100000)]",
+      NO_STR
+      "Configure the LSP flooding rate\n"
+      "LSPs sent per second on each circuit\n")
+{
+	nb_cli_enqueue_change(vty, "./lsp/tx-rate", NB_OP_MODIFY, NULL);
+
+	return nb_cli_apply_changes(vty, NULL);
+}
+
+void cli_show_isis_lsp_tx_rate(struct vty *vty, const struct lyd_node *dnode,
+			       bool show_defaults)
+{
+	vty_out(vty, " lsp-tx-rate %s\n", yang_dnode_get_string(dnode, NULL));
+}
+
 /*
  * XPath: /frr-isisd:isis/instance/spf/minimum-interval
  */
@@ -3118,6 +3148,8 @@ void isis_cli_init(void)
 	install_element(ISIS_NODE, &no_lsp_timers_cmd);
 	install_element(ISIS_NODE, &area_lsp_mtu_cmd);
 	install_element(ISIS_NODE, &no_area_lsp_mtu_cmd);
+	install_element(ISIS_NODE, &area_lsp_tx_rate_cmd);
+	install_element(ISIS_NODE, &no_area_lsp_tx_rate_cmd);
 
 	install_element(ISIS_NODE, &spf_interval_cmd);
 	install_element(ISIS_NODE, &no_spf_interval_cmd);
@@ -488,6 +488,17 @@ int isis_sock_init(struct isis_circuit *circuit)
 	return retval;
 }
 
+void isis_sock_close(struct isis_circuit *circuit)
+{
+	close(circuit->fd);
+	circuit->fd = 0;
+}
+
+bool isis_recv_pending(struct isis_circuit *circuit)
+{
+	return false;
+}
+
 int isis_recv_pdu_bcast(struct isis_circuit *circuit, uint8_t *ssnpa)
 {
 	struct pollfd fds[1];
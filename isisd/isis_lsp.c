@@ -33,6 +33,7 @@
 #include "prefix.h"
 #include "command.h"
 #include "hash.h"
+#include "jhash.h"
 #include "if.h"
 #include "checksum.h"
 #include "md5.h"
@@ -111,6 +112,116 @@ static void lsp_clear_data(struct isis_lsp *lsp)
 
 static void lsp_remove_frags(struct lspdb_head *head, struct list *frags);
 
+/*
+ * LSP aging.  Rather than decrementing the remaining lifetime of every LSP
+ * once a second, each LSP in the database records when its current phase
+ * ends: the remaining lifetime reaching zero or, once it is zero, the
+ * ZeroAgeLifetime running out.  The LSPs sit in a per-area heap ordered by
+ * that time, so lsp_tick() only touches the ones that are due.
+ */
+static void lsp_aging_set(struct isis_lsp *lsp)
+{
+	lsp->expires = monotime(NULL)
+		       + (lsp->hdr.rem_lifetime ? lsp->hdr.rem_lifetime
+						: lsp->age_out);
+}
+
+/* To be called whenever hdr.rem_lifetime or age_out are changed */
+static void lsp_aging_update(struct isis_lsp *lsp)
+{
+	/* not in the database yet, lsp_insert() will pick it up */
+	if (!lsp->aging_queued)
+		return;
+
+	lsp_aging_del(&lsp->area->lsp_aging, lsp);
+	lsp_aging_set(lsp);
+	lsp_aging_add(&lsp->area->lsp_aging, lsp);
+}
+
+/*
+ * Bring hdr.rem_lifetime (and the copy in the PDU) or age_out up to date
+ * before they are looked at for anything but being zero.
+ */
+void lsp_sync_lifetime(struct isis_lsp *lsp)
+{
+	time_t left;
+
+	if (!lsp->aging_queued)
+		return;
+
+	left = lsp->expires - monotime(NULL);
+
+	if (lsp->hdr.rem_lifetime) {
+		/* dropping to zero is left to lsp_tick() */
+		lsp->hdr.rem_lifetime = MAX(left, 1);
+		if (lsp->pdu && stream_get_endp(lsp->pdu) >= 12)
+			stream_putw_at(lsp->pdu, 10, lsp->hdr.rem_lifetime);
+	} else
+		lsp->age_out = MAX(left, 0);
+}
+
+/*
+ * Hash over everything in the LSP the SPF looks at apart from IP
+ * reachability, so that a change which only moves prefixes around can be
+ * told apart from one that alters the topology.  Zero for purged LSPs and
+ * for non-zero fragments carrying nothing but prefixes.
+ */
+static uint32_t lsp_topology_hash(struct isis_lsp *lsp)
+{
+	const uint8_t *data;
+	size_t len, pos;
+	uint32_t hash = 0;
+
+	if (!lsp->pdu || !lsp->hdr.rem_lifetime)
+		return 0;
+
+	if (!LSP_FRAGMENT(lsp->hdr.lsp_id))
+		hash = jhash_1word(lsp->hdr.lsp_bits, hash);
+
+	data = STREAM_DATA(lsp->pdu);
+	len = stream_get_endp(lsp->pdu);
+	for (pos = ISIS_FIXED_HDR_LEN + ISIS_LSP_HDR_LEN;
+	     pos + 2 <= len && pos + 2 + data[pos + 1] <= len;
+	     pos += 2 + data[pos + 1]) {
+		switch (data[pos]) {
+		case ISIS_TLV_PADDING:
+		case ISIS_TLV_AUTH:
+		case ISIS_TLV_PURGE_ORIGINATOR:
+		case ISIS_TLV_DYNAMIC_HOSTNAME:
+		case ISIS_TLV_OLDSTYLE_IP_REACH:
+		case ISIS_TLV_OLDSTYLE_IP_REACH_EXT:
+		case ISIS_TLV_EXTENDED_IP_REACH:
+		case ISIS_TLV_MT_IP_REACH:
+		case ISIS_TLV_IPV6_REACH:
+		case ISIS_TLV_MT_IPV6_REACH:
+			continue;
+		default:
+			break;
+		}
+
+		hash = jhash(data + pos, 2 + data[pos + 1], hash);
+	}
+
+	return hash;
+}
+
+/* Adding or removing a prefix-only fragment leaves the topology alone */
+static enum isis_spf_trigger lsp_spf_trigger(struct isis_lsp *lsp, bool add)
+{
+	if (LSP_FRAGMENT(lsp->hdr.lsp_id) && !lsp->topo_hash)
+		return SPF_TRIGGER_PREFIX;
+
+	return add ? SPF_TRIGGER_LSP_ADD : SPF_TRIGGER_LSP_DEL;
+}
+
+/* Classify a content change by comparing against the previous hash */
+static enum isis_spf_trigger lsp_spf_trigger_update(struct isis_lsp *lsp,
+						    uint32_t old_hash)
+{
+	return lsp->topo_hash == old_hash ? SPF_TRIGGER_PREFIX
+					  : SPF_TRIGGER_TOPOLOGY;
+}
+
 static void lsp_destroy(struct isis_lsp *lsp)
 {
 	struct listnode *cnode;
@@ -119,6 +230,11 @@ static void lsp_destroy(struct isis_lsp *lsp)
 	if (!lsp)
 		return;
 
+	if (lsp->aging_queued) {
+		lsp_aging_del(&lsp->area->lsp_aging, lsp);
+		lsp->aging_queued = false;
+	}
+
 	for (ALL_LIST_ELEMENTS_RO(lsp->area->circuit_list, cnode, circuit))
 		isis_tx_queue_del(circuit->tx_queue, lsp);
 
@@ -141,7 +257,7 @@ static void lsp_destroy(struct isis_lsp *lsp)
 		}
 	}
 
-	isis_spf_schedule(lsp->area, lsp->level);
+	isis_spf_schedule(lsp->area, lsp->level, lsp_spf_trigger(lsp, false));
 
 	if (lsp->pdu)
 		stream_free(lsp->pdu);
@@ -317,6 +433,7 @@ static void lsp_pack_pdu(struct isis_lsp *lsp)
 
 void lsp_inc_seqno(struct isis_lsp *lsp, uint32_t seqno)
 {
+	uint32_t topo_hash = lsp->topo_hash;
 	uint32_t newseq;
 
 	if (seqno == 0 || lsp->hdr.seqno > seqno)
@@ -336,7 +453,9 @@ void lsp_inc_seqno(struct isis_lsp *lsp, uint32_t seqno)
 	lsp->hdr.seqno = newseq;
 
 	lsp_pack_pdu(lsp);
-	isis_spf_schedule(lsp->area, lsp->level);
+	lsp->topo_hash = lsp_topology_hash(lsp);
+	isis_spf_schedule(lsp->area, lsp->level,
+			  lsp_spf_trigger_update(lsp, topo_hash));
 	isis_te_lsp_event(lsp, LSP_INC);
 }
 
@@ -367,8 +486,10 @@ static void lsp_purge(struct isis_lsp *lsp, int level,
 	/* update header */
 	lsp->hdr.checksum = 0;
 	lsp->hdr.rem_lifetime = 0;
+	lsp->topo_hash = 0;
 	lsp->level = level;
 	lsp->age_out = lsp->area->max_lsp_lifetime[level - 1];
+	lsp_aging_update(lsp);
 	lsp->area->lsp_purge_count[level - 1]++;
 
 	lsp_purge_add_poi(lsp, sender);
@@ -514,7 +635,9 @@ static void lsp_update_data(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 	lsp->area = area;
 	lsp->level = level;
 	lsp->age_out = ZERO_AGE_LIFETIME;
+	lsp_aging_update(lsp);
 	lsp->installed = time(NULL);
+	lsp->topo_hash = lsp_topology_hash(lsp);
 
 	lsp->tlvs = tlvs;
 
@@ -547,6 +670,8 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		struct isis_tlvs *tlvs, struct stream *stream,
 		struct isis_area *area, int level, bool confusion)
 {
+	uint32_t topo_hash = lsp->topo_hash;
+
 	if (lsp->own_lsp) {
 		flog_err(
 			EC_LIB_DEVELOPMENT,
@@ -574,7 +699,8 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 	}
 
 	if (lsp->hdr.seqno) {
-		isis_spf_schedule(lsp->area, lsp->level);
+		isis_spf_schedule(lsp->area, lsp->level,
+				  lsp_spf_trigger_update(lsp, topo_hash));
 		isis_te_lsp_event(lsp, LSP_UPD);
 	}
 }
@@ -641,8 +767,15 @@ struct isis_lsp *lsp_new(struct isis_area *area, uint8_t *lsp_id,
 void lsp_insert(struct lspdb_head *head, struct isis_lsp *lsp)
 {
 	lspdb_add(head, lsp);
+
+	lsp_aging_set(lsp);
+	lsp_aging_add(&lsp->area->lsp_aging, lsp);
+	lsp->aging_queued = true;
+
+	lsp->topo_hash = lsp_topology_hash(lsp);
 	if (lsp->hdr.seqno) {
-		isis_spf_schedule(lsp->area, lsp->level);
+		isis_spf_schedule(lsp->area, lsp->level,
+				  lsp_spf_trigger(lsp, true));
 		isis_te_lsp_event(lsp, LSP_ADD);
 	}
 }
@@ -669,21 +802,6 @@ void lsp_build_list_nonzero_ht(struct lspdb_head *head, const uint8_t *start_id,
 	}
 }
 
-static void lsp_set_time(struct isis_lsp *lsp)
-{
-	assert(lsp);
-
-	if (lsp->hdr.rem_lifetime == 0) {
-		if (lsp->age_out > 0)
-			lsp->age_out--;
-		return;
-	}
-
-	lsp->hdr.rem_lifetime--;
-	if (lsp->pdu && stream_get_endp(lsp->pdu) >= 12)
-		stream_putw_at(lsp->pdu, 10, lsp->hdr.rem_lifetime);
-}
-
 void lspid_print(uint8_t *lsp_id, char *dest, size_t dest_len, char dynhost,
 		 char frag, struct isis *isis)
 {
@@ -752,6 +870,8 @@ void lsp_print_json(struct isis_lsp *lsp, struct json_object *json,
 	json_object *own_json;
 	char buf[256];
 
+	lsp_sync_lifetime(lsp);
+
 	lspid_print(lsp->hdr.lsp_id, LSPid, sizeof(LSPid), dynhost, 1, isis);
 	own_json = json_object_new_object();
 	json_object_object_add(json, "lsp", own_json);
@@ -780,6 +900,8 @@ void lsp_print_vty(struct isis_lsp *lsp, struct vty *vty,
 	char age_out[8];
 	char b[200];
 
+	lsp_sync_lifetime(lsp);
+
 	lspid_print(lsp->hdr.lsp_id, LSPid, sizeof(LSPid), dynhost, 1, isis);
 	vty_out(vty, "%-21s%c  ", LSPid, lsp->own_lsp ? '*' : ' ');
 	vty_out(vty, "%5hu   ", lsp->hdr.pdu_len);
@@ -975,6 +1097,7 @@ static struct isis_lsp *lsp_next_frag(uint8_t frag_num, struct isis_lsp *lsp0,
 		return lsp;
 	}
 
+	lsp_sync_lifetime(lsp0);
 	lsp = lsp_new(area, frag_id, lsp0->hdr.rem_lifetime, 0,
 		      lsp_bits_generate(level, area->overload_bit,
 					area->attached_bit_send, area),
@@ -1450,6 +1573,7 @@ static int lsp_regenerate(struct isis_area *area, int level)
 	lsp_build(lsp, area);
 	rem_lifetime = lsp_rem_lifetime(area, level);
 	lsp->hdr.rem_lifetime = rem_lifetime;
+	lsp_aging_update(lsp);
 	lsp->last_generated = time(NULL);
 	lsp_flood(lsp, NULL);
 	area->lsp_gen_count[level - 1]++;
@@ -1470,6 +1594,7 @@ static int lsp_regenerate(struct isis_area *area, int level)
 		 */
 		frag->hdr.rem_lifetime = rem_lifetime;
 		frag->age_out = ZERO_AGE_LIFETIME;
+		lsp_aging_update(frag);
 		lsp_flood(frag, NULL);
 	}
 	lsp_seqno_update(lsp);
@@ -1847,6 +1972,7 @@ static int lsp_regenerate_pseudo(struct isis_circuit *circuit, int level)
 
 	rem_lifetime = lsp_rem_lifetime(circuit->area, level);
 	lsp->hdr.rem_lifetime = rem_lifetime;
+	lsp_aging_update(lsp);
 	lsp_build_pseudo(lsp, circuit, level);
 	lsp_inc_seqno(lsp, 0);
 	lsp->last_generated = time(NULL);
@@ -2020,15 +2146,15 @@ int lsp_regenerate_schedule_pseudo(struct isis_circuit *circuit, int level)
 }
 
 /*
- * Walk through LSPs for an area
- *  - set remaining lifetime
+ * Age out the LSPs of an area whose remaining lifetime or ZeroAgeLifetime
+ * has run out
  */
 void lsp_tick(struct thread *thread)
 {
 	struct isis_area *area;
 	struct isis_lsp *lsp;
 	int level;
-	uint16_t rem_lifetime;
+	time_t now;
 	bool fabricd_sync_incomplete = false;
 
 	area = THREAD_ARG(thread);
@@ -2038,32 +2164,29 @@ void lsp_tick(struct thread *thread)
 
 	struct isis_circuit *fabricd_init_c = fabricd_initial_sync_circuit(area);
 
-	/*
-	 * Remove LSPs which have aged out
-	 */
-	for (level = 0; level < ISIS_LEVELS; level++) {
-		struct isis_lsp *next = lspdb_first(&area->lspdb[level]);
-		frr_each_from (lspdb, &area->lspdb[level], lsp, next) {
+	now = monotime(NULL);
+	while ((lsp = lsp_aging_first(&area->lsp_aging))
+	       && lsp->expires <= now) {
+		if (lsp->hdr.rem_lifetime) {
 			/*
-			 * The lsp rem_lifetime is kept at 0 for MaxAge
-			 * or
-			 * ZeroAgeLifetime depending on explicit purge
-			 * or
-			 * natural age out. So schedule spf only once
-			 * when
-			 * the first time rem_lifetime becomes 0.
+			 * The lsp rem_lifetime is kept at 0 for MaxAge or
+			 * ZeroAgeLifetime depending on explicit purge or
+			 * natural age out, after which age_out starts
+			 * running.
 			 */
-			rem_lifetime = lsp->hdr.rem_lifetime;
-			lsp_set_time(lsp);
+			lsp->hdr.rem_lifetime = 0;
+			lsp->topo_hash = 0;
+			if (lsp->pdu && stream_get_endp(lsp->pdu) >= 12)
+				stream_putw_at(lsp->pdu, 10, 0);
+			lsp_aging_update(lsp);
 
 			/*
-			 * Schedule may run spf which should be done
-			 * only after
-			 * the lsp rem_lifetime becomes 0 for the first
+			 * Schedule may run spf which should be done only
+			 * after the lsp rem_lifetime becomes 0 for the first
 			 * time.
 			 * ISO 10589 - 7.3.16.4 first paragraph.
 			 */
-			if (rem_lifetime == 1 && lsp->hdr.seqno != 0) {
+			if (lsp->hdr.seqno != 0) {
 				/* 7.3.16.4 a) set SRM flags on all */
 				/* 7.3.16.4 b) retain only the header */
 				if (lsp->area->purge_originator)
@@ -2072,45 +2195,35 @@ void lsp_tick(struct thread *thread)
 					lsp_flood(lsp, NULL);
 				/* 7.3.16.4 c) record the time to purge
 				 * FIXME */
-				isis_spf_schedule(lsp->area, lsp->level);
+				isis_spf_schedule(lsp->area, lsp->level,
+						  SPF_TRIGGER_LSP_EXPIRED);
 				isis_te_lsp_event(lsp, LSP_TICK);
 			}
+			continue;
+		}
 
-			if (lsp->age_out == 0) {
-				zlog_debug(
-					"ISIS-Upd (%s): L%u LSP %s seq 0x%08x aged out",
-					area->area_tag, lsp->level,
-					rawlspid_print(lsp->hdr.lsp_id),
-					lsp->hdr.seqno);
-
-				/* if we're aging out fragment 0, lsp_destroy()
-				 * below will delete all other fragments too,
-				 * so we need to skip over those
-				 */
-				if (!LSP_FRAGMENT(lsp->hdr.lsp_id))
-					while (next &&
-						!memcmp(next->hdr.lsp_id,
-							lsp->hdr.lsp_id,
-							ISIS_SYS_ID_LEN + 1))
-						next = lspdb_next(
-							&area->lspdb[level],
-							next);
-
-				lspdb_del(&area->lspdb[level], lsp);
-				lsp_destroy(lsp);
-				lsp = NULL;
-			}
+		zlog_debug("ISIS-Upd (%s): L%u LSP %s seq 0x%08x aged out",
+			   area->area_tag, lsp->level,
+			   rawlspid_print(lsp->hdr.lsp_id), lsp->hdr.seqno);
 
-			if (fabricd_init_c && lsp) {
-				fabricd_sync_incomplete |=
-					ISIS_CHECK_FLAG(lsp->SSNflags,
-							fabricd_init_c);
-			}
+		/* if we're aging out fragment 0, lsp_destroy() deletes all
+		 * other fragments too, taking them off the aging heap
+		 */
+		lspdb_del(&area->lspdb[lsp->level - 1], lsp);
+		lsp_destroy(lsp);
+	}
+
+	if (!fabricd_init_c)
+		return;
+
+	for (level = 0; level < ISIS_LEVELS; level++) {
+		frr_each (lspdb, &area->lspdb[level], lsp) {
+			fabricd_sync_incomplete |=
+				ISIS_CHECK_FLAG(lsp->SSNflags, fabricd_init_c);
 		}
 	}
 
-	if (fabricd_init_c
-	    && !fabricd_sync_incomplete
+	if (!fabricd_sync_incomplete
 	    && !isis_tx_queue_len(fabricd_init_c->tx_queue)) {
 		fabricd_initial_sync_finish(area);
 	}
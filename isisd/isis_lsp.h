@@ -28,6 +28,7 @@
 #include "isisd/isis_pdu.h"
 
 PREDECL_RBTREE_UNIQ(lspdb);
+PREDECL_HEAP(lsp_aging);
 
 struct isis;
 /* Structure for isis_lsp, this structure will only support the fixed
@@ -51,6 +52,13 @@ struct isis_lsp {
 	int own_lsp;
 	/* used for 60 second counting when rem_lifetime is zero */
 	int age_out;
+	/* when rem_lifetime (or age_out, once that is zero) runs out;
+	 * both are only brought up to date by lsp_sync_lifetime() */
+	time_t expires;
+	struct lsp_aging_item aging;
+	bool aging_queued;
+	/* hash of the non-prefix TLVs, see lsp_topology_hash() */
+	uint32_t topo_hash;
 	struct isis_area *area;
 	struct isis_tlvs *tlvs;
 
@@ -63,9 +71,17 @@ struct isis_lsp {
 extern int lspdb_compare(const struct isis_lsp *a, const struct isis_lsp *b);
 DECLARE_RBTREE_UNIQ(lspdb, struct isis_lsp, dbe, lspdb_compare);
 
+static inline int lsp_aging_compare(const struct isis_lsp *a,
+				    const struct isis_lsp *b)
+{
+	return numcmp(a->expires, b->expires);
+}
+DECLARE_HEAP(lsp_aging, struct isis_lsp, aging, lsp_aging_compare);
+
 void lsp_db_init(struct lspdb_head *head);
 void lsp_db_fini(struct lspdb_head *head);
 void lsp_tick(struct thread *thread);
+void lsp_sync_lifetime(struct isis_lsp *lsp);
 
 int lsp_generate(struct isis_area *area, int level);
 #define lsp_regenerate_schedule(area, level, all_pseudo) \
@@ -108,6 +108,13 @@ const struct frr_yang_module_info frr_isisd_info = {
 				.modify = isis_instance_lsp_mtu_modify,
 			},
 		},
+		{
+			.xpath = "/frr-isisd:isis/instance/lsp/tx-rate",
+			.cbs = {
+				.cli_show = cli_show_isis_lsp_tx_rate,
+				.modify = isis_instance_lsp_tx_rate_modify,
+			},
+		},
 		{
 			.xpath = "/frr-isisd:isis/instance/lsp/timers",
 			.cbs = {
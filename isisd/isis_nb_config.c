@@ -410,6 +410,22 @@ int isis_instance_lsp_mtu_modify(struct nb_cb_modify_args *args)
 	return NB_OK;
 }
 
+/*
+ * XPath: /frr-isisd:isis/instance/lsp/tx-rate
+ */
+int isis_instance_lsp_tx_rate_modify(struct nb_cb_modify_args *args)
+{
+	struct isis_area *area;
+
+	if (args->event != NB_EV_APPLY)
+		return NB_OK;
+
+	area = nb_running_get_entry(args->dnode, NULL, true);
+	area->lsp_tx_rate = yang_dnode_get_uint32(args->dnode, NULL);
+
+	return NB_OK;
+}
+
 /*
  * XPath: /frr-isisd:isis/instance/lsp/timers/level-1/refresh-interval
  */
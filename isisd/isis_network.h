@@ -28,6 +28,8 @@ extern uint8_t ALL_L1_ISYSTEMS[];
 extern uint8_t ALL_L2_ISYSTEMS[];
 
 int isis_sock_init(struct isis_circuit *circuit);
+void isis_sock_close(struct isis_circuit *circuit);
+bool isis_recv_pending(struct isis_circuit *circuit);
 
 int isis_recv_pdu_bcast(struct isis_circuit *circuit, uint8_t *ssnpa);
 int isis_recv_pdu_p2p(struct isis_circuit *circuit, uint8_t *ssnpa);
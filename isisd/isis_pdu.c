@@ -1793,6 +1793,9 @@ int isis_handle_pdu(struct isis_circuit *circuit, uint8_t *ssnpa)
 	return retval;
 }
 
+/* upper bound on PDUs handled per read wakeup */
+#define ISIS_RECV_BATCH 64
+
 void isis_receive(struct thread *thread)
 {
 	struct isis_circuit *circuit;
@@ -1806,16 +1809,26 @@ void isis_receive(struct thread *thread)
 
 	circuit->t_read = NULL;
 
-	isis_circuit_stream(circuit, &circuit->rcv_stream);
-
 #if ISIS_METHOD != ISIS_METHOD_BPF
 	int retval;
+	unsigned int budget = ISIS_RECV_BATCH;
+
+	/*
+	 * With a PF_PACKET receive ring a single wakeup can hand us a whole
+	 * block of PDUs; work through it, bounded so other events still get
+	 * their turn.
+	 */
+	do {
+		isis_circuit_stream(circuit, &circuit->rcv_stream);
 
-	retval = circuit->rx(circuit, ssnpa);
+		retval = circuit->rx(circuit, ssnpa);
 
-	if (retval == ISIS_OK)
-		isis_handle_pdu(circuit, ssnpa);
+		if (retval == ISIS_OK)
+			isis_handle_pdu(circuit, ssnpa);
+	} while (--budget && isis_recv_pending(circuit));
 #else // ISIS_METHOD != ISIS_METHOD_BPF
+	isis_circuit_stream(circuit, &circuit->rcv_stream);
+
 	circuit->rx(circuit, ssnpa);
 #endif
 
@@ -2488,6 +2501,7 @@ void send_lsp(struct isis_circuit *circuit, struct isis_lsp *lsp,
 	}
 
 	/* copy our lsp to the send buffer */
+	lsp_sync_lifetime(lsp);
 	stream_copy(circuit->snd_stream, lsp->pdu);
 
 	if (tx_type == TX_LSP_CIRCUIT_SCOPED) {
@@ -23,7 +23,8 @@
 #include <zebra.h>
 #if ISIS_METHOD == ISIS_METHOD_PFPACKET
 #include <net/ethernet.h> /* the L2 protocols */
-#include <netpacket/packet.h>
+#include <linux/if_packet.h>
+#include <sys/mman.h>
 
 #include <linux/filter.h>
 
@@ -33,6 +34,7 @@
 #include "if.h"
 #include "lib_errors.h"
 #include "vrf.h"
+#include "memory.h"
 
 #include "isisd/isis_constants.h"
 #include "isisd/isis_common.h"
@@ -75,6 +77,165 @@ static const uint8_t ALL_ESS[6] = {0x09, 0x00, 0x2B, 0x00, 0x00, 0x04};
 
 static uint8_t discard_buff[8192];
 
+DEFINE_MTYPE_STATIC(ISISD, ISIS_RX_RING, "ISIS PF_PACKET receive ring");
+
+/*
+ * PACKET_MMAP (TPACKET_V3) receive ring.  The kernel fills whole blocks of
+ * frames and hands a block over once it is full or ISIS_RX_RING_TIMEOUT
+ * milliseconds after its first frame, so one read wakeup can drain a burst
+ * of PDUs (LSP floods, CSNP/PSNP storms) without a recvfrom() per PDU.
+ *
+ * A block must be able to hold a jumbo frame; 8 x 32k keeps the mapping at
+ * 256k per circuit.
+ */
+#define ISIS_RX_RING_BLOCK_SIZE (1 << 15)
+#define ISIS_RX_RING_BLOCK_NR 8
+#define ISIS_RX_RING_FRAME_SIZE 2048
+#define ISIS_RX_RING_TIMEOUT 2 /* ms */
+
+struct isis_rx_ring {
+	uint8_t *map;
+	size_t map_len;
+
+	unsigned int block;	     /* block currently being drained */
+	bool held;		     /* block is owned by us */
+	uint32_t pkts_left;	     /* frames left in the held block */
+	struct tpacket3_hdr *frame; /* next frame in the held block */
+};
+
+static inline struct tpacket_block_desc *
+isis_rx_ring_block(struct isis_rx_ring *ring, unsigned int block)
+{
+	return (struct tpacket_block_desc *)(ring->map
+					     + block * ISIS_RX_RING_BLOCK_SIZE);
+}
+
+static inline struct sockaddr_ll *isis_rx_ring_addr(struct tpacket3_hdr *frame)
+{
+	return (struct sockaddr_ll *)((uint8_t *)frame
+				      + TPACKET_ALIGN(sizeof(*frame)));
+}
+
+static struct isis_rx_ring *isis_rx_ring_new(int fd)
+{
+	struct isis_rx_ring *ring;
+	struct tpacket_req3 req;
+	int version = TPACKET_V3;
+	void *map;
+
+	if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version,
+		       sizeof(version))
+	    < 0) {
+		zlog_info("IS-IS pfpacket: TPACKET_V3 unavailable (%s), using recvfrom()",
+			  safe_strerror(errno));
+		return NULL;
+	}
+
+	memset(&req, 0, sizeof(req));
+	req.tp_block_size = ISIS_RX_RING_BLOCK_SIZE;
+	req.tp_block_nr = ISIS_RX_RING_BLOCK_NR;
+	req.tp_frame_size = ISIS_RX_RING_FRAME_SIZE;
+	req.tp_frame_nr = (ISIS_RX_RING_BLOCK_SIZE * ISIS_RX_RING_BLOCK_NR)
+			  / ISIS_RX_RING_FRAME_SIZE;
+	req.tp_retire_blk_tov = ISIS_RX_RING_TIMEOUT;
+
+	if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+		zlog_info("IS-IS pfpacket: PACKET_RX_RING failed (%s), using recvfrom()",
+			  safe_strerror(errno));
+		return NULL;
+	}
+
+	map = mmap(NULL, req.tp_block_size * req.tp_block_nr,
+		   PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		zlog_info("IS-IS pfpacket: mmap() of receive ring failed (%s), using recvfrom()",
+			  safe_strerror(errno));
+		/* tear the ring down again so frames reach the socket queue */
+		memset(&req, 0, sizeof(req));
+		setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+		return NULL;
+	}
+
+	/*
+	 * Anything that was queued before the ring was attached (the socket
+	 * is not bound yet, so this can be from any interface) would never be
+	 * read from the ring; get rid of it.
+	 */
+	while (recv(fd, discard_buff, sizeof(discard_buff), MSG_DONTWAIT) >= 0)
+		;
+
+	ring = XCALLOC(MTYPE_ISIS_RX_RING, sizeof(*ring));
+	ring->map = map;
+	ring->map_len = req.tp_block_size * req.tp_block_nr;
+
+	return ring;
+}
+
+static void isis_rx_ring_free(struct isis_rx_ring **ring)
+{
+	if (!*ring)
+		return;
+
+	munmap((*ring)->map, (*ring)->map_len);
+	XFREE(MTYPE_ISIS_RX_RING, *ring);
+}
+
+/*
+ * Make sure a frame is available at ring->frame, handing fully drained
+ * blocks back to the kernel on the way.  Returns false when the kernel has
+ * not passed us any further block yet.
+ */
+static bool isis_rx_ring_fill(struct isis_rx_ring *ring)
+{
+	struct tpacket_block_desc *pbd;
+	uint8_t *first;
+
+	for (;;) {
+		pbd = isis_rx_ring_block(ring, ring->block);
+
+		if (!ring->held) {
+			if (!(__atomic_load_n(&pbd->hdr.bh1.block_status,
+					      __ATOMIC_ACQUIRE)
+			      & TP_STATUS_USER))
+				return false;
+
+			first = (uint8_t *)pbd + pbd->hdr.bh1.offset_to_first_pkt;
+
+			ring->held = true;
+			ring->pkts_left = pbd->hdr.bh1.num_pkts;
+			ring->frame = (struct tpacket3_hdr *)first;
+		}
+
+		if (ring->pkts_left)
+			return true;
+
+		__atomic_store_n(&pbd->hdr.bh1.block_status, TP_STATUS_KERNEL,
+				 __ATOMIC_RELEASE);
+		ring->held = false;
+		ring->block = (ring->block + 1) % ISIS_RX_RING_BLOCK_NR;
+	}
+}
+
+/*
+ * Pop the next frame off the receive ring.  The frame stays valid until
+ * the next call, which is all the rx functions need since they copy the
+ * PDU into the circuit's receive stream right away.
+ */
+static struct tpacket3_hdr *isis_rx_ring_next(struct isis_rx_ring *ring)
+{
+	struct tpacket3_hdr *frame;
+
+	if (!isis_rx_ring_fill(ring))
+		return NULL;
+
+	frame = ring->frame;
+	ring->frame = (struct tpacket3_hdr *)((uint8_t *)frame
+					      + frame->tp_next_offset);
+	ring->pkts_left--;
+
+	return frame;
+}
+
 /*
  * if level is 0 we are joining p2p multicast
  * FIXME: and the p2p multicast being ???
@@ -141,6 +302,9 @@ static int open_packet_socket(struct isis_circuit *circuit)
 			  safe_strerror(errno));
 	}
 
+	/* the filter above still applies to frames delivered to the ring */
+	circuit->rx_ring = isis_rx_ring_new(fd);
+
 	/*
 	 * Bind to the physical interface
 	 */
@@ -153,6 +317,7 @@ static int open_packet_socket(struct isis_circuit *circuit)
 	    < 0) {
 		zlog_warn("open_packet_socket(): bind() failed: %s",
 			  safe_strerror(errno));
+		isis_rx_ring_free(&circuit->rx_ring);
 		close(fd);
 		return ISIS_WARNING;
 	}
@@ -217,6 +382,18 @@ int isis_sock_init(struct isis_circuit *circuit)
 	return retval;
 }
 
+void isis_sock_close(struct isis_circuit *circuit)
+{
+	isis_rx_ring_free(&circuit->rx_ring);
+	close(circuit->fd);
+	circuit->fd = 0;
+}
+
+bool isis_recv_pending(struct isis_circuit *circuit)
+{
+	return circuit->rx_ring && isis_rx_ring_fill(circuit->rx_ring);
+}
+
 static inline int llc_check(uint8_t *llc)
 {
 	if (*llc != ISO_SAP || *(llc + 1) != ISO_SAP || *(llc + 2) != 3)
@@ -225,12 +402,92 @@ static inline int llc_check(uint8_t *llc)
 	return 1;
 }
 
+static int isis_recv_ring_bcast(struct isis_circuit *circuit, uint8_t *ssnpa)
+{
+	struct tpacket3_hdr *frame;
+	struct sockaddr_ll *s_addr;
+	uint8_t *data;
+
+	frame = isis_rx_ring_next(circuit->rx_ring);
+	if (!frame)
+		return ISIS_WARNING;
+
+	s_addr = isis_rx_ring_addr(frame);
+	data = (uint8_t *)frame + frame->tp_mac;
+
+	if (s_addr->sll_ifindex != (int)circuit->interface->ifindex) {
+		zlog_warn(
+			"packet is received on multiple interfaces: socket interface %d, circuit interface %d, packet type %u",
+			s_addr->sll_ifindex, circuit->interface->ifindex,
+			s_addr->sll_pkttype);
+		return ISIS_WARNING;
+	}
+
+	/*
+	 * Filtering by llc field, discard packets sent by this host (other
+	 * circuit) and anything that did not fit in the ring frame
+	 */
+	if (frame->tp_snaplen < LLC_LEN || frame->tp_snaplen != frame->tp_len
+	    || !llc_check(data) || s_addr->sll_pkttype == PACKET_OUTGOING)
+		return ISIS_WARNING;
+
+	if (frame->tp_snaplen - LLC_LEN > STREAM_WRITEABLE(circuit->rcv_stream)) {
+		zlog_warn("%s: %u byte PDU on %s exceeds the receive buffer",
+			  __func__, frame->tp_snaplen - LLC_LEN,
+			  circuit->interface->name);
+		return ISIS_WARNING;
+	}
+
+	/* then we lose the LLC */
+	stream_write(circuit->rcv_stream, data + LLC_LEN,
+		     frame->tp_snaplen - LLC_LEN);
+	memcpy(ssnpa, &s_addr->sll_addr, s_addr->sll_halen);
+
+	return ISIS_OK;
+}
+
+static int isis_recv_ring_p2p(struct isis_circuit *circuit, uint8_t *ssnpa)
+{
+	struct tpacket3_hdr *frame;
+	struct sockaddr_ll *s_addr;
+	size_t len;
+
+	frame = isis_rx_ring_next(circuit->rx_ring);
+	if (!frame)
+		return ISIS_WARNING;
+
+	s_addr = isis_rx_ring_addr(frame);
+
+	if (s_addr->sll_pkttype == PACKET_OUTGOING)
+		return ISIS_WARNING;
+
+	/* If we don't have protocol type 0x00FE which is
+	 * ISO over GRE we exit with pain :)
+	 */
+	if (ntohs(s_addr->sll_protocol) != 0x00FE) {
+		zlog_warn("isis_recv_pdu_p2p(): protocol mismatch(): %X",
+			  ntohs(s_addr->sll_protocol));
+		return ISIS_WARNING;
+	}
+
+	len = MIN(frame->tp_snaplen, circuit->interface->mtu);
+	len = MIN(len, STREAM_WRITEABLE(circuit->rcv_stream));
+	stream_write(circuit->rcv_stream, (uint8_t *)frame + frame->tp_mac,
+		     len);
+	memcpy(ssnpa, &s_addr->sll_addr, s_addr->sll_halen);
+
+	return ISIS_OK;
+}
+
 int isis_recv_pdu_bcast(struct isis_circuit *circuit, uint8_t *ssnpa)
 {
 	int bytesread, addr_len;
 	struct sockaddr_ll s_addr;
 	uint8_t llc[LLC_LEN];
 
+	if (circuit->rx_ring)
+		return isis_recv_ring_bcast(circuit, ssnpa);
+
 	addr_len = sizeof(s_addr);
 
 	memset(&s_addr, 0, sizeof(struct sockaddr_ll));
@@ -306,6 +563,9 @@ int isis_recv_pdu_p2p(struct isis_circuit *circuit, uint8_t *ssnpa)
 	int bytesread, addr_len;
 	struct sockaddr_ll s_addr;
 
+	if (circuit->rx_ring)
+		return isis_recv_ring_p2p(circuit, ssnpa);
+
 	memset(&s_addr, 0, sizeof(struct sockaddr_ll));
 	addr_len = sizeof(s_addr);
 
@@ -454,6 +454,18 @@ static int spf_adj_state_change(struct isis_adjacency *adj)
 {
 	struct isis_area *area = adj->circuit->area;
 
+	/*
+	 * The SPT kept from the last run no longer matches the adjacency
+	 * database, so the next run can't be limited to prefixes.
+	 */
+	for (int level = ISIS_LEVEL1; level <= ISIS_LEVEL2; level++) {
+		if (!(area->is_type & level))
+			continue;
+		SET_FLAG(area->spf_pending_triggers[level - 1],
+			 1 << SPF_TRIGGER_ADJACENCY);
+		area->spf_trigger_count[level - 1][SPF_TRIGGER_ADJACENCY]++;
+	}
+
 	if (adj->adj_state == ISIS_ADJ_UP)
 		return 0;
 
@@ -855,7 +867,8 @@ lspfragloop:
 			   print_sys_hostname(lsp->hdr.lsp_id));
 #endif /* EXTREME_DEBUG */
 
-	if (no_overload) {
+	if (no_overload
+	    && !CHECK_FLAG(spftree->flags, F_SPFTREE_PREFIXES_ONLY)) {
 		if ((pseudo_lsp || spftree->mtid == ISIS_MT_IPV4_UNICAST)
 		    && spftree->area->oldmetric) {
 			struct isis_oldstyle_reach *r;
@@ -1197,22 +1210,31 @@ static int isis_spf_preload_tent_ip_reach_cb(const struct prefix *prefix,
 	return LSP_ITER_CONTINUE;
 }
 
+static void isis_spf_preload_tent_ip_reach(struct isis_spftree *spftree,
+					   struct isis_lsp *root_lsp,
+					   struct isis_vertex *parent)
+{
+	struct spf_preload_tent_ip_reach_args ip_reach_args;
+
+	if (CHECK_FLAG(spftree->flags, F_SPFTREE_HOPCOUNT_METRIC))
+		return;
+
+	ip_reach_args.spftree = spftree;
+	ip_reach_args.parent = parent;
+	isis_lsp_iterate_ip_reach(root_lsp, spftree->family, spftree->mtid,
+				  isis_spf_preload_tent_ip_reach_cb,
+				  &ip_reach_args);
+}
+
 static void isis_spf_preload_tent(struct isis_spftree *spftree,
 				  uint8_t *root_sysid,
 				  struct isis_lsp *root_lsp,
 				  struct isis_vertex *parent)
 {
-	struct spf_preload_tent_ip_reach_args ip_reach_args;
 	struct isis_spf_adj *sadj;
 	struct listnode *node;
 
-	if (!CHECK_FLAG(spftree->flags, F_SPFTREE_HOPCOUNT_METRIC)) {
-		ip_reach_args.spftree = spftree;
-		ip_reach_args.parent = parent;
-		isis_lsp_iterate_ip_reach(
-			root_lsp, spftree->family, spftree->mtid,
-			isis_spf_preload_tent_ip_reach_cb, &ip_reach_args);
-	}
+	isis_spf_preload_tent_ip_reach(spftree, root_lsp, parent);
 
 	/* Iterate over adjacencies. */
 	for (ALL_LIST_ELEMENTS_RO(spftree->sadj_list, node, sadj)) {
@@ -1662,12 +1684,34 @@ static void spf_path_process(struct isis_spftree *spftree,
 	}
 }
 
+/* Generate routes once the SPT is formed. */
+static void spf_generate_routes(struct isis_spftree *spftree)
+{
+	struct isis_vertex *vertex;
+	struct listnode *node;
+
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		/* New-style TLVs take precedence over the old-style TLVs. */
+		switch (vertex->type) {
+		case VTYPE_IPREACH_INTERNAL:
+		case VTYPE_IPREACH_EXTERNAL:
+			if (isis_find_vertex(&spftree->paths, &vertex->N,
+					     VTYPE_IPREACH_TE))
+				continue;
+			break;
+		default:
+			break;
+		}
+
+		spf_path_process(spftree, vertex);
+	}
+}
+
 static void isis_spf_loop(struct isis_spftree *spftree,
 			  uint8_t *root_sysid)
 {
 	struct isis_vertex *vertex;
 	struct isis_lsp *lsp;
-	struct listnode *node;
 
 	while (isis_vertex_queue_count(&spftree->tents)) {
 		vertex = isis_vertex_queue_pop(&spftree->tents);
@@ -1697,22 +1741,7 @@ static void isis_spf_loop(struct isis_spftree *spftree,
 				     root_sysid, vertex);
 	}
 
-	/* Generate routes once the SPT is formed. */
-	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
-		/* New-style TLVs take precedence over the old-style TLVs. */
-		switch (vertex->type) {
-		case VTYPE_IPREACH_INTERNAL:
-		case VTYPE_IPREACH_EXTERNAL:
-			if (isis_find_vertex(&spftree->paths, &vertex->N,
-					     VTYPE_IPREACH_TE))
-				continue;
-			break;
-		default:
-			break;
-		}
-
-		spf_path_process(spftree, vertex);
-	}
+	spf_generate_routes(spftree);
 }
 
 struct isis_spftree *isis_run_hopcount_spf(struct isis_area *area,
@@ -1821,9 +1850,114 @@ void isis_run_spf(struct isis_spftree *spftree)
 		+ (time_end.tv_usec - time_start.tv_usec);
 }
 
+/*
+ * Drop the IP vertices from PATHS, keeping the IS part of the SPT.
+ */
+static void spf_prune_prefixes(struct isis_spftree *spftree)
+{
+	struct listnode *node, *nnode;
+	struct isis_vertex *vertex;
+
+	hash_clean(spftree->prefix_sids, NULL);
+	isis_vertex_queue_clear(&spftree->tents);
+	memset(&spftree->lfa.protection_counters, 0,
+	       sizeof(spftree->lfa.protection_counters));
+
+	for (ALL_LIST_ELEMENTS(spftree->paths.l.list, node, nnode, vertex)) {
+		if (!VTYPE_IP(vertex->type))
+			continue;
+
+		hash_release(spftree->paths.hash, vertex);
+		list_delete_node(spftree->paths.l.list, node);
+		isis_vertex_del(vertex);
+	}
+}
+
+/*
+ * Partial route calculation: only IP reachability changed since the last
+ * isis_run_spf(), so the IS vertices in PATHS are still the shortest path
+ * tree. Re-attach the prefixes advertised by each of them and regenerate
+ * the routes; the route table verification that follows only touches
+ * zebra for the prefixes that actually changed.
+ */
+static void isis_run_prc(struct isis_spftree *spftree)
+{
+	struct isis_lsp *root_lsp;
+	struct isis_lsp *lsp;
+	struct isis_vertex *vertex;
+	struct isis_vertex *root_vertex = NULL;
+	struct isis_spf_adj *sadj;
+	struct listnode *node, *snode;
+	struct timeval time_start;
+	struct timeval time_end;
+
+	monotime(&time_start);
+
+	root_lsp = isis_root_system_lsp(spftree->lspdb, spftree->sysid);
+	if (root_lsp == NULL) {
+		zlog_err("ISIS-SPF: could not find own l%d LSP!",
+			 spftree->level);
+		return;
+	}
+
+	spf_prune_prefixes(spftree);
+
+	SET_FLAG(spftree->flags, F_SPFTREE_PREFIXES_ONLY);
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		if (!VTYPE_IS(vertex->type))
+			continue;
+
+		/* The root is always the first vertex added to PATHS. */
+		if (!root_vertex) {
+			root_vertex = vertex;
+			isis_spf_preload_tent_ip_reach(spftree, root_lsp,
+						       root_vertex);
+
+			/* Directly attached pseudonodes never get a vertex. */
+			for (ALL_LIST_ELEMENTS_RO(spftree->sadj_list, snode,
+						  sadj)) {
+				if (!LSP_PSEUDO_ID(sadj->id) || !sadj->lsp)
+					continue;
+				isis_spf_process_lsp(spftree, sadj->lsp,
+						     sadj->metric, 0,
+						     spftree->sysid,
+						     root_vertex);
+			}
+			continue;
+		}
+
+		lsp = lsp_for_vertex(spftree, vertex);
+		if (!lsp)
+			continue;
+
+		isis_spf_process_lsp(spftree, lsp, vertex->d_N, vertex->depth,
+				     spftree->sysid, vertex);
+	}
+	UNSET_FLAG(spftree->flags, F_SPFTREE_PREFIXES_ONLY);
+
+	/* Only IP vertices are left in TENT, none of them has children. */
+	while (isis_vertex_queue_count(&spftree->tents))
+		add_to_paths(spftree, isis_vertex_queue_pop(&spftree->tents));
+
+	spf_generate_routes(spftree);
+	spftree->runcount++;
+	spftree->last_run_timestamp = time(NULL);
+	spftree->last_run_monotime = monotime(&time_end);
+	spftree->last_run_duration =
+		((time_end.tv_sec - time_start.tv_sec) * 1000000)
+		+ (time_end.tv_usec - time_start.tv_usec);
+}
+
 static void isis_run_spf_with_protection(struct isis_area *area,
-					 struct isis_spftree *spftree)
+					 struct isis_spftree *spftree,
+					 bool prc)
 {
+	/* Partial route calculation needs a tree from a previous run. */
+	if (prc && spftree->runcount > 0) {
+		isis_run_prc(spftree);
+		return;
+	}
+
 	/* Run forward SPF locally. */
 	memcpy(spftree->sysid, area->isis->sysid, ISIS_SYS_ID_LEN);
 	isis_run_spf(spftree);
@@ -1866,6 +2000,7 @@ static void isis_run_spf_cb(struct thread *thread)
 	struct isis_area *area = run->area;
 	int level = run->level;
 	int have_run = 0;
+	bool prc;
 
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 
@@ -1876,31 +2011,47 @@ static void isis_run_spf_cb(struct thread *thread)
 		return;
 	}
 
+	/*
+	 * If nothing but IP reachability changed the SPT is reused. LFA
+	 * computations depend on the full tree, so they always get a full
+	 * run.
+	 */
+	prc = area->spf_pending_triggers[level - 1]
+		      == (1 << SPF_TRIGGER_PREFIX)
+	      && area->lfa_protected_links[level - 1] == 0
+	      && area->rlfa_protected_links[level - 1] == 0
+	      && area->tilfa_protected_links[level - 1] == 0;
+	area->spf_pending_triggers[level - 1] = 0;
+
 	isis_area_delete_backup_adj_sids(area, level);
 	isis_area_invalidate_routes(area, level);
 
 	if (IS_DEBUG_SPF_EVENTS)
-		zlog_debug("ISIS-SPF (%s) L%d SPF needed, periodic SPF",
-			   area->area_tag, level);
+		zlog_debug("ISIS-SPF (%s) L%d %s needed, periodic SPF",
+			   area->area_tag, level,
+			   prc ? "route calculation" : "SPF");
 
 	if (area->ip_circuits) {
 		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_IPV4][level - 1]);
+			area, area->spftree[SPFTREE_IPV4][level - 1], prc);
 		have_run = 1;
 	}
 	if (area->ipv6_circuits) {
 		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_IPV6][level - 1]);
+			area, area->spftree[SPFTREE_IPV6][level - 1], prc);
 		have_run = 1;
 	}
 	if (area->ipv6_circuits && isis_area_ipv6_dstsrc_enabled(area)) {
 		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_DSTSRC][level - 1]);
+			area, area->spftree[SPFTREE_DSTSRC][level - 1], prc);
 		have_run = 1;
 	}
 
-	if (have_run)
-		area->spf_run_count[level]++;
+	if (have_run) {
+		area->spf_run_count[level - 1]++;
+		if (prc)
+			area->spf_prc_count[level - 1]++;
+	}
 
 	isis_area_verify_routes(area);
 
@@ -1928,8 +2079,31 @@ void isis_spf_timer_free(void *run)
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 }
 
+const char *isis_spf_trigger2str(enum isis_spf_trigger trigger)
+{
+	switch (trigger) {
+	case SPF_TRIGGER_LSP_ADD:
+		return "LSP added";
+	case SPF_TRIGGER_LSP_DEL:
+		return "LSP deleted";
+	case SPF_TRIGGER_LSP_EXPIRED:
+		return "LSP expired";
+	case SPF_TRIGGER_TOPOLOGY:
+		return "Topology change";
+	case SPF_TRIGGER_PREFIX:
+		return "Prefix change";
+	case SPF_TRIGGER_ADJACENCY:
+		return "Adjacency change";
+	case SPF_TRIGGER_MAX:
+		break;
+	}
+
+	return "Unknown";
+}
+
 int _isis_spf_schedule(struct isis_area *area, int level,
-		       const char *func, const char *file, int line)
+		       enum isis_spf_trigger trigger, const char *func,
+		       const char *file, int line)
 {
 	struct isis_spftree *spftree = area->spftree[SPFTREE_IPV4][level - 1];
 	time_t now = monotime(NULL);
@@ -1943,10 +2117,15 @@ int _isis_spf_schedule(struct isis_area *area, int level,
 
 	if (IS_DEBUG_SPF_EVENTS) {
 		zlog_debug(
-			"ISIS-SPF (%s) L%d SPF schedule called, lastrun %d sec ago Caller: %s %s:%d",
-			area->area_tag, level, diff, func, file, line);
+			"ISIS-SPF (%s) L%d SPF schedule called (%s), lastrun %d sec ago Caller: %s %s:%d",
+			area->area_tag, level, isis_spf_trigger2str(trigger),
+			diff, func, file, line);
 	}
 
+	SET_FLAG(area->spf_pending_triggers[level - 1], 1 << trigger);
+	area->spf_trigger_count[level - 1][trigger]++;
+	area->spf_last_trigger[level - 1] = trigger;
+
 	thread_cancel(&area->t_rlfa_rib_update);
 	if (area->spf_delay_ietf[level - 1]) {
 		/* Need to call schedule function also if spf delay is running
@@ -65,11 +65,13 @@ void spftree_area_init(struct isis_area *area);
 void spftree_area_del(struct isis_area *area);
 struct isis_lsp *isis_root_system_lsp(struct lspdb_head *lspdb,
 				      const uint8_t *sysid);
-#define isis_spf_schedule(area, level) \
-	_isis_spf_schedule((area), (level), __func__, \
+#define isis_spf_schedule(area, level, trigger) \
+	_isis_spf_schedule((area), (level), (trigger), __func__, \
 			   __FILE__, __LINE__)
 int _isis_spf_schedule(struct isis_area *area, int level,
-		       const char *func, const char *file, int line);
+		       enum isis_spf_trigger trigger, const char *func,
+		       const char *file, int line);
+const char *isis_spf_trigger2str(enum isis_spf_trigger trigger);
 void isis_print_spftree(struct vty *vty, struct isis_spftree *spftree);
 void isis_print_routes(struct vty *vty, struct isis_spftree *spftree,
 		       bool prefix_sid, bool backup);
@@ -5670,6 +5670,7 @@ void isis_tlvs_add_lsp_entry(struct isis_tlvs *tlvs, struct isis_lsp *lsp)
 {
 	struct isis_lsp_entry *entry = XCALLOC(MTYPE_ISIS_TLV, sizeof(*entry));
 
+	lsp_sync_lifetime(lsp);
 	entry->rem_lifetime = lsp->hdr.rem_lifetime;
 	memcpy(entry->id, lsp->hdr.lsp_id, ISIS_SYS_ID_LEN + 2);
 	entry->checksum = lsp->hdr.checksum;
@@ -23,6 +23,8 @@
 
 #include "hash.h"
 #include "jhash.h"
+#include "monotime.h"
+#include "typesafe.h"
 
 #include "isisd/isisd.h"
 #include "isisd/isis_flags.h"
@@ -34,21 +36,49 @@
 DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE, "ISIS TX Queue");
 DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE_ENTRY, "ISIS TX Queue Entry");
 
+/* Unacknowledged LSPs are sent again after this many seconds */
+#define TX_QUEUE_RETRY_INTERVAL 5
+
+/*
+ * Transmissions are paced in slots of this many milliseconds, sending up to
+ * lsp_tx_rate / (1000 / TX_QUEUE_SLOT_MSEC) LSPs per slot.
+ */
+#define TX_QUEUE_SLOT_MSEC 10
+
+PREDECL_DLIST(tx_queue_list);
+
+/*
+ * Each queue runs off a single timer.  Entries sit either on the pending
+ * list, waiting for their first transmission, or on the retry list.  Since
+ * every retransmission uses the same interval and entries are appended when
+ * they are sent, the retry list is always ordered by due time and only its
+ * head needs to be looked at.
+ */
 struct isis_tx_queue {
 	struct isis_circuit *circuit;
 	void (*send_event)(struct isis_circuit *circuit,
 			   struct isis_lsp *, enum isis_tx_type);
 	struct hash *hash;
+
+	struct tx_queue_list_head pending;
+	struct tx_queue_list_head retry;
+
+	struct thread *t_send;
+	struct timeval t_send_at;   /* when t_send fires */
+	struct timeval paced_until; /* no transmissions before this */
 };
 
 struct isis_tx_queue_entry {
 	struct isis_lsp *lsp;
 	enum isis_tx_type type;
 	bool is_retry;
-	struct thread *retry;
+	struct timeval due;
+	struct tx_queue_list_item item;
 	struct isis_tx_queue *queue;
 };
 
+DECLARE_DLIST(tx_queue_list, struct isis_tx_queue_entry, item);
+
 static unsigned tx_queue_hash_key(const void *p)
 {
 	const struct isis_tx_queue_entry *e = p;
@@ -73,6 +103,11 @@ static bool tx_queue_hash_cmp(const void *a, const void *b)
 	return true;
 }
 
+static struct tx_queue_list_head *tx_queue_list_of(struct isis_tx_queue_entry *e)
+{
+	return e->is_retry ? &e->queue->retry : &e->queue->pending;
+}
+
 struct isis_tx_queue *isis_tx_queue_new(
 		struct isis_circuit *circuit,
 		void(*send_event)(struct isis_circuit *circuit,
@@ -85,6 +120,8 @@ struct isis_tx_queue *isis_tx_queue_new(
 	rv->send_event = send_event;
 
 	rv->hash = hash_create(tx_queue_hash_key, tx_queue_hash_cmp, NULL);
+	tx_queue_list_init(&rv->pending);
+	tx_queue_list_init(&rv->retry);
 	return rv;
 }
 
@@ -92,15 +129,18 @@ static void tx_queue_element_free(void *element)
 {
 	struct isis_tx_queue_entry *e = element;
 
-	thread_cancel(&(e->retry));
+	tx_queue_list_del(tx_queue_list_of(e), e);
 
 	XFREE(MTYPE_TX_QUEUE_ENTRY, e);
 }
 
 void isis_tx_queue_free(struct isis_tx_queue *queue)
 {
+	thread_cancel(&queue->t_send);
 	hash_clean(queue->hash, tx_queue_element_free);
 	hash_free(queue->hash);
+	tx_queue_list_fini(&queue->pending);
+	tx_queue_list_fini(&queue->retry);
 	XFREE(MTYPE_TX_QUEUE, queue);
 }
 
@@ -114,20 +154,110 @@ static struct isis_tx_queue_entry *tx_queue_find(struct isis_tx_queue *queue,
 	return hash_lookup(queue->hash, &e);
 }
 
+static void tx_queue_pacing(struct isis_tx_queue *queue, unsigned int *burst,
+			    unsigned int *slot_msec)
+{
+	unsigned int rate = queue->circuit->area->lsp_tx_rate;
+	unsigned int slots = 1000 / TX_QUEUE_SLOT_MSEC;
+
+	if (rate >= slots) {
+		*burst = rate / slots;
+		*slot_msec = TX_QUEUE_SLOT_MSEC;
+	} else {
+		*burst = 1;
+		*slot_msec = 1000 / MAX(rate, 1U);
+	}
+}
+
+static void tx_queue_send_event(struct thread *thread);
+
+/*
+ * (Re)arm the queue timer for the earliest moment something is due.  The
+ * timer is only touched when that moment moves forward, so adding LSPs to
+ * a busy queue does not cost a timer operation each.
+ */
+static void tx_queue_schedule(struct isis_tx_queue *queue)
+{
+	struct isis_tx_queue_entry *e;
+	struct timeval at, delay;
+	int64_t usec;
+
+	if (tx_queue_list_count(&queue->pending)) {
+		monotime(&at);
+	} else {
+		e = tx_queue_list_first(&queue->retry);
+		if (!e)
+			return;
+		at = e->due;
+	}
+
+	if (timercmp(&at, &queue->paced_until, <))
+		at = queue->paced_until;
+
+	if (queue->t_send) {
+		if (!timercmp(&at, &queue->t_send_at, <))
+			return;
+		thread_cancel(&queue->t_send);
+	}
+
+	usec = MAX(monotime_until(&at, NULL), 0);
+	delay.tv_sec = usec / 1000000;
+	delay.tv_usec = usec % 1000000;
+
+	queue->t_send_at = at;
+	thread_add_timer_tv(master, tx_queue_send_event, queue, &delay,
+			    &queue->t_send);
+}
+
+/*
+ * Send everything that is due, first-time transmissions before
+ * retransmissions, up to the burst allowed by the configured rate.
+ */
 static void tx_queue_send_event(struct thread *thread)
 {
-	struct isis_tx_queue_entry *e = THREAD_ARG(thread);
-	struct isis_tx_queue *queue = e->queue;
+	struct isis_tx_queue *queue = THREAD_ARG(thread);
+	struct isis_tx_queue_entry *e;
+	struct timeval now, due;
+	unsigned int burst, slot_msec, sent = 0;
+
+	tx_queue_pacing(queue, &burst, &slot_msec);
 
-	thread_add_timer(master, tx_queue_send_event, e, 5, &e->retry);
+	monotime(&now);
+	due = now;
+	due.tv_sec += TX_QUEUE_RETRY_INTERVAL;
+
+	while (sent < burst) {
+		e = tx_queue_list_pop(&queue->pending);
+		if (!e) {
+			e = tx_queue_list_first(&queue->retry);
+			if (!e || timercmp(&e->due, &now, >))
+				break;
+
+			tx_queue_list_del(&queue->retry, e);
+			queue->circuit->area->lsp_rxmt_count++;
+		}
 
-	if (e->is_retry)
-		queue->circuit->area->lsp_rxmt_count++;
-	else
 		e->is_retry = true;
+		e->due = due;
+		tx_queue_list_add_tail(&queue->retry, e);
+		sent++;
+
+		queue->send_event(queue->circuit, e->lsp, e->type);
+		/* Don't access e here anymore, send_event might have
+		 * destroyed it
+		 */
+	}
+
+	if (sent) {
+		queue->paced_until = now;
+		queue->paced_until.tv_usec += slot_msec * 1000;
+		while (queue->paced_until.tv_usec >= 1000000) {
+			queue->paced_until.tv_sec++;
+			queue->paced_until.tv_usec -= 1000000;
+		}
+	}
 
-	queue->send_event(queue->circuit, e->lsp, e->type);
-	/* Don't access e here anymore, send_event might have destroyed it */
+	tx_queue_schedule(queue);
 }
 
 void _isis_tx_queue_add(struct isis_tx_queue *queue,
@@ -157,14 +287,15 @@ void _isis_tx_queue_add(struct isis_tx_queue *queue,
 		struct isis_tx_queue_entry *inserted;
 		inserted = hash_get(queue->hash, e, hash_alloc_intern);
 		assert(inserted == e);
+	} else {
+		tx_queue_list_del(tx_queue_list_of(e), e);
 	}
 
 	e->type = type;
-
-	thread_cancel(&(e->retry));
-	thread_add_event(master, tx_queue_send_event, e, 0, &e->retry);
-
 	e->is_retry = false;
+	tx_queue_list_add_tail(&queue->pending, e);
+
+	tx_queue_schedule(queue);
 }
 
 void _isis_tx_queue_del(struct isis_tx_queue *queue, struct isis_lsp *lsp,
@@ -184,10 +315,8 @@ void _isis_tx_queue_del(struct isis_tx_queue *queue, struct isis_lsp *lsp,
 			   func, file, line);
 	}
 
-	thread_cancel(&(e->retry));
-
 	hash_release(queue->hash, e);
-	XFREE(MTYPE_TX_QUEUE_ENTRY, e);
+	tx_queue_element_free(e);
 }
 
 unsigned long isis_tx_queue_len(struct isis_tx_queue *queue)
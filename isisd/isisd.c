@@ -312,6 +312,7 @@ struct isis_area *isis_area_create(const char *area_tag, const char *vrf_name)
 		lsp_db_init(&area->lspdb[0]);
 	if (area->is_type & IS_LEVEL_2)
 		lsp_db_init(&area->lspdb[1]);
+	lsp_aging_init(&area->lsp_aging);
 
 	spftree_area_init(area);
 
@@ -355,6 +356,8 @@ struct isis_area *isis_area_create(const char *area_tag, const char *vrf_name)
 	area->lsp_frag_threshold = 90; /* not currently configurable */
 	area->lsp_mtu =
 		yang_get_default_uint16("/frr-isisd:isis/instance/lsp/mtu");
+	area->lsp_tx_rate =
+		yang_get_default_uint32("/frr-isisd:isis/instance/lsp/tx-rate");
 	area->lfa_load_sharing[0] = yang_get_default_bool(
 		"/frr-isisd:isis/instance/fast-reroute/level-1/lfa/load-sharing");
 	area->lfa_load_sharing[1] = yang_get_default_bool(
@@ -378,6 +381,7 @@ struct isis_area *isis_area_create(const char *area_tag, const char *vrf_name)
 	area->newmetric = 1;
 	area->lsp_frag_threshold = 90;
 	area->lsp_mtu = DEFAULT_LSP_MTU;
+	area->lsp_tx_rate = DEFAULT_LSP_TX_RATE;
 	area->lfa_load_sharing[0] = true;
 	area->lfa_load_sharing[1] = true;
 	area->attached_bit_send = true;
@@ -503,6 +507,7 @@ void isis_area_destroy(struct isis_area *area)
 
 	lsp_db_fini(&area->lspdb[0]);
 	lsp_db_fini(&area->lspdb[1]);
+	lsp_aging_fini(&area->lsp_aging);
 
 	/* invalidate and verify to delete all routes from zebra */
 	isis_area_invalidate_routes(area, area->is_type);
@@ -2261,6 +2266,26 @@ static void isis_spf_ietf_common(struct vty *vty, struct isis *isis)
 			} else {
 				vty_out(vty, "    Using legacy backoff algo\n");
 			}
+
+			vty_out(vty,
+				"    Runs: %" PRIu64
+				", of which route calculation only: %" PRIu64
+				"\n",
+				area->spf_run_count[level - 1],
+				area->spf_prc_count[level - 1]);
+			vty_out(vty, "    Triggers:\n");
+			for (int trigger = 0; trigger < SPF_TRIGGER_MAX;
+			     trigger++)
+				vty_out(vty, "      %-18s %" PRIu64 "\n",
+					isis_spf_trigger2str(trigger),
+					area->spf_trigger_count[level - 1]
+							       [trigger]);
+			if (area->spf_timer[level - 1]
+			    || area->spf_run_count[level - 1])
+				vty_out(vty, "    Last trigger: %s\n",
+					isis_spf_trigger2str(
+						area->spf_last_trigger
+							[level - 1]));
 		}
 	}
 }
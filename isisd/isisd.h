@@ -131,12 +131,26 @@ enum isis_metric_style {
 	ISIS_TRANSITION_METRIC,
 };
 
+/* What made an SPF run necessary; see isis_spf_schedule() */
+enum isis_spf_trigger {
+	SPF_TRIGGER_LSP_ADD = 0,
+	SPF_TRIGGER_LSP_DEL,
+	SPF_TRIGGER_LSP_EXPIRED,
+	SPF_TRIGGER_TOPOLOGY,
+	SPF_TRIGGER_PREFIX,
+	SPF_TRIGGER_ADJACENCY,
+	SPF_TRIGGER_MAX,
+};
+
 struct isis_area {
 	struct isis *isis;			       /* back pointer */
 	struct lspdb_head lspdb[ISIS_LEVELS];	       /* link-state dbs */
+	struct lsp_aging_head lsp_aging;	       /* by expiry time */
 	struct isis_spftree *spftree[SPFTREE_COUNT][ISIS_LEVELS];
 #define DEFAULT_LSP_MTU 1497
 	unsigned int lsp_mtu;      /* Size of LSPs to generate */
+#define DEFAULT_LSP_TX_RATE 10000
+	uint32_t lsp_tx_rate;      /* LSPs per second per circuit */
 	struct list *circuit_list; /* IS-IS circuits */
 	struct list *adjacency_list; /* IS-IS adjacencies */
 	struct flags flags;
@@ -196,6 +210,12 @@ struct isis_area {
 	uint32_t lsp_exceeded_max_counter;
 	uint32_t lsp_seqno_skipped_counter;
 	uint64_t spf_run_count[ISIS_LEVELS];
+	/* SPF triggers seen since the last run, as a bitmask */
+	uint32_t spf_pending_triggers[ISIS_LEVELS];
+	uint64_t spf_trigger_count[ISIS_LEVELS][SPF_TRIGGER_MAX];
+	enum isis_spf_trigger spf_last_trigger[ISIS_LEVELS];
+	/* runs that only recomputed prefixes over the retained SPT */
+	uint64_t spf_prc_count[ISIS_LEVELS];
 	int ip_circuits;
 	/* logging adjacency changes? */
 	uint8_t log_adj_changes;
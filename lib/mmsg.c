@@ -0,0 +1,197 @@
+/*
+ * Batched datagram receive for raw protocol sockets.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "sockopt.h"
+#include "mmsg.h"
+
+DEFINE_MTYPE_STATIC(LIB, MMSG_BATCH, "Datagram receive batch");
+
+/* Room for packet info plus TTL / hop limit, with slack for the rest. */
+#define MMSG_CMSG_SIZE 256
+
+struct mmsg_batch *mmsg_batch_new(int family, unsigned int slots,
+				  size_t bufsize)
+{
+	struct mmsg_batch *batch;
+
+	assert(slots > 0 && bufsize > 0);
+
+	batch = XCALLOC(MTYPE_MMSG_BATCH, sizeof(*batch));
+	batch->family = family;
+	batch->slots = slots;
+	batch->bufsize = bufsize;
+	batch->cmsgsize = MMSG_CMSG_SIZE;
+
+	batch->pkts = XCALLOC(MTYPE_MMSG_BATCH, slots * sizeof(*batch->pkts));
+	batch->mmh = XCALLOC(MTYPE_MMSG_BATCH, slots * sizeof(*batch->mmh));
+	batch->iov = XCALLOC(MTYPE_MMSG_BATCH, slots * sizeof(*batch->iov));
+	batch->names = XCALLOC(MTYPE_MMSG_BATCH, slots * sizeof(*batch->names));
+	batch->bufs = XMALLOC(MTYPE_MMSG_BATCH, slots * bufsize);
+	batch->cmsgs = XMALLOC(MTYPE_MMSG_BATCH, slots * batch->cmsgsize);
+
+	for (unsigned int i = 0; i < slots; i++) {
+		struct msghdr *msgh = &batch->mmh[i].msg_hdr;
+
+		batch->iov[i].iov_base = batch->bufs + i * bufsize;
+		batch->iov[i].iov_len = bufsize;
+
+		msgh->msg_iov = &batch->iov[i];
+		msgh->msg_iovlen = 1;
+		msgh->msg_name = &batch->names[i];
+		msgh->msg_control = batch->cmsgs + i * batch->cmsgsize;
+
+		batch->pkts[i].data = batch->iov[i].iov_base;
+		batch->pkts[i].msgh = msgh;
+	}
+
+	return batch;
+}
+
+void mmsg_batch_free(struct mmsg_batch **batchp)
+{
+	struct mmsg_batch *batch = *batchp;
+
+	if (!batch)
+		return;
+
+	XFREE(MTYPE_MMSG_BATCH, batch->pkts);
+	XFREE(MTYPE_MMSG_BATCH, batch->mmh);
+	XFREE(MTYPE_MMSG_BATCH, batch->iov);
+	XFREE(MTYPE_MMSG_BATCH, batch->names);
+	XFREE(MTYPE_MMSG_BATCH, batch->bufs);
+	XFREE(MTYPE_MMSG_BATCH, batch->cmsgs);
+	XFREE(MTYPE_MMSG_BATCH, *batchp);
+}
+
+static void mmsg_pkt_parse(struct mmsg_batch *batch, struct mmsg_pkt *pkt)
+{
+	struct msghdr *msgh = pkt->msgh;
+	struct cmsghdr *cmsg;
+
+	memset(&pkt->from, 0, sizeof(pkt->from));
+	memcpy(&pkt->from, msgh->msg_name,
+	       MIN(msgh->msg_namelen, sizeof(pkt->from)));
+	memset(&pkt->dst, 0, sizeof(pkt->dst));
+	pkt->ttl = -1;
+	pkt->truncated = !!(msgh->msg_flags & MSG_TRUNC);
+
+	/*
+	 * The IPv4 interface index comes in a platform specific control
+	 * message which getsockopt_ifindex() already knows about; IPv6 only
+	 * has IPV6_PKTINFO, picked up below.
+	 */
+	pkt->ifindex = 0;
+	if (batch->family == AF_INET)
+		pkt->ifindex = getsockopt_ifindex(AF_INET, msgh);
+
+	for (cmsg = CMSG_FIRSTHDR(msgh); cmsg; cmsg = CMSG_NXTHDR(msgh, cmsg)) {
+		if (cmsg->cmsg_level == IPPROTO_IP) {
+#ifdef HAVE_IP_PKTINFO
+			if (cmsg->cmsg_type == IP_PKTINFO) {
+				struct in_pktinfo *pi;
+
+				pi = (struct in_pktinfo *)CMSG_DATA(cmsg);
+				SET_IPADDR_V4(&pkt->dst);
+				pkt->dst.ipaddr_v4 = pi->ipi_addr;
+			}
+#endif
+#ifdef HAVE_IP_RECVDSTADDR
+			if (cmsg->cmsg_type == IP_RECVDSTADDR) {
+				SET_IPADDR_V4(&pkt->dst);
+				memcpy(&pkt->dst.ipaddr_v4, CMSG_DATA(cmsg),
+				       sizeof(struct in_addr));
+			}
+#endif
+#ifdef IP_TTL
+			if (cmsg->cmsg_type == IP_TTL)
+				pkt->ttl = *(int *)CMSG_DATA(cmsg);
+#endif
+#ifdef IP_RECVTTL
+			if (cmsg->cmsg_type == IP_RECVTTL)
+				pkt->ttl = *(uint8_t *)CMSG_DATA(cmsg);
+#endif
+		} else if (cmsg->cmsg_level == IPPROTO_IPV6) {
+			if (cmsg->cmsg_type == IPV6_PKTINFO) {
+				struct in6_pktinfo *pi;
+
+				pi = (struct in6_pktinfo *)CMSG_DATA(cmsg);
+				SET_IPADDR_V6(&pkt->dst);
+				pkt->dst.ipaddr_v6 = pi->ipi6_addr;
+				pkt->ifindex = pi->ipi6_ifindex;
+			}
+			if (cmsg->cmsg_type == IPV6_HOPLIMIT)
+				pkt->ttl = *(int *)CMSG_DATA(cmsg);
+		}
+	}
+}
+
+int mmsg_recv(struct mmsg_batch *batch, int fd, unsigned int max)
+{
+	unsigned int i;
+	int ret;
+
+	batch->count = 0;
+	if (max == 0 || max > batch->slots)
+		max = batch->slots;
+
+	/* the kernel overwrites these on every receive */
+	for (i = 0; i < max; i++) {
+		struct msghdr *msgh = &batch->mmh[i].msg_hdr;
+
+		msgh->msg_namelen = sizeof(batch->names[i]);
+		msgh->msg_controllen = batch->cmsgsize;
+		msgh->msg_flags = 0;
+	}
+
+#ifdef HAVE_RECVMMSG
+	do {
+		ret = recvmmsg(fd, batch->mmh, max, MSG_DONTWAIT, NULL);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0)
+		return -1;
+#else
+	/* one recvmsg() per datagram, still drained in a single call here */
+	for (ret = 0; (unsigned int)ret < max; ret++) {
+		ssize_t len;
+
+		do {
+			len = recvmsg(fd, &batch->mmh[ret].msg_hdr,
+				      MSG_DONTWAIT);
+		} while (len < 0 && errno == EINTR);
+		if (len < 0) {
+			if (ret == 0)
+				return -1;
+			break;
+		}
+		batch->mmh[ret].msg_len = len;
+	}
+#endif
+
+	for (i = 0; i < (unsigned int)ret; i++) {
+		struct mmsg_pkt *pkt = &batch->pkts[i];
+
+		pkt->len = batch->mmh[i].msg_len;
+		mmsg_pkt_parse(batch, pkt);
+	}
+	batch->count = ret;
+
+	return ret;
+}
@@ -0,0 +1,87 @@
+/*
+ * Batched datagram receive for raw protocol sockets.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_MMSG_H
+#define _FRR_MMSG_H
+
+#include "sockunion.h"
+#include "ipaddr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Default number of datagrams read per event loop wakeup. */
+#define MMSG_BATCH_DEFAULT 32
+
+/* One received datagram along with its ancillary data. */
+struct mmsg_pkt {
+	uint8_t *data;
+	size_t len;
+	bool truncated;
+
+	union sockunion from;
+	struct ipaddr dst; /* IPADDR_NONE if not reported */
+	ifindex_t ifindex; /* 0 if not reported */
+	int ttl;	   /* TTL / hop limit, -1 if not reported */
+
+	/* raw header, for protocol-specific control messages */
+	struct msghdr *msgh;
+};
+
+/*
+ * Receive buffers for up to "slots" datagrams of at most "bufsize" bytes
+ * each.  A batch is reused across reads; the packets it hands out are only
+ * valid until the next mmsg_recv() on it.
+ */
+struct mmsg_batch {
+	int family;
+	unsigned int slots;
+	size_t bufsize;
+
+	unsigned int count;
+	struct mmsg_pkt *pkts;
+
+	/* private */
+	struct mmsghdr *mmh;
+	struct iovec *iov;
+	struct sockaddr_storage *names;
+	uint8_t *bufs;
+	uint8_t *cmsgs;
+	size_t cmsgsize;
+};
+
+extern struct mmsg_batch *mmsg_batch_new(int family, unsigned int slots,
+					 size_t bufsize);
+extern void mmsg_batch_free(struct mmsg_batch **batchp);
+
+/*
+ * Read up to "max" (capped at the batch size) pending datagrams from a
+ * non-blocking socket with a single recvmmsg() where available.
+ *
+ * Returns the number of datagrams received, which are then found in
+ * batch->pkts[0 .. count - 1].  Returns -1 with errno set if nothing could
+ * be read, including EAGAIN / EWOULDBLOCK when the socket is drained.
+ */
+extern int mmsg_recv(struct mmsg_batch *batch, int fd, unsigned int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_MMSG_H */
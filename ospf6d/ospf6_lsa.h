@@ -20,6 +20,7 @@
 
 #ifndef OSPF6_LSA_H
 #define OSPF6_LSA_H
+#include "typesafe.h"
 #include "ospf6_top.h"
 #include "lib/json.h"
 
@@ -120,11 +121,13 @@ struct ospf6_lsa_header {
 #define OSPF6_LSA_IS_CHANGED(L1, L2) ospf6_lsa_is_changed (L1, L2)
 #define OSPF6_LSA_IS_SEQWRAP(L) ((L)->header->seqnum == htonl(OSPF_MAX_SEQUENCE_NUMBER + 1))
 
+PREDECL_HASH(ospf6_lsdb_hash);
 
 struct ospf6_lsa {
 	char name[64]; /* dump string */
 
 	struct route_node *rn;
+	struct ospf6_lsdb_hash_item lsdb_hash; /* point lookups in lsdb */
 
 	unsigned char lock; /* reference counter */
 	unsigned char flag; /* special meaning (e.g. floodback) */
@@ -34,9 +34,35 @@
 #include "ospf6_route.h"
 #include "ospf6d.h"
 #include "bitfield.h"
+#include "jhash.h"
 
 DEFINE_MTYPE_STATIC(OSPF6D, OSPF6_LSDB, "OSPF6 LSA database");
 
+/*
+ * The route_table keyed on (type, adv_router, id) provides the ordering
+ * that the ALL_LSDB* walks and get-next rely on; exact-match lookups,
+ * which dominate in SPF and flooding, go through this hash instead of
+ * descending the radix tree.
+ */
+static int ospf6_lsdb_hash_cmp(const struct ospf6_lsa *a,
+			       const struct ospf6_lsa *b)
+{
+	if (a->header->type != b->header->type)
+		return numcmp(a->header->type, b->header->type);
+	if (a->header->adv_router != b->header->adv_router)
+		return numcmp(a->header->adv_router, b->header->adv_router);
+	return numcmp(a->header->id, b->header->id);
+}
+
+static uint32_t ospf6_lsdb_hash_key(const struct ospf6_lsa *lsa)
+{
+	return jhash_3words(lsa->header->type, lsa->header->adv_router,
+			    lsa->header->id, 0xa3d0f56b);
+}
+
+DECLARE_HASH(ospf6_lsdb_hash, struct ospf6_lsa, lsdb_hash, ospf6_lsdb_hash_cmp,
+	     ospf6_lsdb_hash_key);
+
 struct ospf6_lsdb *ospf6_lsdb_create(void *data)
 {
 	struct ospf6_lsdb *lsdb;
@@ -46,6 +72,7 @@ struct ospf6_lsdb *ospf6_lsdb_create(void *data)
 
 	lsdb->data = data;
 	lsdb->table = route_table_init();
+	ospf6_lsdb_hash_init(&lsdb->hash);
 	return lsdb;
 }
 
@@ -54,6 +81,7 @@ void ospf6_lsdb_delete(struct ospf6_lsdb *lsdb)
 	if (lsdb != NULL) {
 		ospf6_lsdb_remove_all(lsdb);
 		route_table_finish(lsdb->table);
+		ospf6_lsdb_hash_fini(&lsdb->hash);
 		XFREE(MTYPE_OSPF6_LSDB, lsdb);
 	}
 }
@@ -120,6 +148,12 @@ void ospf6_lsdb_add(struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
 	lsa->rn = current;
 	ospf6_lsa_lock(lsa);
 
+	if (old != lsa) {
+		if (old)
+			ospf6_lsdb_hash_del(&lsdb->hash, old);
+		ospf6_lsdb_hash_add(&lsdb->hash, lsa);
+	}
+
 	if (!old) {
 		lsdb->count++;
 		ospf6_lsdb_stats_update(lsa, lsdb, 1);
@@ -173,6 +207,7 @@ void ospf6_lsdb_remove(struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
 	assert(node && node->info == lsa);
 
 	node->info = NULL;
+	ospf6_lsdb_hash_del(&lsdb->hash, lsa);
 	lsdb->count--;
 	ospf6_lsdb_stats_update(lsa, lsdb, -1);
 
@@ -190,23 +225,17 @@ struct ospf6_lsa *ospf6_lsdb_lookup(uint16_t type, uint32_t id,
 				    uint32_t adv_router,
 				    struct ospf6_lsdb *lsdb)
 {
-	struct route_node *node;
-	struct prefix_ipv6 key;
+	struct ospf6_lsa_header hdr = {};
+	struct ospf6_lsa ref = {.header = &hdr};
 
 	if (lsdb == NULL)
 		return NULL;
 
-	memset(&key, 0, sizeof(key));
-	ospf6_lsdb_set_key(&key, &type, sizeof(type));
-	ospf6_lsdb_set_key(&key, &adv_router, sizeof(adv_router));
-	ospf6_lsdb_set_key(&key, &id, sizeof(id));
+	hdr.type = type;
+	hdr.id = id;
+	hdr.adv_router = adv_router;
 
-	node = route_node_lookup(lsdb->table, (struct prefix *)&key);
-	if (node == NULL || node->info == NULL)
-		return NULL;
-
-	route_unlock_node(node);
-	return (struct ospf6_lsa *)node->info;
+	return ospf6_lsdb_hash_find(&lsdb->hash, &ref);
 }
 
 struct ospf6_lsa *ospf6_find_external_lsa(struct ospf6 *ospf6, struct prefix *p)
@@ -27,7 +27,8 @@
 
 struct ospf6_lsdb {
 	void *data; /* data structure that holds this lsdb */
-	struct route_table *table;
+	struct route_table *table; /* ordered, for iteration */
+	struct ospf6_lsdb_hash_head hash; /* exact-match lookups */
 	uint32_t count;
 	uint32_t stats[OSPF6_LSTYPE_SIZE];
 	void (*hook_add)(struct ospf6_lsa *);
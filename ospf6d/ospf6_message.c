@@ -28,6 +28,7 @@
 #include "linklist.h"
 #include "lib_errors.h"
 #include "checksum.h"
+#include "mmsg.h"
 
 #include "ospf6_proto.h"
 #include "ospf6_lsa.h"
@@ -1727,23 +1728,25 @@ static void ospf6_lsack_recv(struct in6_addr *src, struct in6_addr *dst,
 	assert(p == OSPF6_MESSAGE_END(oh));
 }
 
-static uint8_t *recvbuf = NULL;
+/* Datagrams fetched per recvmmsg() on the raw socket. */
+#define OSPF6_RECV_BATCH 16
+
+static struct mmsg_batch *recvbatch = NULL;
 static uint8_t *sendbuf = NULL;
 static unsigned int iobuflen = 0;
 
 int ospf6_iobuf_size(unsigned int size)
 {
-	uint8_t *recvnew, *sendnew;
+	uint8_t *sendnew;
 
 	if (size <= iobuflen)
 		return iobuflen;
 
-	recvnew = XMALLOC(MTYPE_OSPF6_MESSAGE, size);
 	sendnew = XMALLOC(MTYPE_OSPF6_MESSAGE, size);
 
-	XFREE(MTYPE_OSPF6_MESSAGE, recvbuf);
+	mmsg_batch_free(&recvbatch);
 	XFREE(MTYPE_OSPF6_MESSAGE, sendbuf);
-	recvbuf = recvnew;
+	recvbatch = mmsg_batch_new(AF_INET6, OSPF6_RECV_BATCH, size);
 	sendbuf = sendnew;
 	iobuflen = size;
 
@@ -1752,63 +1755,47 @@ int ospf6_iobuf_size(unsigned int size)
 
 void ospf6_message_terminate(void)
 {
-	XFREE(MTYPE_OSPF6_MESSAGE, recvbuf);
+	mmsg_batch_free(&recvbatch);
 	XFREE(MTYPE_OSPF6_MESSAGE, sendbuf);
 
 	iobuflen = 0;
 }
 
-enum ospf6_read_return_enum {
-	OSPF6_READ_ERROR,
-	OSPF6_READ_CONTINUE,
-};
-
-static int ospf6_read_helper(int sockfd, struct ospf6 *ospf6)
+static void ospf6_read_helper(struct ospf6 *ospf6, struct mmsg_pkt *pkt)
 {
-	int len;
+	int len = pkt->len;
 	struct in6_addr src, dst;
-	ifindex_t ifindex;
-	struct iovec iovector[2];
+	ifindex_t ifindex = pkt->ifindex;
 	struct ospf6_interface *oi;
 	struct ospf6_header *oh;
 	enum ospf6_auth_err ret = OSPF6_AUTH_PROCESS_NORMAL;
 	uint32_t at_len = 0;
 	uint32_t lls_len = 0;
 
-	/* initialize */
-	memset(&src, 0, sizeof(src));
-	memset(&dst, 0, sizeof(dst));
-	ifindex = 0;
-	memset(recvbuf, 0, iobuflen);
-	iovector[0].iov_base = recvbuf;
-	iovector[0].iov_len = iobuflen;
-	iovector[1].iov_base = NULL;
-	iovector[1].iov_len = 0;
-
-	/* receive message */
-	len = ospf6_recvmsg(&src, &dst, &ifindex, iovector, sockfd);
-	if (len < 0)
-		return OSPF6_READ_ERROR;
-
-	if ((uint)len > iobuflen) {
-		flog_err(EC_LIB_DEVELOPMENT, "Excess message read");
-		return OSPF6_READ_ERROR;
+	if (pkt->truncated) {
+		zlog_warn("recvmsg read full buffer size: %d", len);
+		return;
 	}
 
+	src = pkt->from.sin6.sin6_addr;
+	memset(&dst, 0, sizeof(dst));
+	if (IS_IPADDR_V6(&pkt->dst))
+		dst = pkt->dst.ipaddr_v6;
+
 	oi = ospf6_interface_lookup_by_ifindex(ifindex, ospf6->vrf_id);
 	if (oi == NULL || oi->area == NULL
 	    || CHECK_FLAG(oi->flag, OSPF6_INTERFACE_DISABLE)) {
 		if (IS_OSPF6_DEBUG_MESSAGE(OSPF6_MESSAGE_TYPE_UNKNOWN,
 					   RECV_HDR))
 			zlog_debug("Message received on disabled interface");
-		return OSPF6_READ_CONTINUE;
+		return;
 	}
 	if (CHECK_FLAG(oi->flag, OSPF6_INTERFACE_PASSIVE)) {
 		if (IS_OSPF6_DEBUG_MESSAGE(OSPF6_MESSAGE_TYPE_UNKNOWN,
 					   RECV_HDR))
 			zlog_debug("%s: Ignore message on passive interface %s",
 				   __func__, oi->interface->name);
-		return OSPF6_READ_CONTINUE;
+		return;
 	}
 
 	/*
@@ -1816,9 +1803,9 @@ static int ospf6_read_helper(int sockfd, struct ospf6 *ospf6)
 	 * This happens when raw_l3mdev_accept is set to 1.
 	 */
 	if (ospf6->vrf_id != oi->interface->vrf->vrf_id)
-		return OSPF6_READ_CONTINUE;
+		return;
 
-	oh = (struct ospf6_header *)recvbuf;
+	oh = (struct ospf6_header *)pkt->data;
 	ret = ospf6_auth_validate_pkt(oi, (uint32_t *)&len, oh, &at_len,
 				      &lls_len);
 	if (ret == OSPF6_AUTH_VALIDATE_SUCCESS) {
@@ -1830,15 +1817,15 @@ static int ospf6_read_helper(int sockfd, struct ospf6 *ospf6)
 					oi->interface->name,
 					ospf6_message_type(oh->type));
 			oi->at_data.rx_drop++;
-			return OSPF6_READ_CONTINUE;
+			return;
 		}
 	} else if (ret == OSPF6_AUTH_VALIDATE_FAILURE) {
 		oi->at_data.rx_drop++;
-		return OSPF6_READ_CONTINUE;
+		return;
 	}
 
 	if (ospf6_rxpacket_examin(oi, oh, len) != MSG_OK)
-		return OSPF6_READ_CONTINUE;
+		return;
 
 	/* Being here means, that no sizing/alignment issues were detected in
 	   the input packet. This renders the additional checks performed below
@@ -1901,8 +1888,6 @@ static int ospf6_read_helper(int sockfd, struct ospf6 *ospf6)
 	default:
 		assert(0);
 	}
-
-	return OSPF6_READ_CONTINUE;
 }
 
 void ospf6_receive(struct thread *thread)
@@ -1910,6 +1895,7 @@ void ospf6_receive(struct thread *thread)
 	int sockfd;
 	struct ospf6 *ospf6;
 	int count = 0;
+	int i, n;
 
 	/* add next read thread */
 	ospf6 = THREAD_ARG(thread);
@@ -1918,13 +1904,25 @@ void ospf6_receive(struct thread *thread)
 	thread_add_read(master, ospf6_receive, ospf6, ospf6->fd,
 			&ospf6->t_ospf6_receive);
 
+	if (!recvbatch)
+		return;
+
+	/*
+	 * Drain up to write_oi_count packets per wakeup, fetched from the
+	 * socket in batches rather than one recvmsg() each.
+	 */
 	while (count < ospf6->write_oi_count) {
-		count++;
-		switch (ospf6_read_helper(sockfd, ospf6)) {
-		case OSPF6_READ_ERROR:
+		n = mmsg_recv(recvbatch, sockfd, ospf6->write_oi_count - count);
+		if (n < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				zlog_warn("recvmmsg failed: %s",
+					  safe_strerror(errno));
 			return;
-		case OSPF6_READ_CONTINUE:
-			break;
+		}
+
+		for (i = 0; i < n; i++) {
+			count++;
+			ospf6_read_helper(ospf6, &recvbatch->pkts[i]);
 		}
 	}
 }
@@ -213,54 +213,3 @@ int ospf6_sendmsg(struct in6_addr *src, struct in6_addr *dst,
 
 	return retval;
 }
-
-int ospf6_recvmsg(struct in6_addr *src, struct in6_addr *dst,
-		  ifindex_t *ifindex, struct iovec *message, int ospf6_sock)
-{
-	int retval;
-	struct msghdr rmsghdr;
-	struct cmsghdr *rcmsgp;
-	uint8_t cmsgbuf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
-	struct in6_pktinfo *pktinfo;
-	struct sockaddr_in6 src_sin6;
-
-	rcmsgp = (struct cmsghdr *)cmsgbuf;
-	pktinfo = (struct in6_pktinfo *)(CMSG_DATA(rcmsgp));
-	memset(&src_sin6, 0, sizeof(struct sockaddr_in6));
-
-	/* receive control msg */
-	rcmsgp->cmsg_level = IPPROTO_IPV6;
-	rcmsgp->cmsg_type = IPV6_PKTINFO;
-	rcmsgp->cmsg_len = CMSG_LEN(sizeof(struct in6_pktinfo));
-	/* rcmsgp = CMSG_NXTHDR (&rmsghdr, rcmsgp); */
-
-	/* receive msg hdr */
-	memset(&rmsghdr, 0, sizeof(rmsghdr));
-	rmsghdr.msg_iov = message;
-	rmsghdr.msg_iovlen = iov_count(message);
-	rmsghdr.msg_name = (caddr_t)&src_sin6;
-	rmsghdr.msg_namelen = sizeof(struct sockaddr_in6);
-	rmsghdr.msg_control = (caddr_t)cmsgbuf;
-	rmsghdr.msg_controllen = sizeof(cmsgbuf);
-
-	retval = recvmsg(ospf6_sock, &rmsghdr, MSG_DONTWAIT);
-	if (retval < 0) {
-		if (errno != EAGAIN && errno != EWOULDBLOCK)
-			zlog_warn("stream_recvmsg failed: %s",
-				  safe_strerror(errno));
-		return retval;
-	} else if (retval == iov_totallen(message))
-		zlog_warn("recvmsg read full buffer size: %d", retval);
-
-	/* source address */
-	assert(src);
-	memcpy(src, &src_sin6.sin6_addr, sizeof(struct in6_addr));
-
-	/* destination address */
-	if (ifindex)
-		*ifindex = pktinfo->ipi6_ifindex;
-	if (dst)
-		memcpy(dst, &pktinfo->ipi6_addr, sizeof(struct in6_addr));
-
-	return retval;
-}
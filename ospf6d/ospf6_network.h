@@ -32,9 +32,6 @@ extern int ospf6_sso(ifindex_t ifindex, struct in6_addr *group, int option,
 extern int ospf6_sendmsg(struct in6_addr *src, struct in6_addr *dst,
 			 ifindex_t ifindex, struct iovec *message,
 			 int ospf6_sock);
-extern int ospf6_recvmsg(struct in6_addr *src, struct in6_addr *dst,
-			 ifindex_t *ifindex, struct iovec *message,
-			 int ospf6_sock);
 
 #define OSPF6_MESSAGE_WRITE_ON(oi)                                             \
 	do {                                                                   \
@@ -47,6 +47,7 @@
 #include "ospf6_zebra.h"
 
 DEFINE_MTYPE_STATIC(OSPF6D, OSPF6_VERTEX, "OSPF6 vertex");
+DEFINE_MTYPE_STATIC(OSPF6D, OSPF6_VERTEX_NH, "OSPF6 vertex nexthops");
 
 unsigned char conf_debug_ospf6_spf = 0;
 
@@ -54,14 +55,14 @@ static void ospf6_spf_copy_nexthops_to_route(struct ospf6_route *rt,
 					     struct ospf6_vertex *v)
 {
 	if (rt && v)
-		ospf6_copy_nexthops(rt->nh_list, v->nh_list);
+		ospf6_copy_nexthops(rt->nh_list, v->nh->list);
 }
 
 static void ospf6_spf_merge_nexthops_to_route(struct ospf6_route *rt,
 					      struct ospf6_vertex *v)
 {
 	if (rt && v)
-		ospf6_merge_nexthops(rt->nh_list, v->nh_list);
+		ospf6_merge_nexthops(rt->nh_list, v->nh->list);
 }
 
 static unsigned int ospf6_spf_get_ifindex_from_nh(struct ospf6_vertex *v)
@@ -70,7 +71,7 @@ static unsigned int ospf6_spf_get_ifindex_from_nh(struct ospf6_vertex *v)
 	struct listnode *node;
 
 	if (v) {
-		node = listhead(v->nh_list);
+		node = listhead(v->nh->list);
 		if (node) {
 			nh = listgetdata(node);
 			if (nh)
@@ -85,13 +86,41 @@ static int ospf6_vertex_cmp(const struct ospf6_vertex *va,
 {
 	/* ascending order */
 	if (va->cost != vb->cost)
-		return (va->cost - vb->cost);
-	if (va->hops != vb->hops)
-		return (va->hops - vb->hops);
-	return 0;
+		return numcmp(va->cost, vb->cost);
+	return numcmp(va->hops, vb->hops);
+}
+DECLARE_HEAP(vertex_pqueue, struct ospf6_vertex, pqi, ospf6_vertex_cmp);
+
+static struct ospf6_vertex_nh *ospf6_vertex_nh_new(void)
+{
+	struct ospf6_vertex_nh *nh;
+
+	nh = XCALLOC(MTYPE_OSPF6_VERTEX_NH, sizeof(*nh));
+	nh->list = list_new();
+	nh->list->cmp = (int (*)(void *, void *))ospf6_nexthop_cmp;
+	nh->list->del = (void (*)(void *))ospf6_nexthop_delete;
+	nh->refcnt = 1;
+
+	return nh;
+}
+
+static struct ospf6_vertex_nh *ospf6_vertex_nh_ref(struct ospf6_vertex_nh *nh)
+{
+	nh->refcnt++;
+	return nh;
+}
+
+static void ospf6_vertex_nh_unref(struct ospf6_vertex_nh **nhp)
+{
+	struct ospf6_vertex_nh *nh = *nhp;
+
+	*nhp = NULL;
+	if (!nh || --nh->refcnt)
+		return;
+
+	list_delete(&nh->list);
+	XFREE(MTYPE_OSPF6_VERTEX_NH, nh);
 }
-DECLARE_SKIPLIST_NONUNIQ(vertex_pqueue, struct ospf6_vertex, pqi,
-		ospf6_vertex_cmp);
 
 static int ospf6_vertex_id_cmp(void *a, void *b)
 {
@@ -150,9 +179,8 @@ static struct ospf6_vertex *ospf6_vertex_create(struct ospf6_lsa *lsa)
 	v->options[1] = *(uint8_t *)(OSPF6_LSA_HEADER_END(lsa->header) + 2);
 	v->options[2] = *(uint8_t *)(OSPF6_LSA_HEADER_END(lsa->header) + 3);
 
-	v->nh_list = list_new();
-	v->nh_list->cmp = (int (*)(void *, void *))ospf6_nexthop_cmp;
-	v->nh_list->del = (void (*)(void *))ospf6_nexthop_delete;
+	/* nexthop set is filled in, or shared, by the SPF loop */
+	v->nh = NULL;
 
 	v->parent = NULL;
 	v->child_list = list_new();
@@ -163,7 +191,7 @@ static struct ospf6_vertex *ospf6_vertex_create(struct ospf6_lsa *lsa)
 
 static void ospf6_vertex_delete(struct ospf6_vertex *v)
 {
-	list_delete(&v->nh_list);
+	ospf6_vertex_nh_unref(&v->nh);
 	list_delete(&v->child_list);
 	XFREE(MTYPE_OSPF6_VERTEX, v);
 }
@@ -313,7 +341,7 @@ static void ospf6_nexthop_calc(struct ospf6_vertex *w, struct ospf6_vertex *v,
 			zlog_debug("  nexthop %s from %s", buf, lsa->name);
 		}
 
-		ospf6_add_nexthop(w->nh_list, ifindex,
+		ospf6_add_nexthop(w->nh->list, ifindex,
 				  &link_lsa->linklocal_addr);
 		i++;
 	}
@@ -505,6 +533,7 @@ void ospf6_spf_calculation(uint32_t router_id,
 	root->cost = 0;
 	root->hops = 0;
 	root->link_id = lsa->header->id;
+	root->nh = ospf6_vertex_nh_new();
 	inet_pton(AF_INET6, "::1", &address);
 
 	/* Actually insert root to the candidate-list as the only candidate */
@@ -555,14 +584,16 @@ void ospf6_spf_calculation(uint32_t router_id,
 			}
 
 			/* nexthop calculation */
-			if (w->hops == 0)
+			if (w->hops == 0) {
+				w->nh = ospf6_vertex_nh_new();
 				ospf6_add_nexthop(
-					w->nh_list,
+					w->nh->list,
 					ROUTER_LSDESC_GET_IFID(lsdesc), NULL);
-			else if (w->hops == 1 && v->hops == 0)
+			} else if (w->hops == 1 && v->hops == 0) {
+				w->nh = ospf6_vertex_nh_new();
 				ospf6_nexthop_calc(w, v, lsdesc, oa->ospf6);
-			else
-				ospf6_copy_nexthops(w->nh_list, v->nh_list);
+			} else
+				w->nh = ospf6_vertex_nh_ref(v->nh);
 
 
 			/* add new candidate to the candidate_list */
@@ -574,7 +605,7 @@ void ospf6_spf_calculation(uint32_t router_id,
 		}
 	}
 
-	//vertex_pqueue_fini(&candidate_list);
+	vertex_pqueue_fini(&candidate_list);
 
 	ospf6_remove_temp_router_lsa(oa);
 
@@ -37,7 +37,18 @@ extern unsigned char conf_debug_ospf6_spf;
 
 #define OSPF6_ASE_CALC_INTERVAL 1
 
-PREDECL_SKIPLIST_NONUNIQ(vertex_pqueue);
+PREDECL_HEAP(vertex_pqueue);
+
+/*
+ * Nexthop set of a vertex.  Vertices more than one hop away inherit the
+ * nexthops of their parent unchanged, so they share the parent's set
+ * rather than each holding a copy.
+ */
+struct ospf6_vertex_nh {
+	struct list *list;
+	unsigned int refcnt;
+};
+
 /* Transit Vertex */
 struct ospf6_vertex {
 	/* type of this vertex */
@@ -74,7 +85,7 @@ struct ospf6_vertex {
 	struct list *child_list;
 
 	/* nexthops to this node */
-	struct list *nh_list;
+	struct ospf6_vertex_nh *nh;
 	uint32_t link_id;
 };
 
@@ -24,6 +24,7 @@
 #include "thread.h"
 #include "memory.h"
 #include "hash.h"
+#include "jhash.h"
 #include "linklist.h"
 #include "prefix.h"
 #include "if.h"
@@ -44,6 +45,110 @@
 #include "ospfd/ospf_ase.h"
 #include "ospfd/ospf_zebra.h"
 #include "ospfd/ospf_dump.h"
+#include "ospfd/ospf_memory.h"
+
+/*
+ * Every AS external route is calculated through the routing table entry of
+ * the originating ASBR and, if the LSA carries one, of the forwarding
+ * address.  The destinations calculated through each of them are recorded
+ * here while routes are calculated, so that after an SPF only destinations
+ * whose ASBR or forwarding address route changed are calculated again.
+ * The index is rebuilt by every full calculation and only grows in
+ * between; a stale entry just costs an unneeded recalculation.
+ */
+enum ospf_ase_dep_type {
+	OSPF_ASE_DEP_ASBR = 0,
+	OSPF_ASE_DEP_FWD_ADDR,
+};
+
+struct ospf_ase_dep {
+	enum ospf_ase_dep_type type;
+	struct in_addr addr;
+
+	/* Destinations, the route_node info points back to the dep. */
+	struct route_table *prefixes;
+};
+
+static unsigned int ospf_ase_dep_hash_key(const void *arg)
+{
+	const struct ospf_ase_dep *dep = arg;
+
+	return jhash_2words(dep->addr.s_addr, dep->type, 0);
+}
+
+static bool ospf_ase_dep_hash_cmp(const void *arg1, const void *arg2)
+{
+	const struct ospf_ase_dep *dep1 = arg1;
+	const struct ospf_ase_dep *dep2 = arg2;
+
+	return dep1->type == dep2->type
+	       && IPV4_ADDR_SAME(&dep1->addr, &dep2->addr);
+}
+
+static void *ospf_ase_dep_alloc(void *arg)
+{
+	struct ospf_ase_dep *lookup = arg;
+	struct ospf_ase_dep *dep;
+
+	dep = XCALLOC(MTYPE_OSPF_ASE_DEP, sizeof(*dep));
+	dep->type = lookup->type;
+	dep->addr = lookup->addr;
+	dep->prefixes = route_table_init();
+
+	return dep;
+}
+
+static void ospf_ase_dep_free(void *arg)
+{
+	struct ospf_ase_dep *dep = arg;
+
+	route_table_finish(dep->prefixes);
+	XFREE(MTYPE_OSPF_ASE_DEP, dep);
+}
+
+static void ospf_ase_dep_add(struct ospf *ospf, enum ospf_ase_dep_type type,
+			     struct in_addr addr, struct prefix_ipv4 *p)
+{
+	struct ospf_ase_dep lookup = {.type = type, .addr = addr};
+	struct ospf_ase_dep *dep;
+	struct route_node *rn;
+
+	dep = hash_get(ospf->ase_deps, &lookup, ospf_ase_dep_alloc);
+
+	rn = route_node_get(dep->prefixes, (struct prefix *)p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = dep;
+}
+
+static void ospf_ase_mark_dirty(struct ospf *ospf, struct prefix *p)
+{
+	struct route_node *rn;
+
+	rn = route_node_get(ospf->ase_dirty, p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = ospf;
+}
+
+void ospf_ase_init(struct ospf *ospf)
+{
+	ospf->ase_deps = hash_create(ospf_ase_dep_hash_key,
+				     ospf_ase_dep_hash_cmp,
+				     "OSPF AS-external route dependencies");
+	ospf->ase_dirty = route_table_init();
+}
+
+void ospf_ase_finish(struct ospf *ospf)
+{
+	hash_clean(ospf->ase_deps, ospf_ase_dep_free);
+	hash_free(ospf->ase_deps);
+	ospf->ase_deps = NULL;
+	route_table_finish(ospf->ase_dirty);
+	ospf->ase_dirty = NULL;
+}
 
 struct ospf_route *ospf_find_asbr_route(struct ospf *ospf,
 					struct route_table *rtrs,
@@ -252,6 +357,19 @@ int ospf_ase_calculate_route(struct ospf *ospf, struct ospf_lsa *lsa)
 		return 0;
 	}
 
+	/* Set prefix. */
+	p.family = AF_INET;
+	p.prefix = al->header.id;
+	p.prefixlen = ip_masklen(al->mask);
+	apply_mask_ipv4(&p);
+
+	/* From here on the result depends on the routes to the ASBR and
+	   to the forwarding address. */
+	ospf_ase_dep_add(ospf, OSPF_ASE_DEP_ASBR, al->header.adv_router, &p);
+	if (al->e[0].fwd_addr.s_addr != INADDR_ANY)
+		ospf_ase_dep_add(ospf, OSPF_ASE_DEP_FWD_ADDR,
+				 al->e[0].fwd_addr, &p);
+
 	/* (3) Call the destination described by the LSA N.  N's address is
 	       obtained by masking the LSA's Link State ID with the
 	       network/subnet mask contained in the body of the LSA.  Look
@@ -367,11 +485,6 @@ int ospf_ase_calculate_route(struct ospf *ospf, struct ospf_lsa *lsa)
 	       preference, it is added to N's routing table entry's list of
 	       paths. */
 
-	/* Set prefix. */
-	p.family = AF_INET;
-	p.prefix = al->header.id;
-	p.prefixlen = ip_masklen(al->mask);
-
 	/* if there is a Intra/Inter area route to the N
 	   do not install external route */
 	if ((rn = route_node_lookup(ospf->new_table, (struct prefix *)&p))) {
@@ -564,6 +677,63 @@ static int ospf_ase_compare_tables(struct ospf *ospf,
 	return 0;
 }
 
+/*
+ * Calculate the external route to a single destination again from all the
+ * LSAs describing it, and hand the difference over to zebra.
+ */
+static void ospf_ase_update_prefix(struct ospf *ospf, struct prefix_ipv4 *p)
+{
+	struct route_node *rn, *old_rn, *new_rn;
+	struct ospf_route *old_or = NULL, *new_or = NULL;
+	struct ospf_lsa *lsa;
+	struct listnode *node;
+
+	rn = route_node_lookup(ospf->external_lsas, (struct prefix *)p);
+	if (rn) {
+		for (ALL_LIST_ELEMENTS_RO((struct list *)rn->info, node, lsa))
+			ospf_ase_calculate_route(ospf, lsa);
+		route_unlock_node(rn);
+	}
+
+	old_rn = route_node_lookup(ospf->old_external_route,
+				   (struct prefix *)p);
+	if (old_rn) {
+		old_or = old_rn->info;
+		route_unlock_node(old_rn);
+	}
+	new_rn = route_node_lookup(ospf->new_external_route,
+				   (struct prefix *)p);
+	if (new_rn) {
+		new_or = new_rn->info;
+		route_unlock_node(new_rn);
+	}
+
+	/* install changes to zebra */
+	if (!new_or) {
+		if (old_or)
+			ospf_zebra_delete(ospf, p, old_or);
+	} else if (!old_or
+		   || !ospf_ase_route_match_same(ospf->old_external_route,
+						 (struct prefix *)p, new_or))
+		ospf_zebra_add(ospf, p, new_or);
+
+	/* move the new route over to ospf->old_external_route */
+	if (old_or)
+		ospf_route_free(old_or);
+
+	if (new_or) {
+		if (!old_rn)
+			old_rn = route_node_get(ospf->old_external_route,
+						(struct prefix *)p);
+		old_rn->info = new_or;
+		new_rn->info = NULL;
+		route_unlock_node(new_rn);
+	} else if (old_rn) {
+		old_rn->info = NULL;
+		route_unlock_node(old_rn);
+	}
+}
+
 static void ospf_ase_calculate_timer(struct thread *t)
 {
 	struct ospf *ospf;
@@ -572,6 +742,7 @@ static void ospf_ase_calculate_timer(struct thread *t)
 	struct listnode *node;
 	struct ospf_area *area;
 	struct timeval start_time, stop_time;
+	unsigned long count = 0;
 
 	ospf = THREAD_ARG(t);
 	ospf->t_ase_calc = NULL;
@@ -581,6 +752,11 @@ static void ospf_ase_calculate_timer(struct thread *t)
 
 		monotime(&start_time);
 
+		/* Everything is calculated again, so is the index. */
+		hash_clean(ospf->ase_deps, ospf_ase_dep_free);
+		route_table_finish(ospf->ase_dirty);
+		ospf->ase_dirty = route_table_init();
+
 		/* Calculate external route for each AS-external-LSA */
 		LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
 			ospf_ase_calculate_route(ospf, lsa);
@@ -621,6 +797,31 @@ static void ospf_ase_calculate_timer(struct thread *t)
 						* 1000000LL
 					+ (stop_time.tv_usec
 					   - start_time.tv_usec));
+	} else if (ospf->ase_dirty->count) {
+		monotime(&start_time);
+
+		/* Only destinations whose ASBR or forwarding address route
+		   changed in the SPF(s) since the last calculation. */
+		for (rn = route_top(ospf->ase_dirty); rn; rn = route_next(rn))
+			if (rn->info) {
+				ospf_ase_update_prefix(
+					ospf, (struct prefix_ipv4 *)&rn->p);
+				count++;
+			}
+
+		route_table_finish(ospf->ase_dirty);
+		ospf->ase_dirty = route_table_init();
+
+		monotime(&stop_time);
+
+		if (IS_DEBUG_OSPF_EVENT)
+			zlog_info(
+				"SPF Processing Time(usecs): External Routes: %lld (%lu destinations)",
+				(stop_time.tv_sec - start_time.tv_sec)
+						* 1000000LL
+					+ (stop_time.tv_usec
+					   - start_time.tv_usec),
+				count);
 	}
 
 	/*
@@ -633,12 +834,146 @@ static void ospf_ase_calculate_timer(struct thread *t)
 	}
 }
 
-void ospf_ase_calculate_schedule(struct ospf *ospf)
+/* The routing table entry an external route through dep would use. */
+static struct ospf_route *ospf_ase_dep_resolve(struct ospf *ospf,
+					       struct ospf_ase_dep *dep,
+					       struct route_table *rt,
+					       struct route_table *rtrs)
 {
+	struct prefix_ipv4 p;
+	struct route_node *rn;
+	struct ospf_route *or;
+
+	p.family = AF_INET;
+	p.prefix = dep->addr;
+	p.prefixlen = IPV4_MAX_BITLEN;
+
+	if (dep->type == OSPF_ASE_DEP_ASBR)
+		return ospf_find_asbr_route(ospf, rtrs, &p);
+
+	rn = route_node_match(rt, (struct prefix *)&p);
+	if (!rn)
+		return NULL;
+
+	or = rn->info;
+	route_unlock_node(rn);
+
+	return or;
+}
+
+static bool ospf_ase_dep_route_same(struct ospf_route *or1,
+				    struct ospf_route *or2)
+{
+	struct listnode *n1, *n2;
+	struct ospf_path *op1, *op2;
+
+	if (!or1 || !or2)
+		return or1 == or2;
+
+	if (or1->path_type != or2->path_type || or1->cost != or2->cost
+	    || or1->u.std.flags != or2->u.std.flags
+	    || or1->u.std.external_routing != or2->u.std.external_routing)
+		return false;
+
+	if (listcount(or1->paths) != listcount(or2->paths))
+		return false;
+
+	for (n1 = listhead(or1->paths), n2 = listhead(or2->paths); n1 && n2;
+	     n1 = listnextnode_unchecked(n1), n2 = listnextnode_unchecked(n2)) {
+		op1 = listgetdata(n1);
+		op2 = listgetdata(n2);
+
+		if (!IPV4_ADDR_SAME(&op1->nexthop, &op2->nexthop)
+		    || op1->ifindex != op2->ifindex)
+			return false;
+	}
+
+	return true;
+}
+
+struct ospf_ase_dep_check_args {
+	struct ospf *ospf;
+	struct route_table *new_table;
+	struct route_table *new_rtrs;
+};
+
+static int ospf_ase_dep_check(struct hash_bucket *bucket, void *arg)
+{
+	struct ospf_ase_dep_check_args *args = arg;
+	struct ospf_ase_dep *dep = bucket->data;
+	struct ospf *ospf = args->ospf;
+	struct ospf_route *old_or, *new_or;
+	struct route_node *rn;
+
+	old_or = ospf_ase_dep_resolve(ospf, dep, ospf->new_table,
+				      ospf->new_rtrs);
+	new_or = ospf_ase_dep_resolve(ospf, dep, args->new_table,
+				      args->new_rtrs);
+	if (ospf_ase_dep_route_same(old_or, new_or))
+		return HASHWALK_CONTINUE;
+
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug(
+			"%s: route to %s %pI4 changed, %lu external destinations affected",
+			__func__,
+			dep->type == OSPF_ASE_DEP_ASBR ? "ASBR"
+						       : "forwarding address",
+			&dep->addr, dep->prefixes->count);
+
+	for (rn = route_top(dep->prefixes); rn; rn = route_next(rn))
+		if (rn->info)
+			ospf_ase_mark_dirty(ospf, &rn->p);
+
+	return HASHWALK_CONTINUE;
+}
+
+/*
+ * Called by the SPF with the tables it is about to install, while
+ * ospf->new_table and ospf->new_rtrs still hold the previous ones.
+ */
+void ospf_ase_calculate_schedule(struct ospf *ospf,
+				 struct route_table *new_table,
+				 struct route_table *new_rtrs, bool full)
+{
+	struct ospf_ase_dep_check_args args;
+	struct route_node *rn, *rn2;
+
 	if (ospf == NULL)
 		return;
 
-	ospf->ase_calc = 1;
+	if (full || !ospf->new_table || !ospf->new_rtrs) {
+		ospf->ase_calc = 1;
+		return;
+	}
+
+	/* A full calculation is already pending. */
+	if (ospf->ase_calc)
+		return;
+
+	args.ospf = ospf;
+	args.new_table = new_table;
+	args.new_rtrs = new_rtrs;
+	hash_walk(ospf->ase_deps, ospf_ase_dep_check, &args);
+
+	/* Destinations no longer hidden by an intra/inter-area route; the
+	   reverse is taken care of by ospf_route_install(). */
+	for (rn = route_top(ospf->new_table); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		rn2 = route_node_lookup(new_table, &rn->p);
+		if (rn2) {
+			route_unlock_node(rn2);
+			continue;
+		}
+
+		rn2 = route_node_lookup(ospf->external_lsas, &rn->p);
+		if (rn2) {
+			if (listcount((struct list *)rn2->info))
+				ospf_ase_mark_dirty(ospf, &rn->p);
+			route_unlock_node(rn2);
+		}
+	}
 }
 
 void ospf_ase_calculate_timer_add(struct ospf *ospf)
@@ -721,11 +1056,8 @@ void ospf_ase_external_lsas_finish(struct route_table *rt)
 
 void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 {
-	struct list *lsas;
-	struct listnode *node;
-	struct route_node *rn, *rn2;
+	struct route_node *rn;
 	struct prefix_ipv4 p;
-	struct route_table *tmp_old;
 	struct as_external_lsa *al;
 
 	al = (struct as_external_lsa *)lsa->data;
@@ -750,53 +1082,5 @@ void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 			return;
 	}
 
-	rn = route_node_lookup(ospf->external_lsas, (struct prefix *)&p);
-	assert(rn);
-	assert(rn->info);
-	lsas = rn->info;
-	route_unlock_node(rn);
-
-	for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
-		ospf_ase_calculate_route(ospf, lsa);
-
-	/* prepare temporary old routing table for compare */
-	tmp_old = route_table_init();
-	rn = route_node_lookup(ospf->old_external_route, (struct prefix *)&p);
-	if (rn && rn->info) {
-		rn2 = route_node_get(tmp_old, (struct prefix *)&p);
-		rn2->info = rn->info;
-		route_unlock_node(rn);
-	}
-
-	/* install changes to zebra */
-	ospf_ase_compare_tables(ospf, ospf->new_external_route, tmp_old);
-
-	/* update ospf->old_external_route table */
-	if (rn && rn->info)
-		ospf_route_free((struct ospf_route *)rn->info);
-
-	rn2 = route_node_lookup(ospf->new_external_route, (struct prefix *)&p);
-	/* if new route exists, install it to ospf->old_external_route */
-	if (rn2 && rn2->info) {
-		if (!rn)
-			rn = route_node_get(ospf->old_external_route,
-					    (struct prefix *)&p);
-		rn->info = rn2->info;
-	} else {
-		/* remove route node from ospf->old_external_route */
-		if (rn) {
-			rn->info = NULL;
-			route_unlock_node(rn);
-		}
-	}
-
-	if (rn2) {
-		/* rn2->info is stored in route node of ospf->old_external_route
-		 */
-		rn2->info = NULL;
-		route_unlock_node(rn2);
-		route_unlock_node(rn2);
-	}
-
-	route_table_finish(tmp_old);
+	ospf_ase_update_prefix(ospf, &p);
 }
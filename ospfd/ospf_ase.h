@@ -29,7 +29,10 @@ ospf_find_asbr_route_through_area(struct route_table *, struct prefix_ipv4 *,
 				  struct ospf_area *);
 
 extern int ospf_ase_calculate_route(struct ospf *, struct ospf_lsa *);
-extern void ospf_ase_calculate_schedule(struct ospf *);
+extern void ospf_ase_calculate_schedule(struct ospf *ospf,
+					struct route_table *new_table,
+					struct route_table *new_rtrs,
+					bool full);
 extern void ospf_ase_calculate_timer_add(struct ospf *);
 
 extern void ospf_ase_external_lsas_finish(struct route_table *);
@@ -37,4 +40,7 @@ extern void ospf_ase_incremental_update(struct ospf *, struct ospf_lsa *);
 extern void ospf_ase_register_external_lsa(struct ospf_lsa *, struct ospf *);
 extern void ospf_ase_unregister_external_lsa(struct ospf_lsa *, struct ospf *);
 
+extern void ospf_ase_init(struct ospf *ospf);
+extern void ospf_ase_finish(struct ospf *ospf);
+
 #endif /* _ZEBRA_OSPF_ASE_H */
@@ -231,6 +231,7 @@ struct ospf_interface {
 	struct list *opaque_lsa_self;      /* Type-9 Opaque-LSAs */
 
 	struct route_table *ls_upd_queue;
+	uint32_t ls_upd_queue_bytes; /* LSA bytes queued since last flush */
 
 	struct list *ls_ack; /* Link State Acknowledgment list. */
 
@@ -247,7 +248,7 @@ struct ospf_interface {
 	struct thread *t_wait;		  /* timer */
 	struct thread *t_ls_ack;	  /* timer */
 	struct thread *t_ls_ack_direct;   /* event */
-	struct thread *t_ls_upd_event;    /* event */
+	struct thread *t_ls_upd_event;    /* timer */
 	struct thread *t_opaque_lsa_self; /* Type-9 Opaque-LSAs */
 
 	int on_write_q;
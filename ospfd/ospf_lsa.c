@@ -186,6 +186,7 @@ struct ospf_lsa *ospf_lsa_new(void)
 	monotime(&new->tv_recv);
 	new->tv_orig = new->tv_recv;
 	new->refresh_list = -1;
+	new->maxage_list = -1;
 	new->vrf_id = VRF_DEFAULT;
 	new->to_be_acknowledged = 0;
 
@@ -224,6 +225,7 @@ struct ospf_lsa *ospf_lsa_dup(struct ospf_lsa *lsa)
 	   queue (which it's not a member of.)
 	   XXX: Should we add the LSA to the refresh_list queue? */
 	new->refresh_list = -1;
+	new->maxage_list = -1;
 
 	if (IS_DEBUG_OSPF(lsa, LSA))
 		zlog_debug("LSA: duplicated %p (new: %p)", (void *)lsa,
@@ -245,6 +247,7 @@ void ospf_lsa_free(struct ospf_lsa *lsa)
 		ospf_lsa_data_free(lsa->data);
 
 	assert(lsa->refresh_list < 0);
+	assert(lsa->maxage_list < 0);
 
 	memset(lsa, 0, sizeof(struct ospf_lsa));
 	XFREE(MTYPE_OSPF_LSA, lsa);
@@ -2781,6 +2784,8 @@ void ospf_discard_from_db(struct ospf *ospf, struct ospf_lsdb *lsdb,
 
 	if (old->refresh_list >= 0)
 		ospf_refresher_unregister_lsa(ospf, old);
+	if (old->maxage_list >= 0)
+		ospf_maxage_walker_unregister_lsa(ospf, old);
 
 	switch (old->data->type) {
 	case OSPF_AS_EXTERNAL_LSA:
@@ -2996,6 +3001,10 @@ struct ospf_lsa *ospf_lsa_install(struct ospf *ospf, struct ospf_interface *oi,
 		ospf_lsa_maxage(ospf, lsa);
 	}
 
+	/* Others' LSAs are timed out by the MaxAge walker. */
+	if (!IS_LSA_SELF(new))
+		ospf_maxage_walker_register_lsa(ospf, new);
+
 	return new;
 }
 
@@ -3270,44 +3279,108 @@ static int ospf_lsa_maxage_walker_remover(struct ospf *ospf,
 	return 0;
 }
 
+/*
+ * LSAs originated by other routers are kept on a timing wheel, in the slot
+ * of the walker run at which they will have reached MaxAge.  Each run of the
+ * walker then only looks at the LSAs that are due instead of the whole LSDB.
+ */
+void ospf_maxage_walker_register_lsa(struct ospf *ospf, struct ospf_lsa *lsa)
+{
+	uint16_t index, current_index;
+	int due;
+
+	if (lsa->maxage_list >= 0)
+		return;
+
+	due = OSPF_LSA_MAXAGE - LS_AGE(lsa);
+	if (due < 0)
+		due = 0;
+
+	current_index = ospf->lsa_maxage_queue.index
+			+ (monotime(NULL) - ospf->lsa_maxage_walker_started)
+				  / OSPF_LSA_MAXAGE_CHECK_INTERVAL;
+
+	/* round up, the walker only ever runs for slots in the past */
+	index = (current_index + (due + OSPF_LSA_MAXAGE_CHECK_INTERVAL - 1)
+					 / OSPF_LSA_MAXAGE_CHECK_INTERVAL)
+		% OSPF_LSA_MAXAGE_SLOTS;
+
+	if (!ospf->lsa_maxage_queue.qs[index])
+		ospf->lsa_maxage_queue.qs[index] = list_new();
+
+	listnode_add(ospf->lsa_maxage_queue.qs[index],
+		     ospf_lsa_lock(lsa)); /* lsa_maxage_queue */
+	lsa->maxage_list = index;
+}
+
+void ospf_maxage_walker_unregister_lsa(struct ospf *ospf, struct ospf_lsa *lsa)
+{
+	struct list *maxage_list;
+
+	if (lsa->maxage_list < 0)
+		return;
+
+	maxage_list = ospf->lsa_maxage_queue.qs[lsa->maxage_list];
+	listnode_delete(maxage_list, lsa);
+	if (!listcount(maxage_list)) {
+		list_delete(&maxage_list);
+		ospf->lsa_maxage_queue.qs[lsa->maxage_list] = NULL;
+	}
+	lsa->maxage_list = -1;
+	ospf_lsa_unlock(&lsa); /* lsa_maxage_queue */
+}
+
 /* Periodical check of MaxAge LSA. */
 void ospf_lsa_maxage_walker(struct thread *thread)
 {
 	struct ospf *ospf = THREAD_ARG(thread);
-	struct route_node *rn;
-	struct ospf_lsa *lsa;
-	struct ospf_area *area;
+	struct list *maxage_list;
+	struct list *lsa_to_check = list_new();
 	struct listnode *node, *nnode;
+	struct ospf_lsa *lsa;
+	int i;
 
 	ospf->t_maxage_walker = NULL;
 
-	for (ALL_LIST_ELEMENTS(ospf->areas, node, nnode, area)) {
-		LSDB_LOOP (ROUTER_LSDB(area), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
-		LSDB_LOOP (NETWORK_LSDB(area), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
-		LSDB_LOOP (SUMMARY_LSDB(area), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
-		LSDB_LOOP (ASBR_SUMMARY_LSDB(area), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
-		LSDB_LOOP (OPAQUE_AREA_LSDB(area), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
-		LSDB_LOOP (OPAQUE_LINK_LSDB(area), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
-		LSDB_LOOP (NSSA_LSDB(area), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
-	}
+	i = ospf->lsa_maxage_queue.index;
+	ospf->lsa_maxage_queue.index =
+		((unsigned long)(ospf->lsa_maxage_queue.index
+				 + (monotime(NULL)
+				    - ospf->lsa_maxage_walker_started)
+					   / OSPF_LSA_MAXAGE_CHECK_INTERVAL))
+		% OSPF_LSA_MAXAGE_SLOTS;
+
+	for (; i != ospf->lsa_maxage_queue.index;
+	     i = (i + 1) % OSPF_LSA_MAXAGE_SLOTS) {
+		maxage_list = ospf->lsa_maxage_queue.qs[i];
+		ospf->lsa_maxage_queue.qs[i] = NULL;
+		if (!maxage_list)
+			continue;
 
-	/* for AS-external-LSAs. */
-	if (ospf->lsdb) {
-		LSDB_LOOP (EXTERNAL_LSDB(ospf), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
-		LSDB_LOOP (OPAQUE_AS_LSDB(ospf), rn, lsa)
-			ospf_lsa_maxage_walker_remover(ospf, lsa);
+		/* the queue's lock moves over to lsa_to_check */
+		for (ALL_LIST_ELEMENTS(maxage_list, node, nnode, lsa)) {
+			lsa->maxage_list = -1;
+			listnode_add(lsa_to_check, lsa);
+		}
+		list_delete(&maxage_list);
 	}
 
+	ospf->lsa_maxage_walker_started = monotime(NULL);
 	OSPF_TIMER_ON(ospf->t_maxage_walker, ospf_lsa_maxage_walker,
 		      OSPF_LSA_MAXAGE_CHECK_INTERVAL);
+
+	for (ALL_LIST_ELEMENTS(lsa_to_check, node, nnode, lsa)) {
+		if (!CHECK_FLAG(lsa->flags, OSPF_LSA_DISCARD)) {
+			if (IS_LSA_MAXAGE(lsa))
+				ospf_lsa_maxage_walker_remover(ospf, lsa);
+			else
+				/* not quite there yet, e.g. a second early */
+				ospf_maxage_walker_register_lsa(ospf, lsa);
+		}
+		ospf_lsa_unlock(&lsa); /* lsa_to_check */
+	}
+
+	list_delete(&lsa_to_check);
 }
 
 struct ospf_lsa *ospf_lsa_lookup_by_prefix(struct ospf_lsdb *lsdb, uint8_t type,
@@ -3901,18 +3974,22 @@ void ospf_refresher_register_lsa(struct ospf *ospf, struct ospf_lsa *lsa)
 
 	if (lsa->refresh_list < 0) {
 		int delay;
-		int min_delay =
-			OSPF_LS_REFRESH_TIME - (2 * OSPF_LS_REFRESH_JITTER);
 		int max_delay = OSPF_LS_REFRESH_TIME - OSPF_LS_REFRESH_JITTER;
+		int min_delay = max_delay / 2;
 
 		/* We want to refresh the LSA within OSPF_LS_REFRESH_TIME which
-		 * is
-		 * 1800s. Use jitter so that we send the LSA sometime between
-		 * 1680s
-		 * and 1740s.
+		 * is 1800s.  A freshly originated LSA is placed anywhere
+		 * between 870s and 1740s, so that a bunch of LSAs originated
+		 * at the same time (startup, redistribution, ...) get spread
+		 * over the wheel instead of being refreshed in one burst every
+		 * 30 minutes.  Once refreshed by the walker an LSA keeps its
+		 * place, a full 1740s further on.
 		 */
-		delay = (frr_weak_random() % (max_delay - min_delay))
-			+ min_delay;
+		if (ospf->lsa_refresher_running)
+			delay = max_delay;
+		else
+			delay = (frr_weak_random() % (max_delay - min_delay))
+				+ min_delay;
 
 		current_index = ospf->lsa_refresh_queue.index
 				+ (monotime(NULL) - ospf->lsa_refresher_started)
@@ -3959,11 +4036,39 @@ void ospf_refresher_unregister_lsa(struct ospf *ospf, struct ospf_lsa *lsa)
 	}
 }
 
+/* Account a walker refresh to the LSA's flooding scope. */
+static void ospf_lsa_refresh_count(struct ospf *ospf, struct ospf_lsa *lsa)
+{
+	uint32_t *count, *last, *peak;
+
+	switch (lsa->data->type) {
+	case OSPF_AS_EXTERNAL_LSA:
+	case OSPF_OPAQUE_AS_LSA:
+		count = &ospf->lsa_refresh_count;
+		last = &ospf->lsa_refresh_last;
+		peak = &ospf->lsa_refresh_peak;
+		break;
+	default:
+		if (!lsa->area)
+			return;
+		count = &lsa->area->lsa_refresh_count;
+		last = &lsa->area->lsa_refresh_last;
+		peak = &lsa->area->lsa_refresh_peak;
+		break;
+	}
+
+	(*count)++;
+	(*last)++;
+	if (*last > *peak)
+		*peak = *last;
+}
+
 void ospf_lsa_refresh_walker(struct thread *t)
 {
 	struct list *refresh_list;
 	struct listnode *node, *nnode;
 	struct ospf *ospf = THREAD_ARG(t);
+	struct ospf_area *area;
 	struct ospf_lsa *lsa;
 	int i;
 	struct list *lsa_to_refresh = list_new();
@@ -4027,12 +4132,22 @@ void ospf_lsa_refresh_walker(struct thread *t)
 			 ospf->lsa_refresh_interval, &ospf->t_lsa_refresher);
 	ospf->lsa_refresher_started = monotime(NULL);
 
+	ospf->lsa_refresh_last = 0;
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		area->lsa_refresh_last = 0;
+
+	/* The refreshed LSAs are flooded through the interfaces' LS Update
+	 * queues, and so end up packed together in as few packets as fit.
+	 */
+	ospf->lsa_refresher_running = true;
 	for (ALL_LIST_ELEMENTS(lsa_to_refresh, node, nnode, lsa)) {
+		ospf_lsa_refresh_count(ospf, lsa);
 		ospf_lsa_refresh(ospf, lsa);
 		assert(lsa->lock > 0);
 		ospf_lsa_unlock(
 			&lsa); /* lsa_refresh_queue & temp for lsa_to_refresh*/
 	}
+	ospf->lsa_refresher_running = false;
 
 	list_delete(&lsa_to_refresh);
 
@@ -115,6 +115,9 @@ struct ospf_lsa {
 	/* Refreshement List or Queue */
 	int refresh_list;
 
+	/* MaxAge walker slot, for LSAs originated by others */
+	int maxage_list;
+
 	/* For Type-9 Opaque-LSAs */
 	struct ospf_interface *oi;
 
@@ -328,6 +331,10 @@ extern void ospf_schedule_lsa_flush_area(struct ospf_area *, struct ospf_lsa *);
 
 extern void ospf_refresher_register_lsa(struct ospf *, struct ospf_lsa *);
 extern void ospf_refresher_unregister_lsa(struct ospf *, struct ospf_lsa *);
+extern void ospf_maxage_walker_register_lsa(struct ospf *ospf,
+					    struct ospf_lsa *lsa);
+extern void ospf_maxage_walker_unregister_lsa(struct ospf *ospf,
+					      struct ospf_lsa *lsa);
 extern void ospf_lsa_refresh_walker(struct thread *thread);
 
 extern void ospf_lsa_maxage_delete(struct ospf *, struct ospf_lsa *);
@@ -38,6 +38,7 @@
 #endif
 #include "vrf.h"
 #include "lib_errors.h"
+#include "mmsg.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_network.h"
@@ -2297,33 +2298,16 @@ static void ospf_ls_ack(struct ip *iph, struct ospf_header *ospfh,
 	return;
 }
 
-static struct stream *ospf_recv_packet(struct ospf *ospf, int fd,
+static struct stream *ospf_recv_packet(struct ospf *ospf,
+				       struct mmsg_pkt *pkt,
 				       struct interface **ifp,
 				       struct stream *ibuf)
 {
-	int ret;
+	int ret = pkt->len;
 	struct ip *iph;
 	uint16_t ip_len;
 	ifindex_t ifindex = 0;
-	struct iovec iov;
-	/* Header and data both require alignment. */
-	char buff[CMSG_SPACE(SOPT_SIZE_CMSG_IFINDEX_IPV4())];
-	struct msghdr msgh;
-
-	memset(&msgh, 0, sizeof(struct msghdr));
-	msgh.msg_iov = &iov;
-	msgh.msg_iovlen = 1;
-	msgh.msg_control = (caddr_t)buff;
-	msgh.msg_controllen = sizeof(buff);
-
-	ret = stream_recvmsg(ibuf, fd, &msgh, MSG_DONTWAIT,
-			     OSPF_MAX_PACKET_SIZE + 1);
-	if (ret < 0) {
-		if (errno != EAGAIN && errno != EWOULDBLOCK)
-			flog_warn(EC_OSPF_PACKET, "stream_recvmsg failed: %s",
-				  safe_strerror(errno));
-		return NULL;
-	}
+
 	if ((unsigned int)ret < sizeof(struct ip)) {
 		flog_warn(
 			EC_OSPF_PACKET,
@@ -2332,6 +2316,8 @@ static struct stream *ospf_recv_packet(struct ospf *ospf, int fd,
 		return NULL;
 	}
 
+	stream_put(ibuf, pkt->data, pkt->len);
+
 	/* Note that there should not be alignment problems with this assignment
 	   because this is at the beginning of the stream data buffer. */
 	iph = (struct ip *)STREAM_DATA(ibuf);
@@ -2366,7 +2352,7 @@ static struct stream *ospf_recv_packet(struct ospf *ospf, int fd,
 	ip_len = ntohs(iph->ip_len) + (iph->ip_hl << 2);
 #endif
 
-	ifindex = getsockopt_ifindex(AF_INET, &msgh);
+	ifindex = pkt->ifindex;
 
 	*ifp = if_lookup_by_index(ifindex, ospf->vrf_id);
 
@@ -2379,8 +2365,8 @@ static struct stream *ospf_recv_packet(struct ospf *ospf, int fd,
 	}
 
 	if (IS_DEBUG_OSPF_PACKET(0, RECV))
-		zlog_debug("%s: fd %d(%s) on interface %d(%s)", __func__, fd,
-			   ospf_get_name(ospf), ifindex,
+		zlog_debug("%s: fd %d(%s) on interface %d(%s)", __func__,
+			   ospf->fd, ospf_get_name(ospf), ifindex,
 			   *ifp ? (*ifp)->name : "Unknown");
 	return ibuf;
 }
@@ -2956,7 +2942,8 @@ enum ospf_read_return_enum {
 	OSPF_READ_CONTINUE,
 };
 
-static enum ospf_read_return_enum ospf_read_helper(struct ospf *ospf)
+static enum ospf_read_return_enum ospf_read_helper(struct ospf *ospf,
+						    struct mmsg_pkt *pkt)
 {
 	int ret;
 	struct stream *ibuf;
@@ -2968,7 +2955,7 @@ static enum ospf_read_return_enum ospf_read_helper(struct ospf *ospf)
 	struct interface *ifp = NULL;
 
 	stream_reset(ospf->ibuf);
-	ibuf = ospf_recv_packet(ospf, ospf->fd, &ifp, ospf->ibuf);
+	ibuf = ospf_recv_packet(ospf, pkt, &ifp, ospf->ibuf);
 	if (ibuf == NULL)
 		return OSPF_READ_ERROR;
 
@@ -3211,7 +3198,8 @@ void ospf_read(struct thread *thread)
 {
 	struct ospf *ospf;
 	int32_t count = 0;
-	enum ospf_read_return_enum ret;
+	enum ospf_read_return_enum ret = OSPF_READ_CONTINUE;
+	int i, n;
 
 	/* first of all get interface pointer. */
 	ospf = THREAD_ARG(thread);
@@ -3219,14 +3207,28 @@ void ospf_read(struct thread *thread)
 	/* prepare for next packet. */
 	thread_add_read(master, ospf_read, ospf, ospf->fd, &ospf->t_read);
 
-	while (count < ospf->write_oi_count) {
-		count++;
-		ret = ospf_read_helper(ospf);
-		switch (ret) {
-		case OSPF_READ_ERROR:
+	/*
+	 * Drain up to write_oi_count packets per wakeup, fetching them from
+	 * the socket in batches rather than one recvmsg() each.  Packets
+	 * already fetched are always processed, an error only stops further
+	 * reads.
+	 */
+	while (count < ospf->write_oi_count && ret == OSPF_READ_CONTINUE) {
+		n = mmsg_recv(ospf->rbatch, ospf->fd,
+			      ospf->write_oi_count - count);
+		if (n < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				flog_warn(EC_OSPF_PACKET,
+					  "recvmmsg failed: %s",
+					  safe_strerror(errno));
 			return;
-		case OSPF_READ_CONTINUE:
-			break;
+		}
+
+		for (i = 0; i < n; i++) {
+			count++;
+			if (ospf_read_helper(ospf, &ospf->rbatch->pkts[i])
+			    == OSPF_READ_ERROR)
+				ret = OSPF_READ_ERROR;
 		}
 	}
 }
@@ -4119,6 +4121,7 @@ static void ospf_ls_upd_send_queue_event(struct thread *thread)
 	char again = 0;
 
 	oi->t_ls_upd_event = NULL;
+	oi->ls_upd_queue_bytes = 0;
 
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("ospf_ls_upd_send_queue start");
@@ -4200,9 +4203,12 @@ void ospf_ls_upd_send(struct ospf_neighbor *nbr, struct list *update, int flag,
 	else
 		route_unlock_node(rn);
 
-	for (ALL_LIST_ELEMENTS_RO(update, node, lsa))
+	for (ALL_LIST_ELEMENTS_RO(update, node, lsa)) {
 		listnode_add(rn->info,
 			     ospf_lsa_lock(lsa)); /* oi->ls_upd_queue */
+		oi->ls_upd_queue_bytes += ntohs(lsa->data->length);
+	}
+
 	if (send_lsupd_now) {
 		struct list *send_update_list;
 		struct route_node *rnext;
@@ -4218,9 +4224,24 @@ void ospf_ls_upd_send(struct ospf_neighbor *nbr, struct list *update, int flag,
 			ospf_ls_upd_queue_send(oi, send_update_list,
 					       rn->p.u.prefix4, 1);
 		}
-	} else
+	} else if (oi->ls_upd_queue_bytes
+		   >= ospf_packet_max(oi) - OSPF_LS_UPD_MIN_SIZE) {
+		/*
+		 * At least one full LS Update is ready; waiting any longer
+		 * only grows the queue, so flush it right away.
+		 */
+		THREAD_OFF(oi->t_ls_upd_event);
 		thread_add_event(master, ospf_ls_upd_send_queue_event, oi, 0,
 				 &oi->t_ls_upd_event);
+	} else
+		/*
+		 * Otherwise hold the queue briefly so LSAs originated or
+		 * received in a burst are packed into as few LS Update
+		 * packets as the MTU allows, instead of one per event.
+		 */
+		thread_add_timer_msec(master, ospf_ls_upd_send_queue_event, oi,
+				      OSPF_LS_UPD_COALESCE_MSEC,
+				      &oi->t_ls_upd_event);
 }
 
 static void ospf_ls_ack_send_list(struct ospf_interface *oi, struct list *ack,
@@ -4277,6 +4298,18 @@ void ospf_ls_ack_send(struct ospf_neighbor *nbr, struct ospf_lsa *lsa)
 				   __func__);
 	}
 
+	/*
+	 * Direct acks are batched until the event runs, but a batch has a
+	 * single destination: send what is pending for another neighbor
+	 * before starting a batch for this one.
+	 */
+	if (listcount(oi->ls_ack_direct.ls_ack)
+	    && !IPV4_ADDR_SAME(&oi->ls_ack_direct.dst,
+			       &nbr->address.u.prefix4))
+		while (listcount(oi->ls_ack_direct.ls_ack))
+			ospf_ls_ack_send_list(oi, oi->ls_ack_direct.ls_ack,
+					      oi->ls_ack_direct.dst);
+
 	if (listcount(oi->ls_ack_direct.ls_ack) == 0)
 		oi->ls_ack_direct.dst = nbr->address.u.prefix4;
 
@@ -45,6 +45,12 @@
 
 #define OSPF_HELLO_REPLY_DELAY          1
 
+/* Datagrams fetched per recvmmsg() on the raw socket. */
+#define OSPF_RECV_BATCH                 16
+
+/* Window over which queued LSAs are coalesced into LS Update packets. */
+#define OSPF_LS_UPD_COALESCE_MSEC       10
+
 /* Return values of functions involved in packet verification, see ospf6d. */
 #define MSG_OK    0
 #define MSG_NG    1
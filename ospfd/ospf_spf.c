@@ -1852,7 +1852,11 @@ static void ospf_spf_calculate_schedule_worker(struct thread *thread)
 	 * There is a dedicated routing table for external routes which is not
 	 * handled here directly
 	 */
-	ospf_ase_calculate_schedule(ospf);
+	ospf_ase_calculate_schedule(
+		ospf, new_table, new_rtrs,
+		CHECK_FLAG(spf_reason_flags,
+			   (1 << SPF_FLAG_CONFIG_CHANGE)
+				   | (1 << SPF_FLAG_GR_FINISH)));
 	ospf_ase_calculate_timer_add(ospf);
 
 	if (IS_DEBUG_OSPF_EVENT)
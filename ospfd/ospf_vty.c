@@ -2953,6 +2953,13 @@ static void show_ip_ospf_area(struct vty *vty, struct ospf_area *area,
 		/* Show SPF calculation times. */
 		json_object_int_add(json_area, "spfExecutedCounter",
 				    area->spf_calculation);
+		/* Show LSA refresh statistics. */
+		json_object_int_add(json_area, "lsaRefreshCounter",
+				    area->lsa_refresh_count);
+		json_object_int_add(json_area, "lsaRefreshLastInterval",
+				    area->lsa_refresh_last);
+		json_object_int_add(json_area, "lsaRefreshPeakInterval",
+				    area->lsa_refresh_peak);
 		json_object_int_add(json_area, "lsaNumber", area->lsdb->total);
 		json_object_int_add(
 			json_area, "lsaRouterNumber",
@@ -3008,6 +3015,12 @@ static void show_ip_ospf_area(struct vty *vty, struct ospf_area *area,
 		vty_out(vty, "   SPF algorithm executed %d times\n",
 			area->spf_calculation);
 
+		/* Show LSA refresh statistics. */
+		vty_out(vty,
+			"   LSA refreshed %u times, %u in the last refresh interval (peak %u)\n",
+			area->lsa_refresh_count, area->lsa_refresh_last,
+			area->lsa_refresh_peak);
+
 		/* Show number of LSA. */
 		vty_out(vty, "   Number of LSA %ld\n", area->lsdb->total);
 		vty_out(vty,
@@ -3251,6 +3264,12 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 		/* Show refresh parameters. */
 		json_object_int_add(json_vrf, "refreshTimerMsecs",
 				    ospf->lsa_refresh_interval * 1000);
+		json_object_int_add(json_vrf, "lsaExternalRefreshCounter",
+				    ospf->lsa_refresh_count);
+		json_object_int_add(json_vrf, "lsaExternalRefreshLastInterval",
+				    ospf->lsa_refresh_last);
+		json_object_int_add(json_vrf, "lsaExternalRefreshPeakInterval",
+				    ospf->lsa_refresh_peak);
 
 		/* show max multipath */
 		json_object_int_add(json_vrf, "maximumPaths",
@@ -3279,6 +3298,10 @@ static int show_ip_ospf_common(struct vty *vty, struct ospf *ospf,
 		/* Show refresh parameters. */
 		vty_out(vty, " Refresh timer %d secs\n",
 			ospf->lsa_refresh_interval);
+		vty_out(vty,
+			" AS-scope LSA refreshed %u times, %u in the last refresh interval (peak %u)\n",
+			ospf->lsa_refresh_count, ospf->lsa_refresh_last,
+			ospf->lsa_refresh_peak);
 
 		/* show max multipath */
 		vty_out(vty, " Maximum multiple paths(ECMP) supported %d\n",
@@ -40,6 +40,7 @@
 #include "defaults.h"
 #include "lib_errors.h"
 #include "ldp_sync.h"
+#include "mmsg.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_bfd.h"
@@ -350,6 +351,7 @@ struct ospf *ospf_new_alloc(unsigned short instance, const char *name)
 	new->new_external_route = route_table_init();
 	new->old_external_route = route_table_init();
 	new->external_lsas = route_table_init();
+	ospf_ase_init(new);
 
 	new->stub_router_startup_time = OSPF_STUB_ROUTER_UNCONFIGURED;
 	new->stub_router_shutdown_time = OSPF_STUB_ROUTER_UNCONFIGURED;
@@ -375,9 +377,11 @@ struct ospf *ospf_new_alloc(unsigned short instance, const char *name)
 	/* MaxAge init. */
 	new->maxage_delay = OSPF_LSA_MAXAGE_REMOVE_DELAY_DEFAULT;
 	new->maxage_lsa = route_table_init();
+	new->lsa_maxage_queue.index = 0;
 	new->t_maxage_walker = NULL;
 	thread_add_timer(master, ospf_lsa_maxage_walker, new,
 			 OSPF_LSA_MAXAGE_CHECK_INTERVAL, &new->t_maxage_walker);
+	new->lsa_maxage_walker_started = monotime(NULL);
 
 	/* Max paths initialization */
 	new->max_multipath = MULTIPATH_NUM;
@@ -393,6 +397,8 @@ struct ospf *ospf_new_alloc(unsigned short instance, const char *name)
 	new->lsa_refresher_started = monotime(NULL);
 
 	new->ibuf = stream_new(OSPF_MAX_PACKET_SIZE + 1);
+	new->rbatch = mmsg_batch_new(AF_INET, OSPF_RECV_BATCH,
+				     OSPF_MAX_PACKET_SIZE + 1);
 
 	new->t_read = NULL;
 	new->oi_write_q = list_new();
@@ -843,6 +849,7 @@ static void ospf_finish_final(struct ospf *ospf)
 	if (ospf->external_lsas) {
 		ospf_ase_external_lsas_finish(ospf->external_lsas);
 	}
+	ospf_ase_finish(ospf);
 
 	for (i = ZEBRA_ROUTE_SYSTEM; i <= ZEBRA_ROUTE_MAX; i++) {
 		struct list *ext_list;
@@ -896,6 +903,7 @@ static void ospf_finish_final(struct ospf *ospf)
 
 	close(ospf->fd);
 	stream_free(ospf->ibuf);
+	mmsg_batch_free(&ospf->rbatch);
 	ospf->fd = -1;
 	ospf->max_multipath = MULTIPATH_NUM;
 	ospf_delete(ospf);
@@ -1421,6 +1429,7 @@ void ospf_ls_upd_queue_empty(struct ospf_interface *oi)
 			list_delete(&lst);
 			rn->info = NULL;
 		}
+	oi->ls_upd_queue_bytes = 0;
 
 	/* remove update event */
 	thread_cancel(&oi->t_ls_upd_event);
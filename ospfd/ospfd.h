@@ -242,6 +242,10 @@ struct ospf {
 
 	struct route_table *external_lsas; /* Database of external LSAs,
 					      prefix is LSA's adv. network*/
+	struct hash *ase_deps;		   /* External destinations by ASBR
+					      and forwarding address */
+	struct route_table *ase_dirty;	   /* External destinations to
+					      recalculate */
 
 	/* Time stamps */
 	struct timeval ts_spf;		/* SPF calculation time stamp. */
@@ -266,6 +270,15 @@ struct ospf {
 	struct thread *t_maxage;	/* MaxAge LSA remover timer. */
 	struct thread *t_maxage_walker; /* MaxAge LSA checking timer. */
 
+	/* Non self-originated LSAs, slotted by the time they reach MaxAge. */
+#define OSPF_LSA_MAXAGE_SLOTS                                                  \
+	(OSPF_LSA_MAXAGE / OSPF_LSA_MAXAGE_CHECK_INTERVAL + 2)
+	struct {
+		uint16_t index;
+		struct list *qs[OSPF_LSA_MAXAGE_SLOTS];
+	} lsa_maxage_queue;
+	time_t lsa_maxage_walker_started;
+
 	struct thread
 		*t_deferred_shutdown; /* deferred/stub-router shutdown timer*/
 
@@ -277,6 +290,7 @@ struct ospf {
 	struct thread *t_read;
 	int fd;
 	struct stream *ibuf;
+	struct mmsg_batch *rbatch; /* batched raw socket reads */
 	struct list *oi_write_q;
 
 	/* Distribute lists out of other route sources. */
@@ -308,9 +322,15 @@ struct ospf {
 
 	struct thread *t_lsa_refresher;
 	time_t lsa_refresher_started;
+	bool lsa_refresher_running;
 #define OSPF_LSA_REFRESH_INTERVAL_DEFAULT 10
 	uint16_t lsa_refresh_interval;
 
+	/* AS-scoped LSA refresh statistics, area-scoped ones are per area. */
+	uint32_t lsa_refresh_count;
+	uint32_t lsa_refresh_last;
+	uint32_t lsa_refresh_peak;
+
 	/* Distance parameter. */
 	uint8_t distance_all;
 	uint8_t distance_intra;
@@ -572,6 +592,9 @@ struct ospf_area {
 
 	/* Statistics field. */
 	uint32_t spf_calculation; /* SPF Calculation Count. */
+	uint32_t lsa_refresh_count; /* Self-originated LSAs refreshed. */
+	uint32_t lsa_refresh_last;  /* Refreshed in the last refresher run. */
+	uint32_t lsa_refresh_peak;  /* Most refreshed in one refresher run. */
 
 	/* reverse SPF (used for TI-LFA Q spaces) */
 	bool spf_reversed;
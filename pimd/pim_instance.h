@@ -89,6 +89,9 @@ struct pim_router {
 	int packet_process;
 	uint32_t register_probe_time;
 
+	/* receive buffers shared by all PIM sockets */
+	struct mmsg_batch *rbatch;
+
 	/*
 	 * What is the default vrf that we work in
 	 */
@@ -24,6 +24,7 @@
 #include "memory.h"
 #include "if.h"
 #include "network.h"
+#include "mmsg.h"
 
 #include "pimd.h"
 #include "pim_pim.h"
@@ -349,79 +350,100 @@ static void pim_sock_read(struct thread *t)
 {
 	struct interface *ifp, *orig_ifp;
 	struct pim_interface *pim_ifp;
+	struct mmsg_batch *batch = router->rbatch;
 	int fd;
-	struct sockaddr_storage from;
-	struct sockaddr_storage to;
-	socklen_t fromlen = sizeof(from);
-	socklen_t tolen = sizeof(to);
-	uint8_t buf[PIM_PIM_BUFSIZE_READ];
-	int len;
-	ifindex_t ifindex = -1;
-	int result = -1; /* defaults to bad */
-	static long long count = 0;
-	int cont = 1;
+	struct sockaddr_storage sockname = {};
+	socklen_t socknamelen = 0;
+	int result = 0;
+	int count = 0;
+	int i, n;
 
 	orig_ifp = ifp = THREAD_ARG(t);
 	fd = THREAD_FD(t);
 
 	pim_ifp = ifp->info;
 
-	while (cont) {
-		pim_sgaddr sg;
-
-		len = pim_socket_recvfromto(fd, buf, sizeof(buf), &from,
-					    &fromlen, &to, &tolen, &ifindex);
-		if (len < 0) {
-			if (errno == EINTR)
-				continue;
+	/*
+	 * Drain up to packet_process packets per wakeup, fetched in batches
+	 * rather than one recvmsg() each.  A bad packet no longer stops the
+	 * ones already fetched behind it from being processed.
+	 */
+	while (count < router->packet_process) {
+		n = mmsg_recv(batch, fd, router->packet_process - count);
+		if (n < 0) {
 			if (errno == EWOULDBLOCK || errno == EAGAIN)
 				break;
 
 			if (PIM_DEBUG_PIM_PACKETS)
 				zlog_debug("Received errno: %d %s", errno,
 					   safe_strerror(errno));
-			goto done;
+			result = -1;
+			break;
 		}
 
-		/*
-		 * What?  So with vrf's the incoming packet is received
-		 * on the vrf interface but recvfromto above returns
-		 * the right ifindex, so just use it.  We know
-		 * it's the right interface because we bind to it
-		 */
-		ifp = if_lookup_by_index(ifindex, pim_ifp->pim->vrf->vrf_id);
-		if (!ifp || !ifp->info) {
-			if (PIM_DEBUG_PIM_PACKETS)
-				zlog_debug(
-					"%s: Received incoming pim packet on interface(%s:%d) not yet configured for pim",
-					__func__, ifp ? ifp->name : "Unknown",
-					ifindex);
-			goto done;
-		}
+		for (i = 0; i < n; i++) {
+			struct mmsg_pkt *pkt = &batch->pkts[i];
+			pim_sgaddr sg;
+			int fail;
+
+			count++;
+
+			/*
+			 * What?  So with vrf's the incoming packet is received
+			 * on the vrf interface but the packet info returns
+			 * the right ifindex, so just use it.  We know
+			 * it's the right interface because we bind to it
+			 */
+			ifp = if_lookup_by_index(pkt->ifindex,
+						 pim_ifp->pim->vrf->vrf_id);
+			if (!ifp || !ifp->info) {
+				if (PIM_DEBUG_PIM_PACKETS)
+					zlog_debug(
+						"%s: Received incoming pim packet on interface(%s:%d) not yet configured for pim",
+						__func__,
+						ifp ? ifp->name : "Unknown",
+						pkt->ifindex);
+				result = -1;
+				continue;
+			}
+
+			/*
+			 * Without a destination address in the packet info,
+			 * fall back to the address the socket is bound to.
+			 */
+			if (IS_IPADDR_NONE(&pkt->dst) && !socknamelen) {
+				socknamelen = sizeof(sockname);
+				pim_socket_getsockname(
+					fd, (struct sockaddr *)&sockname,
+					&socknamelen);
+			}
 #if PIM_IPV == 4
-		sg.src = ((struct sockaddr_in *)&from)->sin_addr;
-		sg.grp = ((struct sockaddr_in *)&to)->sin_addr;
+			sg.src = pkt->from.sin.sin_addr;
+			if (IS_IPADDR_V4(&pkt->dst))
+				sg.grp = pkt->dst.ipaddr_v4;
+			else
+				sg.grp = ((struct sockaddr_in *)&sockname)
+						 ->sin_addr;
 #else
-		sg.src = ((struct sockaddr_in6 *)&from)->sin6_addr;
-		sg.grp = ((struct sockaddr_in6 *)&to)->sin6_addr;
+			sg.src = pkt->from.sin6.sin6_addr;
+			if (IS_IPADDR_V6(&pkt->dst))
+				sg.grp = pkt->dst.ipaddr_v6;
+			else
+				sg.grp = ((struct sockaddr_in6 *)&sockname)
+						 ->sin6_addr;
 #endif
 
-		int fail = pim_pim_packet(ifp, buf, len, sg);
-		if (fail) {
-			if (PIM_DEBUG_PIM_PACKETS)
-				zlog_debug("%s: pim_pim_packet() return=%d",
-					   __func__, fail);
-			goto done;
+			fail = pim_pim_packet(ifp, pkt->data, pkt->len, sg);
+			if (fail) {
+				if (PIM_DEBUG_PIM_PACKETS)
+					zlog_debug(
+						"%s: pim_pim_packet() return=%d",
+						__func__, fail);
+				result = -1;
+			}
 		}
-
-		count++;
-		if (count % router->packet_process == 0)
-			cont = 0;
 	}
 
-	result = 0; /* good */
-
-done:
 	pim_sock_read_on(orig_ifp);
 
 	if (result) {
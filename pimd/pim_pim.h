@@ -25,6 +25,7 @@
 #include "if.h"
 
 #define PIM_PIM_BUFSIZE_READ  (20000)
+#define PIM_PIM_RECV_BATCH    (16) /* datagrams per recvmmsg() */
 #define PIM_PIM_BUFSIZE_WRITE (20000)
 
 #define PIM_DEFAULT_HELLO_PERIOD                 (30)   /* seconds, RFC 4601: 4.11 */
@@ -30,6 +30,7 @@
 #include "vrf.h"
 #include "lib_errors.h"
 #include "bfd.h"
+#include "mmsg.h"
 
 #include "pimd.h"
 #if PIM_IPV == 4
@@ -122,10 +123,13 @@ void pim_router_init(void)
 	router->vrf_id = VRF_DEFAULT;
 	router->pim_mlag_intf_cnt = 0;
 	router->connected_to_mlag = false;
+	router->rbatch = mmsg_batch_new(PIM_AF, PIM_PIM_RECV_BATCH,
+					PIM_PIM_BUFSIZE_READ);
 }
 
 void pim_router_terminate(void)
 {
+	mmsg_batch_free(&router->rbatch);
 	XFREE(MTYPE_ROUTER, router);
 }
 
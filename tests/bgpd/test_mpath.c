@@ -312,6 +312,9 @@ static int setup_bgp_path_info_mpath_update(testcase_t *t)
 	memcpy((struct route_table *)&rt_node->table, &rt->route_table,
 	       sizeof(struct route_table));
 	setup_bgp_mp_list(t);
+	for (i = 0; i < test_mp_list_peer_count; i++)
+		bgp_peer_paths_init(
+			&test_mp_list_peer[i].paths[AFI_IP][SAFI_UNICAST]);
 	for (i = 0; i < test_mp_list_info_count; i++)
 		bgp_path_info_add(&test_rn, &test_mp_list_info[i]);
 	return 0;
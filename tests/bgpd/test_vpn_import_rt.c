@@ -0,0 +1,243 @@
+/*
+ * BGP VPN import route target index unit test
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "qobj.h"
+#include "vty.h"
+#include "privs.h"
+#include "linklist.h"
+#include "memory.h"
+#include "vrf.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_mplsvpn.h"
+#include "bgpd/bgp_network.h"
+
+#define TEST_PASSED 0
+#define TEST_FAILED -1
+
+#define EXPECT_TRUE(expr, res)                                                 \
+	if (!(expr)) {                                                         \
+		printf("Test failure in %s line %u: %s\n", __func__, __LINE__, \
+		       #expr);                                                 \
+		(res) = TEST_FAILED;                                           \
+	}
+
+/* need these to link in libbgp */
+struct thread_master *master = NULL;
+struct zebra_privs_t bgpd_privs = {
+	.user = NULL,
+	.group = NULL,
+	.vty_group = NULL,
+};
+
+/* route targets carried by the test VPN route, in this order */
+#define ROUTE_RTS "65000:1 65000:2 65000:3"
+#define RT_1 0
+#define RT_2 1
+#define RT_3 2
+
+static struct ecommunity *route_ecom;
+static struct bgp *vrf_a, *vrf_b, *vrf_c;
+
+/* Create a fake VRF instance and add it to bm->bgp like bgp_create() does */
+static struct bgp *bgp_create_fake(const char *name)
+{
+	struct bgp *bgp;
+
+	bgp = XCALLOC(MTYPE_BGP, sizeof(struct bgp));
+	bgp->name = XSTRDUP(MTYPE_BGP, name);
+	bgp->inst_type = BGP_INSTANCE_TYPE_VRF;
+	listnode_add(bm->bgp, bgp);
+	vpn_leak_import_rt_index_invalidate();
+
+	return bgp;
+}
+
+static void bgp_delete_fake(struct bgp *bgp)
+{
+	afi_t afi;
+	int dir;
+
+	listnode_delete(bm->bgp, bgp);
+	vpn_leak_import_rt_index_invalidate();
+
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		for (dir = 0; dir < BGP_VPN_POLICY_DIR_MAX; dir++)
+			if (bgp->vpn_policy[afi].rtlist[dir])
+				ecommunity_free(
+					&bgp->vpn_policy[afi].rtlist[dir]);
+	XFREE(MTYPE_BGP, bgp->name);
+	XFREE(MTYPE_BGP, bgp);
+}
+
+/* Set a VRF's RT list like "rt vpn import|export" does, NULL removes it */
+static void bgp_set_rt(struct bgp *bgp, afi_t afi, int dir, const char *rts)
+{
+	if (bgp->vpn_policy[afi].rtlist[dir])
+		ecommunity_free(&bgp->vpn_policy[afi].rtlist[dir]);
+	if (rts)
+		bgp->vpn_policy[afi].rtlist[dir] =
+			ecommunity_str2com(rts, ECOMMUNITY_ROUTE_TARGET, 0);
+	if (dir == BGP_VPN_POLICY_DIR_FROMVPN)
+		vpn_leak_import_rt_index_invalidate();
+}
+
+/* The VRFs found in the index for the idx'th RT of the route are vrfs */
+static bool rt_imported_by(afi_t afi, uint32_t idx, struct bgp *vrfs[],
+			   unsigned int count)
+{
+	struct list *found;
+	unsigned int i;
+
+	found = vpn_leak_import_rt_vrfs(afi, route_ecom, idx);
+	if (!found)
+		return count == 0;
+	if (listcount(found) != count)
+		return false;
+	for (i = 0; i < count; i++)
+		if (!listnode_lookup(found, vrfs[i]))
+			return false;
+	return true;
+}
+
+/*
+ * vrf-a imports RT 1, vrf-b imports RT 1 and RT 2, vrf-c only exports RT 3.
+ */
+static int test_import_rt_lookup(void)
+{
+	int test_result = TEST_PASSED;
+
+	bgp_set_rt(vrf_a, AFI_IP, BGP_VPN_POLICY_DIR_FROMVPN, "65000:1");
+	bgp_set_rt(vrf_b, AFI_IP, BGP_VPN_POLICY_DIR_FROMVPN,
+		   "65000:1 65000:2");
+	bgp_set_rt(vrf_c, AFI_IP, BGP_VPN_POLICY_DIR_TOVPN, "65000:3");
+
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_1,
+				   (struct bgp *[]){vrf_a, vrf_b}, 2),
+		    test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_2, (struct bgp *[]){vrf_b}, 1),
+		    test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_3, NULL, 0), test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP6, RT_1, NULL, 0), test_result);
+
+	return test_result;
+}
+
+static int test_import_rt_change(void)
+{
+	int test_result = TEST_PASSED;
+
+	/* move vrf-a from RT 1 to RT 3 */
+	bgp_set_rt(vrf_a, AFI_IP, BGP_VPN_POLICY_DIR_FROMVPN, "65000:3");
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_1, (struct bgp *[]){vrf_b}, 1),
+		    test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_3, (struct bgp *[]){vrf_a}, 1),
+		    test_result);
+
+	/* export RTs are not part of the index */
+	bgp_set_rt(vrf_c, AFI_IP, BGP_VPN_POLICY_DIR_TOVPN, "65000:2");
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_2, (struct bgp *[]){vrf_b}, 1),
+		    test_result);
+
+	/* IPv6 imports are indexed separately */
+	bgp_set_rt(vrf_c, AFI_IP6, BGP_VPN_POLICY_DIR_FROMVPN, "65000:1");
+	EXPECT_TRUE(rt_imported_by(AFI_IP6, RT_1, (struct bgp *[]){vrf_c}, 1),
+		    test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_1, (struct bgp *[]){vrf_b}, 1),
+		    test_result);
+
+	/* drop vrf-b's import list altogether */
+	bgp_set_rt(vrf_b, AFI_IP, BGP_VPN_POLICY_DIR_FROMVPN, NULL);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_1, NULL, 0), test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_2, NULL, 0), test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_3, (struct bgp *[]){vrf_a}, 1),
+		    test_result);
+
+	return test_result;
+}
+
+static int test_import_rt_instance(void)
+{
+	int test_result = TEST_PASSED;
+	struct bgp *vrf_d;
+
+	vrf_d = bgp_create_fake("vrf-d");
+	bgp_set_rt(vrf_d, AFI_IP, BGP_VPN_POLICY_DIR_FROMVPN,
+		   "65000:2 65000:3");
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_2, (struct bgp *[]){vrf_d}, 1),
+		    test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_3,
+				   (struct bgp *[]){vrf_a, vrf_d}, 2),
+		    test_result);
+
+	bgp_delete_fake(vrf_d);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_2, NULL, 0), test_result);
+	EXPECT_TRUE(rt_imported_by(AFI_IP, RT_3, (struct bgp *[]){vrf_a}, 1),
+		    test_result);
+
+	return test_result;
+}
+
+static struct {
+	const char *desc;
+	int (*run)(void);
+} all_tests[] = {
+	{"import rt lookup", test_import_rt_lookup},
+	{"import rt change", test_import_rt_change},
+	{"import rt instance add/delete", test_import_rt_instance},
+};
+
+int main(void)
+{
+	int pass_count = 0, fail_count = 0;
+	unsigned int i;
+	int result;
+
+	qobj_init();
+	master = thread_master_create(NULL);
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	vrf_init(NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+
+	route_ecom = ecommunity_str2com(ROUTE_RTS, ECOMMUNITY_ROUTE_TARGET, 0);
+	vrf_a = bgp_create_fake("vrf-a");
+	vrf_b = bgp_create_fake("vrf-b");
+	vrf_c = bgp_create_fake("vrf-c");
+
+	for (i = 0; i < array_size(all_tests); i++) {
+		result = all_tests[i].run();
+		if (result == TEST_PASSED)
+			pass_count++;
+		else
+			fail_count++;
+		printf("%s: %s\n", all_tests[i].desc,
+		       result == TEST_PASSED ? "OK" : "failed");
+	}
+
+	bgp_delete_fake(vrf_c);
+	bgp_delete_fake(vrf_b);
+	bgp_delete_fake(vrf_a);
+	ecommunity_free(&route_ecom);
+	thread_master_free(master);
+
+	printf("Total pass/fail: %d/%d\n", pass_count, fail_count);
+	return fail_count;
+}
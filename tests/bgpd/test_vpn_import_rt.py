@@ -0,0 +1,10 @@
+import frrtest
+
+
+class TestVpnImportRt(frrtest.TestMultiOut):
+    program = "./test_vpn_import_rt"
+
+
+TestVpnImportRt.okfail("import rt lookup")
+TestVpnImportRt.okfail("import rt change")
+TestVpnImportRt.okfail("import rt instance add/delete")
@@ -0,0 +1,163 @@
+/*
+ * Test program which measures how long it takes to find the VRFs a VPN
+ * route is leaked into, with the import route target index and with a walk
+ * over every instance.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qobj.h"
+#include "thread.h"
+#include "privs.h"
+#include "linklist.h"
+#include "memory.h"
+#include "vrf.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_mplsvpn.h"
+#include "bgpd/bgp_network.h"
+
+#define VRF_COUNT 1000
+#define LOOKUPS 100000
+
+struct thread_master *master;
+struct zebra_privs_t bgpd_privs;
+
+/* Same test as the per-instance walk vpn_leak_to_vrf_update() used to do */
+static bool rt_intersect(struct ecommunity *e1, struct ecommunity *e2)
+{
+	uint32_t i, j;
+
+	if (!e1 || !e2)
+		return false;
+
+	for (i = 0; i < e1->size; i++)
+		for (j = 0; j < e2->size; j++)
+			if (!memcmp(e1->val + (i * e1->unit_size),
+				    e2->val + (j * e2->unit_size),
+				    ECOMMUNITY_SIZE))
+				return true;
+	return false;
+}
+
+static unsigned long elapsed_ms(struct timeval *start, struct timeval *stop)
+{
+	return 1000 * (stop->tv_sec - start->tv_sec)
+	       + (stop->tv_usec - start->tv_usec) / 1000;
+}
+
+int main(int argc, char **argv)
+{
+	struct ecommunity **routes;
+	struct timeval tv_start, tv_lap, tv_stop;
+	unsigned long t_build, t_index, t_walk;
+	unsigned long hits_index = 0, hits_walk = 0;
+	struct listnode *node;
+	struct list *vrfs;
+	struct bgp *bgp;
+	char rt[32];
+	int count = VRF_COUNT, lookups = LOOKUPS;
+	int i;
+
+	if (argc > 1)
+		count = atoi(argv[1]);
+	if (argc > 2)
+		lookups = atoi(argv[2]);
+	if (count < 1 || lookups < 1) {
+		fprintf(stderr, "usage: %s [vrf-count] [lookups]\n", argv[0]);
+		return 1;
+	}
+
+	qobj_init();
+	master = thread_master_create(NULL);
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	vrf_init(NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+
+	/* every VRF imports a route target of its own */
+	routes = XCALLOC(MTYPE_TMP, count * sizeof(*routes));
+	for (i = 0; i < count; i++) {
+		snprintf(rt, sizeof(rt), "65000:%d", i + 1);
+		routes[i] = ecommunity_str2com(rt, ECOMMUNITY_ROUTE_TARGET, 0);
+
+		bgp = XCALLOC(MTYPE_BGP, sizeof(struct bgp));
+		bgp->inst_type = BGP_INSTANCE_TYPE_VRF;
+		bgp->vpn_policy[AFI_IP].rtlist[BGP_VPN_POLICY_DIR_FROMVPN] =
+			ecommunity_dup(routes[i]);
+		listnode_add(bm->bgp, bgp);
+	}
+	vpn_leak_import_rt_index_invalidate();
+
+	monotime(&tv_start);
+
+	vpn_leak_import_rt_vrfs(AFI_IP, routes[0], 0);
+
+	monotime(&tv_lap);
+
+	for (i = 0; i < lookups; i++) {
+		vrfs = vpn_leak_import_rt_vrfs(AFI_IP, routes[i % count], 0);
+		if (vrfs)
+			hits_index += listcount(vrfs);
+	}
+
+	monotime(&tv_stop);
+
+	t_build = elapsed_ms(&tv_start, &tv_lap);
+	t_index = elapsed_ms(&tv_lap, &tv_stop);
+
+	monotime(&tv_start);
+
+	for (i = 0; i < lookups; i++)
+		for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp))
+			if (rt_intersect(bgp->vpn_policy[AFI_IP].rtlist
+						 [BGP_VPN_POLICY_DIR_FROMVPN],
+					 routes[i % count]))
+				hits_walk++;
+
+	monotime(&tv_stop);
+
+	t_walk = elapsed_ms(&tv_start, &tv_stop);
+
+	printf("Building the import RT index for %d VRFs took %lu.%03lu "
+	       "seconds.\n",
+	       count, t_build / 1000, t_build % 1000);
+	printf("Running %d indexed lookups (%lu VRFs found) took %lu.%03lu "
+	       "seconds.\n",
+	       lookups, hits_index, t_index / 1000, t_index % 1000);
+	printf("Running %d instance walks (%lu VRFs found) took %lu.%03lu "
+	       "seconds.\n",
+	       lookups, hits_walk, t_walk / 1000, t_walk % 1000);
+	fflush(stdout);
+
+	vpn_leak_import_rt_index_invalidate();
+	while ((bgp = listnode_head(bm->bgp))) {
+		listnode_delete(bm->bgp, bgp);
+		ecommunity_free(
+			&bgp->vpn_policy[AFI_IP].rtlist[BGP_VPN_POLICY_DIR_FROMVPN]);
+		XFREE(MTYPE_BGP, bgp);
+	}
+	for (i = 0; i < count; i++)
+		ecommunity_free(&routes[i]);
+	XFREE(MTYPE_TMP, routes);
+	thread_master_free(master);
+
+	return hits_index == hits_walk ? 0 : 1;
+}
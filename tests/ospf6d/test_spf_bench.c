@@ -0,0 +1,166 @@
+/*
+ * Test program which measures the time OSPFv3 SPF takes on a synthetic
+ * grid topology.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "thread.h"
+#include "privs.h"
+#include "vrf.h"
+#include "libospf.h"
+
+#include "ospf6d/ospf6_proto.h"
+#include "ospf6d/ospf6_lsa.h"
+#include "ospf6d/ospf6_lsdb.h"
+#include "ospf6d/ospf6_route.h"
+#include "ospf6d/ospf6_top.h"
+#include "ospf6d/ospf6_area.h"
+#include "ospf6d/ospf6_intra.h"
+#include "ospf6d/ospf6_spf.h"
+
+#define GRID_SIZE 100
+#define SPF_RUNS 10
+
+/* interface IDs of the four point-to-point links of each grid router */
+#define IFID_EAST 1
+#define IFID_WEST 2
+#define IFID_SOUTH 3
+#define IFID_NORTH 4
+
+struct thread_master *master;
+struct zebra_privs_t ospf6d_privs;
+
+static in_addr_t grid_router_id(int size, int x, int y)
+{
+	return htonl(y * size + x + 1);
+}
+
+static void grid_add_lsdesc(struct ospf6_router_lsdesc **lsdesc, int size,
+			    int x, int y, uint32_t ifid, uint32_t nbr_ifid)
+{
+	struct ospf6_router_lsdesc *d = *lsdesc;
+
+	if (x < 0 || y < 0 || x >= size || y >= size)
+		return;
+
+	d->type = OSPF6_ROUTER_LSDESC_POINTTOPOINT;
+	d->metric = htons(10);
+	d->interface_id = htonl(ifid);
+	d->neighbor_interface_id = htonl(nbr_ifid);
+	d->neighbor_router_id = grid_router_id(size, x, y);
+	(*lsdesc)++;
+}
+
+static struct ospf6_lsa *grid_router_lsa(int size, int x, int y)
+{
+	uint8_t buf[sizeof(struct ospf6_lsa_header)
+		    + sizeof(struct ospf6_router_lsa)
+		    + 4 * sizeof(struct ospf6_router_lsdesc)] = {};
+	struct ospf6_lsa_header *hdr = (struct ospf6_lsa_header *)buf;
+	struct ospf6_router_lsdesc *lsdesc;
+
+	lsdesc = (struct ospf6_router_lsdesc *)(OSPF6_LSA_HEADER_END(hdr)
+						+ sizeof(struct ospf6_router_lsa));
+	grid_add_lsdesc(&lsdesc, size, x + 1, y, IFID_EAST, IFID_WEST);
+	grid_add_lsdesc(&lsdesc, size, x - 1, y, IFID_WEST, IFID_EAST);
+	grid_add_lsdesc(&lsdesc, size, x, y + 1, IFID_SOUTH, IFID_NORTH);
+	grid_add_lsdesc(&lsdesc, size, x, y - 1, IFID_NORTH, IFID_SOUTH);
+
+	hdr->type = htons(OSPF6_LSTYPE_ROUTER);
+	hdr->id = htonl(0);
+	hdr->adv_router = grid_router_id(size, x, y);
+	hdr->seqnum = htonl(OSPF_INITIAL_SEQUENCE_NUMBER);
+	hdr->length = htons((uint8_t *)lsdesc - buf);
+
+	return ospf6_lsa_create(hdr);
+}
+
+int main(int argc, char **argv)
+{
+	struct ospf6 ospf6 = {};
+	struct ospf6_area area = {};
+	struct ospf6_route_table *result;
+	struct timeval tv_start, tv_lap, tv_stop;
+	unsigned long t_build, t_spf;
+	int size = GRID_SIZE, runs = SPF_RUNS;
+	int x, y, i;
+
+	if (argc > 1)
+		size = atoi(argv[1]);
+	if (argc > 2)
+		runs = atoi(argv[2]);
+	if (size < 2 || runs < 1) {
+		fprintf(stderr, "usage: %s [grid-size] [runs]\n", argv[0]);
+		return 1;
+	}
+
+	master = thread_master_create(NULL);
+	ospf6_lsa_init();
+
+	ospf6.vrf_id = VRF_DEFAULT;
+	strlcpy(area.name, "0.0.0.0", sizeof(area.name));
+	area.ospf6 = &ospf6;
+	area.lsdb = ospf6_lsdb_create(&area);
+	area.lsdb_self = ospf6_lsdb_create(&area);
+	area.temp_router_lsa_lsdb = ospf6_lsdb_create(&area);
+	result = OSPF6_ROUTE_TABLE_CREATE(AREA, SPF_RESULTS);
+
+	monotime(&tv_start);
+
+	for (y = 0; y < size; y++)
+		for (x = 0; x < size; x++)
+			ospf6_lsdb_add(grid_router_lsa(size, x, y), area.lsdb);
+
+	/* the SPF root is the router in the corner of the grid */
+	ospf6_lsdb_add(ospf6_lsa_copy(ospf6_lsdb_lookup(
+			       htons(OSPF6_LSTYPE_ROUTER), htonl(0),
+			       grid_router_id(size, 0, 0), area.lsdb)),
+		       area.lsdb_self);
+
+	monotime(&tv_lap);
+
+	for (i = 0; i < runs; i++)
+		ospf6_spf_calculation(grid_router_id(size, 0, 0), result,
+				      &area);
+
+	monotime(&tv_stop);
+
+	t_build = 1000 * (tv_lap.tv_sec - tv_start.tv_sec);
+	t_build += (tv_lap.tv_usec - tv_start.tv_usec) / 1000;
+
+	t_spf = 1000 * (tv_stop.tv_sec - tv_lap.tv_sec);
+	t_spf += (tv_stop.tv_usec - tv_lap.tv_usec) / 1000;
+
+	printf("Building a %dx%d router grid LSDB took %lu.%03lu seconds.\n",
+	       size, size, t_build / 1000, t_build % 1000);
+	printf("Running %d SPF calculations (%u vertices) took %lu.%03lu "
+	       "seconds.\n",
+	       runs, result->count, t_spf / 1000, t_spf % 1000);
+	fflush(stdout);
+
+	ospf6_spf_table_finish(result);
+	ospf6_route_table_delete(result);
+	ospf6_lsdb_delete(area.temp_router_lsa_lsdb);
+	ospf6_lsdb_delete(area.lsdb_self);
+	ospf6_lsdb_delete(area.lsdb);
+	thread_master_free(master);
+	return 0;
+}
@@ -463,6 +463,14 @@ static struct zebra_dplane_globals {
 	/* Update context queue inbound to the dataplane */
 	TAILQ_HEAD(zdg_ctx_q, zebra_dplane_ctx) dg_update_ctx_q;
 
+	/* Updates held back by the zebra main pthread while a batch is
+	 * open; these are handed to the dataplane pthread in one go when
+	 * the outermost batch ends. Only touched by the main pthread.
+	 */
+	struct zdg_ctx_q dg_batch_ctx_q;
+	uint32_t dg_batch_depth;
+	uint32_t dg_batch_count;
+
 	/* Ordered list of providers */
 	TAILQ_HEAD(zdg_prov_q, zebra_dplane_provider) dg_providers_q;
 
@@ -514,6 +522,7 @@ static struct zebra_dplane_globals {
 	_Atomic uint32_t dg_rule_errors;
 
 	_Atomic uint32_t dg_update_yields;
+	_Atomic uint32_t dg_update_batches;
 
 	_Atomic uint32_t dg_iptable_in;
 	_Atomic uint32_t dg_iptable_errors;
@@ -3169,27 +3178,18 @@ dplane_ctx_ipset_entry_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
 
 
 /*
- * Enqueue a new update,
- * and ensure an event is active for the dataplane pthread.
+ * Account for 'count' new updates on the inbound queue, maintaining the
+ * high-water counter also.
  */
-static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
+static void dplane_update_queued_add(uint32_t count)
 {
-	int ret = EINVAL;
 	uint32_t high, curr;
 
-	/* Enqueue for processing by the dataplane pthread */
-	DPLANE_LOCK();
-	{
-		TAILQ_INSERT_TAIL(&zdplane_info.dg_update_ctx_q, ctx,
-				  zd_q_entries);
-	}
-	DPLANE_UNLOCK();
-
 	curr = atomic_fetch_add_explicit(
 		&(zdplane_info.dg_routes_queued),
-		1, memory_order_seq_cst);
+		count, memory_order_seq_cst);
 
-	curr++;	/* We got the pre-incremented value */
+	curr += count;	/* We got the pre-incremented value */
 
 	/* Maybe update high-water counter also */
 	high = atomic_load_explicit(&zdplane_info.dg_routes_queued_max,
@@ -3202,6 +3202,33 @@ static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
 			    memory_order_seq_cst))
 			break;
 	}
+}
+
+/*
+ * Enqueue a new update,
+ * and ensure an event is active for the dataplane pthread.
+ */
+static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
+{
+	int ret = EINVAL;
+
+	/* Hold the update locally if the caller has opened a batch */
+	if (zdplane_info.dg_batch_depth > 0) {
+		TAILQ_INSERT_TAIL(&zdplane_info.dg_batch_ctx_q, ctx,
+				  zd_q_entries);
+		zdplane_info.dg_batch_count++;
+		return AOK;
+	}
+
+	/* Enqueue for processing by the dataplane pthread */
+	DPLANE_LOCK();
+	{
+		TAILQ_INSERT_TAIL(&zdplane_info.dg_update_ctx_q, ctx,
+				  zd_q_entries);
+	}
+	DPLANE_UNLOCK();
+
+	dplane_update_queued_add(1);
 
 	/* Ensure that an event for the dataplane thread is active */
 	ret = dplane_provider_work_ready();
@@ -3209,6 +3236,53 @@ static int dplane_update_enqueue(struct zebra_dplane_ctx *ctx)
 	return ret;
 }
 
+/*
+ * Open an update batch: until the matching dplane_batch_end(), updates
+ * enqueued from the zebra main pthread are collected locally rather than
+ * handed to the dataplane one at a time. Batches may nest.
+ */
+void dplane_batch_begin(void)
+{
+	zdplane_info.dg_batch_depth++;
+}
+
+/*
+ * Close an update batch; when the outermost batch ends, move everything
+ * collected to the dataplane's inbound queue with a single lock/wakeup.
+ */
+void dplane_batch_end(void)
+{
+	uint32_t count;
+
+	assert(zdplane_info.dg_batch_depth > 0);
+
+	if (--zdplane_info.dg_batch_depth > 0)
+		return;
+
+	count = zdplane_info.dg_batch_count;
+	if (count == 0)
+		return;
+
+	DPLANE_LOCK();
+	{
+		TAILQ_CONCAT(&zdplane_info.dg_update_ctx_q,
+			     &zdplane_info.dg_batch_ctx_q, zd_q_entries);
+	}
+	DPLANE_UNLOCK();
+
+	zdplane_info.dg_batch_count = 0;
+
+	dplane_update_queued_add(count);
+
+	atomic_fetch_add_explicit(&zdplane_info.dg_update_batches, 1,
+				  memory_order_relaxed);
+
+	if (IS_ZEBRA_DEBUG_DPLANE_DETAIL)
+		zlog_debug("dplane: enqueued batch of %u updates", count);
+
+	dplane_provider_work_ready();
+}
+
 /*
  * Utility that prepares a route update and enqueues it for processing
  */
@@ -4745,7 +4819,7 @@ dplane_gre_set(struct interface *ifp, struct interface *ifp_link,
 int dplane_show_helper(struct vty *vty, bool detailed)
 {
 	uint64_t queued, queue_max, limit, errs, incoming, yields,
-		other_errs;
+		other_errs, batches;
 
 	/* Using atomics because counters are being changed in different
 	 * pthread contexts.
@@ -4762,6 +4836,8 @@ int dplane_show_helper(struct vty *vty, bool detailed)
 				    memory_order_relaxed);
 	yields = atomic_load_explicit(&zdplane_info.dg_update_yields,
 				      memory_order_relaxed);
+	batches = atomic_load_explicit(&zdplane_info.dg_update_batches,
+				       memory_order_relaxed);
 	other_errs = atomic_load_explicit(&zdplane_info.dg_other_errors,
 					  memory_order_relaxed);
 
@@ -4773,6 +4849,7 @@ int dplane_show_helper(struct vty *vty, bool detailed)
 	vty_out(vty, "Route update queue depth: %"PRIu64"\n", queued);
 	vty_out(vty, "Route update queue max:   %"PRIu64"\n", queue_max);
 	vty_out(vty, "Dplane update yields:     %"PRIu64"\n", yields);
+	vty_out(vty, "Dplane update batches:    %"PRIu64"\n", batches);
 
 	incoming = atomic_load_explicit(&zdplane_info.dg_lsps_in,
 					memory_order_relaxed);
@@ -6233,6 +6310,7 @@ static void zebra_dplane_init_internal(void)
 	pthread_mutex_init(&zdplane_info.dg_mutex, NULL);
 
 	TAILQ_INIT(&zdplane_info.dg_update_ctx_q);
+	TAILQ_INIT(&zdplane_info.dg_batch_ctx_q);
 	TAILQ_INIT(&zdplane_info.dg_providers_q);
 	zns_info_list_init(&zdplane_info.dg_zns_list);
 
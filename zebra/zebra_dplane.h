@@ -844,6 +844,12 @@ void dplane_set_in_queue_limit(uint32_t limit, bool set);
 /* Retrieve the current queue depth of incoming, unprocessed updates */
 uint32_t dplane_get_in_queue_len(void);
 
+/* Collect updates enqueued from the zebra main pthread and hand them to
+ * the dataplane as one batch when the outermost batch ends.
+ */
+void dplane_batch_begin(void);
+void dplane_batch_end(void);
+
 /*
  * Vty/cli apis
  */
@@ -312,7 +312,7 @@ void zebra_evpn_deref_ip2mac(struct zebra_evpn *zevpn, struct zebra_mac *mac)
 	 * we need to uninstall the MAC.
 	 */
 	if (CHECK_FLAG(mac->flags, ZEBRA_MAC_REMOTE)
-	    && remote_neigh_count(mac) == 0) {
+	    && !remote_neigh_present(mac)) {
 		zebra_evpn_rem_mac_uninstall(zevpn, mac, false /*force*/);
 		zebra_evpn_es_mac_deref_entry(mac);
 		UNSET_FLAG(mac->flags, ZEBRA_MAC_REMOTE);
@@ -1951,7 +1951,7 @@ void zebra_evpn_rem_mac_del(struct zebra_evpn *zevpn, struct zebra_mac *mac)
 	/* If all remote neighbors referencing a remote MAC
 	 * go away, we need to uninstall the MAC.
 	 */
-	if (remote_neigh_count(mac) == 0) {
+	if (!remote_neigh_present(mac)) {
 		zebra_evpn_rem_mac_uninstall(zevpn, mac, false /*force*/);
 		zebra_evpn_es_mac_deref_entry(mac);
 		UNSET_FLAG(mac->flags, ZEBRA_MAC_REMOTE);
@@ -131,20 +131,20 @@ void zebra_evpn_find_neigh_addr_width(struct hash_bucket *bucket, void *ctxt)
 }
 
 /*
- * Count of remote neighbors referencing this MAC.
+ * Check if any remote neighbor references this MAC; stops at the first
+ * match rather than counting the whole list.
  */
-int remote_neigh_count(struct zebra_mac *zmac)
+bool remote_neigh_present(struct zebra_mac *zmac)
 {
 	struct zebra_neigh *n = NULL;
 	struct listnode *node = NULL;
-	int count = 0;
 
 	for (ALL_LIST_ELEMENTS_RO(zmac->neigh_list, node, n)) {
 		if (CHECK_FLAG(n->flags, ZEBRA_NEIGH_REMOTE))
-			count++;
+			return true;
 	}
 
-	return count;
+	return false;
 }
 
 /*
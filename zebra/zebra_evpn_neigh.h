@@ -205,13 +205,11 @@ static inline bool zebra_evpn_neigh_clear_sync_info(struct zebra_neigh *n)
 	return old_n_static != new_n_static;
 }
 
-int remote_neigh_count(struct zebra_mac *zmac);
-
 int neigh_list_cmp(void *p1, void *p2);
 struct hash *zebra_neigh_db_create(const char *desc);
 uint32_t num_dup_detected_neighs(struct zebra_evpn *zevpn);
 void zebra_evpn_find_neigh_addr_width(struct hash_bucket *bucket, void *ctxt);
-int remote_neigh_count(struct zebra_mac *zmac);
+bool remote_neigh_present(struct zebra_mac *zmac);
 int zebra_evpn_rem_neigh_install(struct zebra_evpn *zevpn,
 				 struct zebra_neigh *n, bool was_static);
 void zebra_evpn_install_neigh_hash(struct hash_bucket *bucket, void *ctxt);
@@ -125,6 +125,11 @@ static const struct {
 /* EVPN/VXLAN subqueue is number 1 */
 #define META_QUEUE_EVPN 1
 
+/* Max number of EVPN/VXLAN subqueue entries processed as one dataplane
+ * batch.
+ */
+#define META_QUEUE_EVPN_BATCH 1024
+
 /* Wrapper struct for nhg workqueue items; a 'ctx' is an incoming update
  * from the OS, and an 'nhe' is a nhe update.
  */
@@ -2453,6 +2458,34 @@ static unsigned int process_subq(struct list *subq, uint8_t qindex)
 	return 1;
 }
 
+/*
+ * Process a burst of entries from the EVPN/VXLAN subqueue, handing the
+ * resulting MAC/neigh updates to the dataplane as a single batch. 'room'
+ * is the space left in the dataplane's inbound queue; return the number
+ * of entries processed.
+ */
+static unsigned int process_subq_evpn_batch(struct list *subq, uint32_t room)
+{
+	unsigned int count = 0;
+	struct listnode *lnode;
+
+	room = MIN(room, META_QUEUE_EVPN_BATCH);
+
+	dplane_batch_begin();
+
+	while ((lnode = listhead(subq)) != NULL) {
+		process_subq_evpn(lnode);
+		list_delete_node(subq, lnode);
+
+		if (++count >= room)
+			break;
+	}
+
+	dplane_batch_end();
+
+	return count;
+}
+
 /* Dispatch the meta queue by picking and processing the next node from
  * a non-empty sub-queue with lowest priority. wq is equal to zebra->ribq and
  * data is pointed to the meta queue structure.
@@ -2478,11 +2511,18 @@ static wq_item_status meta_queue_process(struct work_queue *dummy, void *data)
 		return WQ_QUEUE_BLOCKED;
 	}
 
-	for (i = 0; i < MQ_SIZE; i++)
+	for (i = 0; i < MQ_SIZE; i++) {
+		if (i == META_QUEUE_EVPN && listcount(mq->subq[i]) > 1) {
+			mq->size -= process_subq_evpn_batch(
+				mq->subq[i], queue_limit - queue_len);
+			break;
+		}
+
 		if (process_subq(mq->subq[i], i)) {
 			mq->size--;
 			break;
 		}
+	}
 	return mq->size ? WQ_REQUEUE : WQ_SUCCESS;
 }
 
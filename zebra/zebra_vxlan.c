@@ -3809,7 +3809,7 @@ zebra_vxlan_remote_macip_helper(bool add, struct stream *s, vni_t *vni,
 
 		STREAM_GET(&ip->ip.addr, s, *ipa_len);
 	}
-	l += 4 + ETH_ALEN + 4 + *ipa_len;
+	l += 4 + ETH_ALEN + 2 + *ipa_len;
 	STREAM_GET(&vtep_ip->s_addr, s, IPV4_MAX_BYTELEN);
 	l += IPV4_MAX_BYTELEN;
 
@@ -3842,7 +3842,8 @@ void zebra_vxlan_remote_macip_del(ZAPI_HANDLER_ARGS)
 
 	s = msg;
 
-	while (l < hdr->length) {
+	/* bgpd batches multiple entries into one message */
+	while (l < hdr->length - ZEBRA_HEADER_SIZE) {
 		int res_length = zebra_vxlan_remote_macip_helper(
 			false, s, &vni, &macaddr, &ipa_len, &ip, &vtep_ip, NULL,
 			NULL, NULL);
@@ -3894,8 +3895,8 @@ void zebra_vxlan_remote_macip_add(ZAPI_HANDLER_ARGS)
 
 	s = msg;
 
-	while (l < hdr->length) {
-
+	/* bgpd batches multiple entries into one message */
+	while (l < hdr->length - ZEBRA_HEADER_SIZE) {
 		int res_length = zebra_vxlan_remote_macip_helper(
 			true, s, &vni, &macaddr, &ipa_len, &ip, &vtep_ip,
 			&flags, &seq, &esi);